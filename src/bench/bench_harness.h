@@ -0,0 +1,127 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+/**
+ * Mini harnais de micro-benchmarks : échauffement, N itérations chronométrées,
+ * percentiles du temps par itération et débit (MB/s ou Mpixel/s) au médian
+ */
+namespace Bench {
+
+struct Options {
+    int warmup = 3;
+    int iterations = 30;
+    std::string filter;      // Sous-chaîne du nom (vide = tous)
+};
+
+struct Result {
+    std::string name;
+    std::string unit;        // "MB/s", "Mpix/s"...
+    double unitsPerIteration = 0;  // Mo ou Mpixels traités par itération
+    std::vector<double> seconds;   // Triés
+    double p50 = 0, p90 = 0, p99 = 0, min = 0, max = 0;
+
+    double throughput(double s) const { return s > 0 ? unitsPerIteration / s : 0; }
+};
+
+/** Empêche le compilateur d'éliminer un calcul dont le résultat est ignoré */
+template <typename T>
+inline void doNotOptimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+#endif
+}
+
+inline double percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) {
+        return 0;
+    }
+    // Rang le plus proche (p dans [0, 100])
+    size_t rank = (size_t)((p / 100.0) * (double)(sorted.size() - 1) + 0.5);
+    return sorted[std::min(rank, sorted.size() - 1)];
+}
+
+/**
+ * Exécute fn() warmup + iterations fois ; seules les itérations comptent
+ */
+template <typename Fn>
+Result run(const std::string& name, const char* unit, double unitsPerIteration,
+           const Options& options, Fn&& fn) {
+    Result r;
+    r.name = name;
+    r.unit = unit;
+    r.unitsPerIteration = unitsPerIteration;
+
+    for (int i = 0; i < options.warmup; ++i) {
+        fn();
+    }
+    r.seconds.reserve(options.iterations);
+    for (int i = 0; i < options.iterations; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        auto end = std::chrono::steady_clock::now();
+        r.seconds.push_back(std::chrono::duration<double>(end - start).count());
+    }
+
+    std::sort(r.seconds.begin(), r.seconds.end());
+    r.p50 = percentile(r.seconds, 50);
+    r.p90 = percentile(r.seconds, 90);
+    r.p99 = percentile(r.seconds, 99);
+    r.min = r.seconds.empty() ? 0 : r.seconds.front();
+    r.max = r.seconds.empty() ? 0 : r.seconds.back();
+    return r;
+}
+
+inline bool selected(const Options& options, const std::string& name) {
+    return options.filter.empty() || name.find(options.filter) != std::string::npos;
+}
+
+inline void printHeader() {
+    printf("%-22s %6s %10s %10s %10s %10s %12s %12s\n",
+           "benchmark", "iters", "p50 ms", "p90 ms", "p99 ms", "min ms", "p50 rate", "best rate");
+}
+
+inline void printResult(const Result& r) {
+    printf("%-22s %6zu %10.3f %10.3f %10.3f %10.3f %8.1f %-4s %7.1f %-4s\n",
+           r.name.c_str(), r.seconds.size(), r.p50 * 1e3, r.p90 * 1e3, r.p99 * 1e3, r.min * 1e3,
+           r.throughput(r.p50), r.unit.c_str(), r.throughput(r.min), r.unit.c_str());
+}
+
+/** Pic de mémoire résidente du processus (octets, 0 si indisponible) */
+inline size_t peakRssBytes() {
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return (size_t)counters.PeakWorkingSetSize;
+    }
+    return 0;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+#if defined(__APPLE__)
+    return (size_t)usage.ru_maxrss;          // Octets sous macOS
+#else
+    return (size_t)usage.ru_maxrss * 1024;   // Ko sous Linux
+#endif
+#endif
+}
+
+} // namespace Bench
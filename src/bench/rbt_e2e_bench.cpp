@@ -0,0 +1,207 @@
+/**
+ * Benchmark de bout en bout du pipeline d'extraction Robot
+ *
+ * Pour chaque fichier : parse de l'en-tête, dimensions max, puis pour chaque
+ * frame décodage LZS + composition (extractFramePixels), décomposition en
+ * couches, conversion RGBA et encodage PNG (en mémoire), enfin extraction
+ * audio DPCM → WAV (fichier temporaire). ffmpeg n'est pas lancé : on mesure
+ * le travail propre à l'extracteur.
+ *
+ * Usage:
+ *   rbt_e2e_bench [--repeat N] [--no-png] [--no-audio] [--json FILE] <file.rbt|dir> ...
+ *
+ * Avec rbt_generate, donne des tests de montée en charge reproductibles :
+ *   rbt_generate --frames 5000 --size 640x480 --version 6 big.rbt
+ *   rbt_e2e_bench big.rbt
+ */
+
+#include "bench_harness.h"
+#include "core/rbt_parser.h"
+#include "core/scummvm_robot_helpers.h"
+#include "formats/robot_mkv_exporter.h"
+#include "utils/log.h"
+#include "../include/stb_image_write.h"
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <nlohmann/json.hpp>
+
+namespace fs = std::filesystem;
+using namespace RobotExtractor;
+
+struct RunResult {
+    size_t frames = 0;
+    size_t failedFrames = 0;
+    uint64_t pixels = 0;
+    uint64_t pngBytes = 0;
+    double seconds = 0;
+};
+
+static void countBytes(void* context, void* /*data*/, int size) {
+    *static_cast<uint64_t*>(context) += (uint64_t)size;
+}
+
+static bool runPipeline(const std::string& path, bool png, bool audio, RunResult& result) {
+    auto start = std::chrono::steady_clock::now();
+
+    FILE* f = fopen(path.c_str(), "rb");
+    if (!f) {
+        fprintf(stderr, "Error: Cannot open %s\n", path.c_str());
+        return false;
+    }
+    RbtParser parser(f);
+    if (!parser.parseHeader()) {
+        fclose(f);
+        return false;
+    }
+    parser.computeMaxDimensions();
+
+    const std::vector<uint8_t>& palette = parser.getPalette();
+    std::vector<uint8_t> pixels;
+    std::vector<uint8_t> rgba;
+    result.frames = parser.getNumFrames();
+    for (size_t i = 0; i < result.frames; ++i) {
+        int width = 0, height = 0;
+        if (!parser.extractFramePixels(i, pixels, width, height)) {
+            result.failedFrames++;
+            continue;
+        }
+        RobotLayerFrame layer = decomposeRobotFrame(pixels, palette, width, height);
+        Bench::doNotOptimize(layer.alpha[0]);
+        result.pixels += (uint64_t)width * height;
+
+        if (png) {
+            rgba.resize((size_t)width * height * 4);
+            ScummVMRobot::indexedToRGBA(pixels.data(), pixels.size(), palette.data(), rgba.data());
+            stbi_write_png_to_func(countBytes, &result.pngBytes, width, height, 4, rgba.data(), width * 4);
+        }
+    }
+
+    if (audio && parser.hasAudio()) {
+        fs::path wav = fs::temp_directory_path() / "rbt_e2e_bench_audio.wav";
+        parser.extractAudio(wav.string());
+        std::error_code ec;
+        fs::remove(wav, ec);
+    }
+    fclose(f);
+
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    int repeat = 1;
+    bool png = true;
+    bool audio = true;
+    std::string jsonPath;
+    std::vector<std::string> inputs;
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) {
+            repeat = std::max(1, atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--no-png") == 0) {
+            png = false;
+        } else if (strcmp(argv[i], "--no-audio") == 0) {
+            audio = false;
+        } else if (strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+            jsonPath = argv[++i];
+        } else if (argv[i][0] != '-') {
+            std::error_code ec;
+            if (fs::is_directory(argv[i], ec)) {
+                std::vector<std::string> files;
+                for (const auto& e : fs::directory_iterator(argv[i], ec)) {
+                    std::string ext = e.path().extension().string();
+                    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+                    if (e.is_regular_file() && ext == ".rbt") {
+                        files.push_back(e.path().string());
+                    }
+                }
+                std::sort(files.begin(), files.end());
+                inputs.insert(inputs.end(), files.begin(), files.end());
+            } else {
+                inputs.push_back(argv[i]);
+            }
+        } else {
+            fprintf(stderr, "Usage: %s [--repeat N] [--no-png] [--no-audio] [--json FILE] <file.rbt|dir> ...\n", argv[0]);
+            return 1;
+        }
+    }
+    if (inputs.empty()) {
+        fprintf(stderr, "Error: No .RBT input\n");
+        return 1;
+    }
+
+    // Les messages par Robot fausseraient la mesure (sauf niveau demandé)
+    if (!std::getenv("ROBOT_LOG_LEVEL")) {
+        Log::setLevel(Log::Level::Warning);
+    }
+
+    printf("%-28s %7s %9s %10s %9s %10s %9s\n",
+           "file", "frames", "MB", "best s", "frames/s", "MB/s", "Mpix/s");
+
+    nlohmann::json results = nlohmann::json::array();
+    int failures = 0;
+    for (const auto& path : inputs) {
+        std::error_code ec;
+        const uint64_t fileBytes = fs::file_size(path, ec);
+        const double fileMB = fileBytes / (1024.0 * 1024.0);
+
+        RunResult best;
+        std::vector<double> seconds;
+        bool ok = true;
+        for (int r = 0; r < repeat && ok; ++r) {
+            RunResult run;
+            ok = runPipeline(path, png, audio, run);
+            if (ok) {
+                seconds.push_back(run.seconds);
+                if (r == 0 || run.seconds < best.seconds) {
+                    best = run;
+                }
+            }
+        }
+        if (!ok) {
+            fprintf(stderr, "Error: Pipeline failed on %s\n", path.c_str());
+            failures++;
+            continue;
+        }
+        std::sort(seconds.begin(), seconds.end());
+
+        const double s = best.seconds > 0 ? best.seconds : 1e-9;
+        const std::string name = fs::path(path).filename().string();
+        printf("%-28s %7zu %9.1f %10.3f %9.1f %10.1f %9.1f\n",
+               name.c_str(), best.frames, fileMB, best.seconds,
+               best.frames / s, fileMB / s, best.pixels / 1e6 / s);
+        if (best.failedFrames > 0) {
+            printf("  warning: %zu frame(s) could not be decoded\n", best.failedFrames);
+        }
+
+        results.push_back({
+            {"file", path}, {"bytes", fileBytes}, {"frames", best.frames},
+            {"failedFrames", best.failedFrames}, {"pixels", best.pixels}, {"pngBytes", best.pngBytes},
+            {"bestSeconds", best.seconds}, {"medianSeconds", Bench::percentile(seconds, 50)},
+            {"framesPerSecond", best.frames / s}, {"mbPerSecond", fileMB / s},
+            {"mpixelsPerSecond", best.pixels / 1e6 / s}
+        });
+    }
+
+    const double peakMB = Bench::peakRssBytes() / (1024.0 * 1024.0);
+    printf("\npeak RSS: %.1f MB\n", peakMB);
+
+    if (!jsonPath.empty()) {
+        nlohmann::json root;
+        root["repeat"] = repeat;
+        root["png"] = png;
+        root["audio"] = audio;
+        root["peakRssBytes"] = Bench::peakRssBytes();
+        root["results"] = results;
+        std::ofstream out(jsonPath, std::ios::trunc);
+        out << root.dump(2) << "\n";
+        if (!out.good()) {
+            fprintf(stderr, "Error: Cannot write %s\n", jsonPath.c_str());
+            return 1;
+        }
+    }
+    return failures == 0 ? 0 : 1;
+}
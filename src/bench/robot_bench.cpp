@@ -0,0 +1,247 @@
+/**
+ * Micro-benchmarks des noyaux de décodage / conversion Robot
+ *
+ * Mesure sur des entrées synthétiques déterministes (cels elliptiques
+ * tramés, audio type voix) les fonctions du chemin d'export :
+ *   LZSDecompress, DecompressorLZS::unpack, HuffmanDecompress, deDPCM16Mono,
+ *   interpolateChannel, expandCelVertically, blitSpans, buildOpaqueSpans,
+ *   decomposeRobotFrame (dense et par suites opaques),
+ *   indexedToRGBA, stbi_write_png
+ *
+ * Usage:
+ *   robot_bench [--iterations N] [--warmup N] [--filter NAME]
+ *               [--compressibility 0..1] [--seed N] [--json FILE]
+ *
+ * Chaque ligne donne les percentiles du temps par itération et le débit
+ * (MB/s en sortie du décodeur, ou Mpixel/s) au médian et au meilleur temps.
+ */
+
+#include "bench_harness.h"
+#include "synthetic.h"
+#include "core/robot_cel.h"
+#include "core/scummvm_robot_helpers.h"
+#include "formats/decompressor_lzs.h"
+#include "formats/dpcm.h"
+#include "formats/huffman.h"
+#include "formats/lzs.h"
+#include "formats/robot_mkv_exporter.h"
+#include "utils/memstream.h"
+#include "../include/stb_image_write.h"
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <nlohmann/json.hpp>
+
+using namespace RobotExtractor;
+
+static const double kMB = 1024.0 * 1024.0;
+
+static void countBytes(void* context, void* /*data*/, int size) {
+    *static_cast<size_t*>(context) += (size_t)size;
+}
+
+int main(int argc, char* argv[]) {
+    Bench::Options options;
+    double compressibility = 0.7;
+    uint32_t seed = 1234;
+    std::string jsonPath;
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--iterations") == 0 && i + 1 < argc) {
+            options.iterations = std::max(1, atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--warmup") == 0 && i + 1 < argc) {
+            options.warmup = std::max(0, atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            options.filter = argv[++i];
+        } else if (strcmp(argv[i], "--compressibility") == 0 && i + 1 < argc) {
+            compressibility = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = (uint32_t)strtoul(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+            jsonPath = argv[++i];
+        } else {
+            fprintf(stderr, "Usage: %s [--iterations N] [--warmup N] [--filter NAME] "
+                            "[--compressibility 0..1] [--seed N] [--json FILE]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    std::mt19937 rng(seed);
+
+    // Entrées communes
+    const int celW = 320, celH = 240;
+    const int frameW = 640, frameH = 480;
+    const std::vector<uint8_t> palette = Synthetic::makePalette(seed);
+    const std::vector<uint8_t> cel = Synthetic::makeCelPixels(celW, celH, compressibility, rng);
+    const std::vector<uint8_t> frame = Synthetic::makeCelPixels(frameW, frameH, compressibility, rng);
+    const std::vector<uint8_t> celLzs = LZSCompress(cel.data(), (uint32_t)cel.size());
+    const std::vector<uint8_t> celHuffman = HuffmanCompress(cel.data(), (uint32_t)cel.size());
+
+    const size_t audioSamples = 22050;  // 1 s de canal
+    const std::vector<int16_t> audio = Synthetic::makeAudio(audioSamples, rng);
+    std::vector<uint8_t> audioDpcm(audioSamples);
+    {
+        int16_t state = 0;
+        enDPCM16Mono(audioDpcm.data(), audio.data(), (uint32_t)audioSamples, state);
+    }
+
+    printf("robot_bench: seed=%u compressibility=%.2f iterations=%d warmup=%d\n",
+           seed, compressibility, options.iterations, options.warmup);
+    printf("  cel %dx%d LZS %zu -> %zu bytes (ratio %.2f), Huffman %zu bytes (ratio %.2f), frame %dx%d, audio %zu samples\n\n",
+           celW, celH, celLzs.size(), cel.size(), (double)cel.size() / celLzs.size(),
+           celHuffman.size(), (double)cel.size() / celHuffman.size(),
+           frameW, frameH, audioSamples);
+    Bench::printHeader();
+
+    std::vector<Bench::Result> results;
+    auto record = [&](const Bench::Result& r) {
+        Bench::printResult(r);
+        results.push_back(r);
+    };
+
+    // --- LZS -----------------------------------------------------------------
+    std::vector<uint8_t> lzsOut(cel.size());
+    if (Bench::selected(options, "lzs_decompress")) {
+        record(Bench::run("lzs_decompress", "MB/s", cel.size() / kMB, options, [&] {
+            int rc = LZSDecompress(celLzs.data(), (uint32_t)celLzs.size(), lzsOut.data(), (uint32_t)lzsOut.size());
+            Bench::doNotOptimize(rc);
+            Bench::doNotOptimize(lzsOut[lzsOut.size() / 2]);
+        }));
+        if (lzsOut != cel) {
+            fprintf(stderr, "Error: LZS round-trip mismatch\n");
+            return 1;
+        }
+    }
+    if (Bench::selected(options, "lzs_unpack")) {
+        record(Bench::run("lzs_unpack", "MB/s", cel.size() / kMB, options, [&] {
+            Common::MemoryReadStream stream(celLzs.data(), (uint32_t)celLzs.size());
+            DecompressorLZS dec;
+            int rc = dec.unpack(&stream, lzsOut.data(), (uint32_t)celLzs.size(), (uint32_t)lzsOut.size());
+            Bench::doNotOptimize(rc);
+            Bench::doNotOptimize(lzsOut[lzsOut.size() / 2]);
+        }));
+    }
+
+    // --- Huffman SCI ---------------------------------------------------------
+    if (Bench::selected(options, "huffman_decompress")) {
+        std::vector<uint8_t> huffmanOut(cel.size());
+        record(Bench::run("huffman_decompress", "MB/s", cel.size() / kMB, options, [&] {
+            int64_t n = HuffmanDecompress(celHuffman.data(), (uint32_t)celHuffman.size(),
+                                          huffmanOut.data(), (uint32_t)huffmanOut.size());
+            Bench::doNotOptimize(n);
+            Bench::doNotOptimize(huffmanOut[huffmanOut.size() / 2]);
+        }));
+        if (huffmanOut != cel) {
+            fprintf(stderr, "Error: Huffman round-trip mismatch\n");
+            return 1;
+        }
+    }
+
+    // --- Audio ---------------------------------------------------------------
+    std::vector<int16_t> pcm(audioSamples);
+    if (Bench::selected(options, "dpcm_decode")) {
+        record(Bench::run("dpcm_decode", "MB/s", audioSamples * sizeof(int16_t) / kMB, options, [&] {
+            int16_t state = 0;
+            deDPCM16Mono(pcm.data(), audioDpcm.data(), (uint32_t)audioDpcm.size(), state);
+            Bench::doNotOptimize(pcm[audioSamples - 1]);
+        }));
+    }
+    std::vector<int16_t> interleaved(audioSamples * 2);
+    if (Bench::selected(options, "interpolate_channel")) {
+        record(Bench::run("interpolate_channel", "MB/s", interleaved.size() * sizeof(int16_t) / kMB, options, [&] {
+            // Un canal sur deux rempli, l'autre reconstruit (cas d'un paquet manquant)
+            for (size_t i = 0; i < audioSamples; ++i) {
+                interleaved[i * 2] = audio[i];
+            }
+            interpolateChannel(interleaved.data(), (int32_t)audioSamples, 1);
+            Bench::doNotOptimize(interleaved[interleaved.size() / 2]);
+        }));
+    }
+
+    // --- Pixels --------------------------------------------------------------
+    if (Bench::selected(options, "vertical_expand")) {
+        // verticalScale = 50 : la moitié des lignes stockées
+        const int sourceHeight = celH / 2;
+        std::vector<uint8_t> expanded((size_t)celW * celH);
+        record(Bench::run("vertical_expand", "Mpix/s", (double)celW * celH / 1e6, options, [&] {
+            ScummVMRobot::expandCelVertically(cel.data(), (size_t)celW * sourceHeight, celW,
+                                              sourceHeight, celH, expanded.data());
+            Bench::doNotOptimize(expanded[expanded.size() / 2]);
+        }));
+    }
+    if (Bench::selected(options, "blit_spans")) {
+        // Cel tramé (skip = 255 hors ellipse) posé à cheval sur le bord droit du
+        // canvas ; suites opaques calculées au décodage, comme dans getFrame()
+        std::vector<ScummVMRobot::PixelSpan> celSpans;
+        ScummVMRobot::buildOpaqueSpans(cel.data(), celW, celH, celSpans);
+        std::vector<ScummVMRobot::PixelSpan> frameSpans;
+        std::vector<uint8_t> canvas(frame);
+        const int dstX = frameW - celW * 3 / 4, dstY = (frameH - celH) / 2;
+        record(Bench::run("blit_spans", "Mpix/s", (double)celW * celH / 1e6, options, [&] {
+            frameSpans.clear();
+            ScummVMRobot::blitSpans(cel.data(), celW, celSpans, dstX, dstY, canvas.data(), frameW, frameH,
+                                    &frameSpans);
+            Bench::doNotOptimize(canvas[(size_t)frameH / 2 * frameW + frameW - 1]);
+        }));
+    }
+    if (Bench::selected(options, "decompose_frame")) {
+        record(Bench::run("decompose_frame", "Mpix/s", (double)frameW * frameH / 1e6, options, [&] {
+            RobotLayerFrame layer = decomposeRobotFrame(frame, palette, frameW, frameH);
+            Bench::doNotOptimize(layer.alpha[layer.alpha.size() / 2]);
+        }));
+    }
+    std::vector<ScummVMRobot::PixelSpan> spans;
+    ScummVMRobot::buildOpaqueSpans(frame.data(), frameW, frameH, spans);
+    if (Bench::selected(options, "opaque_spans")) {
+        record(Bench::run("opaque_spans", "Mpix/s", (double)frameW * frameH / 1e6, options, [&] {
+            ScummVMRobot::buildOpaqueSpans(frame.data(), frameW, frameH, spans);
+            Bench::doNotOptimize(spans.size());
+        }));
+    }
+    if (Bench::selected(options, "decompose_spans")) {
+        record(Bench::run("decompose_spans", "Mpix/s", (double)frameW * frameH / 1e6, options, [&] {
+            RobotLayerFrame layer = decomposeRobotFrame(frame, palette, frameW, frameH, spans);
+            Bench::doNotOptimize(layer.alpha[layer.alpha.size() / 2]);
+        }));
+    }
+    std::vector<uint8_t> rgba((size_t)frameW * frameH * 4);
+    if (Bench::selected(options, "palette_rgba")) {
+        record(Bench::run("palette_rgba", "Mpix/s", (double)frameW * frameH / 1e6, options, [&] {
+            ScummVMRobot::indexedToRGBA(frame.data(), frame.size(), palette.data(), rgba.data());
+            Bench::doNotOptimize(rgba[rgba.size() / 2]);
+        }));
+    }
+    if (Bench::selected(options, "png_write")) {
+        ScummVMRobot::indexedToRGBA(frame.data(), frame.size(), palette.data(), rgba.data());
+        record(Bench::run("png_write", "Mpix/s", (double)frameW * frameH / 1e6, options, [&] {
+            size_t written = 0;
+            stbi_write_png_to_func(countBytes, &written, frameW, frameH, 4, rgba.data(), frameW * 4);
+            Bench::doNotOptimize(written);
+        }));
+    }
+
+    if (!jsonPath.empty()) {
+        nlohmann::json root;
+        root["seed"] = seed;
+        root["compressibility"] = compressibility;
+        root["iterations"] = options.iterations;
+        root["warmup"] = options.warmup;
+        nlohmann::json list = nlohmann::json::array();
+        for (const auto& r : results) {
+            list.push_back({
+                {"name", r.name}, {"unit", r.unit},
+                {"p50Ms", r.p50 * 1e3}, {"p90Ms", r.p90 * 1e3}, {"p99Ms", r.p99 * 1e3},
+                {"minMs", r.min * 1e3}, {"maxMs", r.max * 1e3},
+                {"p50Rate", r.throughput(r.p50)}, {"bestRate", r.throughput(r.min)}
+            });
+        }
+        root["results"] = list;
+        std::ofstream out(jsonPath, std::ios::trunc);
+        out << root.dump(2) << "\n";
+        if (!out.good()) {
+            fprintf(stderr, "Error: Cannot write %s\n", jsonPath.c_str());
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,89 @@
+#include "synthetic.h"
+#include <algorithm>
+#include <cmath>
+
+namespace Synthetic {
+
+std::vector<uint8_t> makePalette(uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::vector<uint8_t> palette(768);
+    for (int i = 0; i < 256; ++i) {
+        // 0-235 : rampes de 16 teintes ; 236-254 : couleurs remap vives
+        const int ramp = i / 16;
+        const int step = i % 16;
+        const int base = (int)(rng() % 64);
+        palette[i * 3 + 0] = (uint8_t)std::min(255, base + step * 12 + (ramp & 1) * 40);
+        palette[i * 3 + 1] = (uint8_t)std::min(255, base + step * 10 + (ramp & 2) * 20);
+        palette[i * 3 + 2] = (uint8_t)std::min(255, base + step * 8 + (ramp & 4) * 10);
+    }
+    for (int i = 236; i < 255; ++i) {
+        palette[i * 3 + 0] = (uint8_t)(rng() % 256);
+        palette[i * 3 + 1] = (uint8_t)(rng() % 256);
+        palette[i * 3 + 2] = (uint8_t)(rng() % 256);
+    }
+    palette[255 * 3 + 0] = 0;
+    palette[255 * 3 + 1] = 0;
+    palette[255 * 3 + 2] = 0;
+    return palette;
+}
+
+std::vector<uint8_t> makeCelPixels(int width, int height, double compressibility, std::mt19937& rng) {
+    std::vector<uint8_t> pixels((size_t)width * height, 255);
+    if (width <= 0 || height <= 0) {
+        return pixels;
+    }
+
+    compressibility = std::clamp(compressibility, 0.0, 1.0);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    const double noise = 1.0 - compressibility;
+
+    const double cx = width / 2.0, cy = height / 2.0;
+    const double rx = width * 0.48, ry = height * 0.48;
+    const int ramp = (int)(rng() % 14);      // Rampe de couleurs principale
+    const int bandHeight = 2 + (int)(compressibility * 12);
+
+    for (int y = 0; y < height; ++y) {
+        const double dy = (y - cy) / ry;
+        for (int x = 0; x < width; ++x) {
+            const double dx = (x - cx) / rx;
+            if (dx * dx + dy * dy > 1.0) {
+                continue;  // Fond transparent
+            }
+            // Dégradé vertical par bandes (suites d'octets identiques → copies LZS)
+            int shade = (y / bandHeight) % 16;
+            int index = ramp * 16 + shade;
+            if (unit(rng) < noise) {
+                index += (int)(rng() % 5) - 2;  // Tramage / texture
+            }
+            if (unit(rng) < 0.01) {
+                index = 236 + (int)(rng() % 19);  // Pixels remap
+            }
+            pixels[(size_t)y * width + x] = (uint8_t)std::clamp(index, 0, 254);
+        }
+    }
+    return pixels;
+}
+
+std::vector<int16_t> makeAudio(size_t numSamples, std::mt19937& rng) {
+    std::vector<int16_t> samples(numSamples);
+    const double fundamental = 110.0 + rng() % 120;
+    renderAudio(samples.data(), 0, numSamples, fundamental, rng);
+    return samples;
+}
+
+void renderAudio(int16_t* out, size_t firstSample, size_t count, double fundamental, std::mt19937& rng) {
+    std::normal_distribution<double> noise(0.0, 600.0);
+    const double kPi = 3.14159265358979323846;
+    const double f1 = fundamental;
+    const double f2 = f1 * 2.7;
+    for (size_t i = 0; i < count; ++i) {
+        const double t = (double)(firstSample + i) / 22050.0;
+        // Enveloppe syllabique (~4 Hz) avec silences
+        double env = std::max(0.0, std::sin(2.0 * kPi * 4.0 * t));
+        double v = env * (7000.0 * std::sin(2.0 * kPi * f1 * t) + 2500.0 * std::sin(2.0 * kPi * f2 * t))
+                 + env * noise(rng);
+        out[i] = (int16_t)std::clamp(v, -32768.0, 32767.0);
+    }
+}
+
+} // namespace Synthetic
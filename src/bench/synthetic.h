@@ -0,0 +1,36 @@
+#pragma once
+#include <cstdint>
+#include <random>
+#include <vector>
+
+/**
+ * Données synthétiques « réalistes » pour benchmarks et fichiers Robot générés
+ *
+ * Déterministes pour une graine donnée : deux exécutions mesurent exactement
+ * les mêmes entrées.
+ */
+namespace Synthetic {
+
+/** Palette 256 couleurs RGB (768 octets) : dégradés + zone remap 236-254 */
+std::vector<uint8_t> makePalette(uint32_t seed);
+
+/**
+ * Cel indexé width × height : silhouette elliptique sur fond transparent
+ * (255), dégradé par bandes, quelques pixels remap (236-254).
+ *
+ * @param compressibility  0 = bruit pur (LZS ~1:1), 1 = aplats (LZS > 10:1) ;
+ *                         ~0.7 donne des ratios proches des Robots réels
+ */
+std::vector<uint8_t> makeCelPixels(int width, int height, double compressibility, std::mt19937& rng);
+
+/** Audio mono 16 bits type voix : sinus modulés + bruit, enveloppe syllabique */
+std::vector<int16_t> makeAudio(size_t numSamples, std::mt19937& rng);
+
+/**
+ * Même signal que makeAudio, rendu par morceaux : échantillons
+ * [firstSample, firstSample + count) d'une piste de fondamentale donnée.
+ * Permet de produire des pistes très longues sans les garder en mémoire.
+ */
+void renderAudio(int16_t* out, size_t firstSample, size_t count, double fundamental, std::mt19937& rng);
+
+} // namespace Synthetic
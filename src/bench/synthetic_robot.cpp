@@ -0,0 +1,142 @@
+#include "synthetic_robot.h"
+#include "synthetic.h"
+#include "formats/rbt_writer.h"
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using RobotExtractor::RbtWriter;
+using RobotExtractor::RbtWriterAudio;
+using RobotExtractor::RbtWriterCel;
+using RobotExtractor::RbtWriterConfig;
+
+namespace Synthetic {
+
+// Pixels source max par cel : même au pire cas LZS (9 bits par octet),
+// le chunk tient dans le champ dataSize 16 bits
+static const size_t kMaxCelSourceBytes = 57000;
+
+/**
+ * Cels d'une frame : image width × height découpée en `numCels` bandes
+ * horizontales, chaque bande stockée sur height * verticalScale / 100 lignes
+ */
+static std::vector<RbtWriterCel> makeFrameCels(const RobotSpec& spec, int numCels, size_t frameIndex) {
+    const size_t content = spec.loop > 0 ? frameIndex % (size_t)spec.loop : frameIndex;
+    std::mt19937 rng(spec.seed * 7919u + (uint32_t)content);
+    const std::vector<uint8_t> image = makeCelPixels(spec.width, spec.height, spec.compressibility, rng);
+
+    // Léger déplacement d'une frame à l'autre (ancre celX/celY variable)
+    const uint16_t dx = (uint16_t)((frameIndex * 2) % 16);
+    const uint16_t dy = (uint16_t)(frameIndex % 8);
+
+    std::vector<RbtWriterCel> cels(numCels);
+    int y0 = 0;
+    for (int i = 0; i < numCels; ++i) {
+        const int bandHeight = (spec.height * (i + 1)) / numCels - y0;
+        RbtWriterCel& cel = cels[i];
+        cel.width = (uint16_t)spec.width;
+        cel.height = (uint16_t)bandHeight;
+        cel.verticalScale = (uint8_t)spec.verticalScale;
+        cel.celX = dx;
+        cel.celY = (uint16_t)(dy + y0);
+
+        const int sourceHeight = (bandHeight * spec.verticalScale) / 100;
+        cel.pixels.resize((size_t)spec.width * sourceHeight);
+        for (int r = 0; r < sourceHeight; ++r) {
+            const int srcY = y0 + (r * bandHeight) / std::max(1, sourceHeight);
+            std::copy_n(&image[(size_t)srcY * spec.width], spec.width, &cel.pixels[(size_t)r * spec.width]);
+        }
+        y0 += bandHeight;
+    }
+    return cels;
+}
+
+/** Échantillons entrelacés de la paire de frames `pair` (2 × samplesPerFrame) */
+static std::vector<int16_t> renderPair(const RobotSpec& spec, size_t pair, size_t samplesPerFrame) {
+    std::vector<int16_t> block(2 * samplesPerFrame);
+    std::mt19937 rng(spec.seed + (uint32_t)pair);
+    const double fundamental = 110.0 + spec.seed % 120;
+    renderAudio(block.data(), pair * block.size(), block.size(), fundamental, rng);
+    return block;
+}
+
+static std::vector<int16_t> channel(const std::vector<int16_t>& interleaved, int index) {
+    std::vector<int16_t> out(interleaved.size() / 2);
+    for (size_t k = 0; k < out.size(); ++k) {
+        out[k] = interleaved[2 * k + index];
+    }
+    return out;
+}
+
+bool writeRobot(const std::string& path, const RobotSpec& spec, RobotStats* stats) {
+    if (spec.width <= 0 || spec.height <= 0 || spec.width > 0xFFFF || spec.height > 0xFFFF) {
+        fprintf(stderr, "Error: Invalid robot size %dx%d\n", spec.width, spec.height);
+        return false;
+    }
+    if (spec.verticalScale < 1 || spec.verticalScale > 100 || spec.frameRate <= 0 || spec.frames == 0) {
+        fprintf(stderr, "Error: Invalid robot spec (vertical scale 1-100, frame rate > 0, frames > 0)\n");
+        return false;
+    }
+
+    // Assez de bandes pour que chaque cel tienne dans 64 Ko
+    const size_t sourceBytes = (size_t)spec.width * (size_t)((spec.height * spec.verticalScale) / 100);
+    const int minCels = (int)((sourceBytes + kMaxCelSourceBytes - 1) / kMaxCelSourceBytes);
+    const int numCels = std::clamp(std::max(spec.cels, minCels), 1, spec.height);
+    if (numCels > 10) {
+        fprintf(stderr, "Error: %dx%d needs %d cels per frame (max 10), reduce size or vertical scale\n",
+                spec.width, spec.height, numCels);
+        return false;
+    }
+
+    RbtWriterConfig config;
+    config.version = spec.version;
+    config.frameRate = spec.frameRate;
+    config.xResolution = (int16_t)spec.width;
+    config.yResolution = (int16_t)spec.height;
+    config.hasAudio = spec.audio;
+    RbtWriter writer(config);
+
+    // Audio : la paire de frames j couvre [2j, 2j+2) × samplesPerFrame du flux
+    // entrelacé. Le primer porte la paire 0 ; la frame f porte le canal f % 2
+    // de la paire f / 2 + 1 (l'audio précède l'image, comme dans les Robots réels).
+    const size_t samplesPerFrame = (size_t)(22050 / spec.frameRate);
+    std::vector<int16_t> evenPrimer, oddPrimer;
+    if (spec.audio) {
+        const std::vector<int16_t> first = renderPair(spec, 0, samplesPerFrame);
+        evenPrimer = channel(first, 0);
+        oddPrimer = channel(first, 1);
+    }
+
+    if (!writer.open(path, spec.frames, makePalette(spec.seed), evenPrimer, oddPrimer)) {
+        return false;
+    }
+
+    std::vector<int16_t> pairBlock;
+    for (size_t f = 0; f < spec.frames; ++f) {
+        RbtWriterAudio audio;
+        if (spec.audio) {
+            const int channelIndex = (int)(f % 2);
+            const size_t pair = f / 2 + 1;
+            if (channelIndex == 0 || pairBlock.empty()) {
+                pairBlock = renderPair(spec, pair, samplesPerFrame);
+            }
+            audio.audioPosition = (int32_t)(2 * pair * samplesPerFrame + channelIndex);
+            audio.samples = channel(pairBlock, channelIndex);
+        }
+        if (!writer.addFrame(makeFrameCels(spec, numCels, f), audio)) {
+            return false;
+        }
+    }
+    if (!writer.finish()) {
+        return false;
+    }
+
+    if (stats) {
+        stats->bytes = writer.bytesWritten();
+        stats->celsPerFrame = numCels;
+    }
+    return true;
+}
+
+} // namespace Synthetic
@@ -0,0 +1,36 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+/**
+ * Fichiers Robot synthétiques pour tests de charge et benchmarks de bout en bout
+ *
+ * Les cels proviennent de Synthetic::makeCelPixels, l'audio de
+ * Synthetic::renderAudio ; le tout est écrit par RobotExtractor::RbtWriter.
+ * Deux appels avec la même spec produisent des fichiers identiques.
+ */
+namespace Synthetic {
+
+struct RobotSpec {
+    uint16_t version = 5;        // 5 ou 6
+    uint16_t frames = 100;
+    int width = 320;             // Taille de l'image d'une frame
+    int height = 240;
+    int cels = 1;                // Cels par frame (bandes horizontales), relevé si un cel dépasse 64 Ko
+    double compressibility = 0.7;
+    int verticalScale = 100;     // < 100 : cels stockés écrasés en hauteur
+    int16_t frameRate = 10;
+    bool audio = true;
+    int loop = 0;                // > 0 : le contenu se répète toutes les `loop` frames
+    uint32_t seed = 1;
+};
+
+struct RobotStats {
+    uint64_t bytes = 0;
+    int celsPerFrame = 0;
+};
+
+/** Écrit un Robot conforme à spec ; false (message sur stderr) si impossible */
+bool writeRobot(const std::string& path, const RobotSpec& spec, RobotStats* stats = nullptr);
+
+} // namespace Synthetic
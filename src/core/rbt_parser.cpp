@@ -1,5 +1,6 @@
 #include "rbt_parser.h"
 #include "scummvm_robot_helpers.h"
+#include "robot_cel.h"
 #include <cassert>
 #include <cstring>
 #include <map>
@@ -17,6 +18,8 @@
 #include "utils/memory_stream.h"
 #include "formats/decompressor_lzs.h"
 #include "utils/sci_util.h"
+#include "utils/log.h"
+#include "utils/perf_stats.h"
 
 using namespace ScummVMRobot;
 
@@ -42,6 +45,8 @@ RbtParser::RbtParser(FILE *f) : _f(f), _fileOffset(0) {}
 RbtParser::~RbtParser() {}
 
 bool RbtParser::parseHeader() {
+    Perf::ScopedTimer timer(Perf::Stage::HeaderParse);
+
     // Ensure `_fileOffset` has a sensible default for standalone .RBT files.
     _fileOffset = 0;
 
@@ -50,7 +55,7 @@ bool RbtParser::parseHeader() {
     if (!seekSet(0)) return false;
     uint16_t id = readUint16LE();
     if (id != 0x16) {
-        std::fprintf(stderr, "parseHeader: invalid signature id=0x%04x\n", id);
+        LOG_ERROR(Parser, "parseHeader: invalid signature id=0x%04x\n", id);
         return false;
     }
 
@@ -64,7 +69,7 @@ bool RbtParser::parseHeader() {
     if (!seekSet(2)) return false;
     uint32_t tag = readUint32(true); // read as big-endian
     if (tag != 0x534f4c00) { // 'S' 'O' 'L' '\0'
-        std::fprintf(stderr, "parseHeader: invalid SOL tag=0x%08x\n", tag);
+        LOG_ERROR(Parser, "parseHeader: invalid SOL tag=0x%08x\n", tag);
         return false;
     }
 
@@ -72,7 +77,7 @@ bool RbtParser::parseHeader() {
     // Now read the version field using detected endianness.
     _version = _bigEndian ? readUint16BE() : readUint16LE();
     if (_version < 5 || _version > 6) {
-        std::fprintf(stderr, "Unsupported robot version=%u\n", _version);
+        LOG_ERROR(Parser, "Unsupported robot version=%u\n", _version);
         return false;
     }
 
@@ -87,8 +92,8 @@ bool RbtParser::parseHeader() {
     _primerReservedSize = _bigEndian ? readUint16BE() : readUint16LE();
 
     // reading x/y resolution
-    int16_t xRes = _bigEndian ? (int16_t)readUint16BE() : (int16_t)readUint16LE();
-    int16_t yRes = _bigEndian ? (int16_t)readUint16BE() : (int16_t)readUint16LE();
+    _xResolution = _bigEndian ? (int16_t)readUint16BE() : (int16_t)readUint16LE();
+    _yResolution = _bigEndian ? (int16_t)readUint16BE() : (int16_t)readUint16LE();
 
     // hasPalette + hasAudio
     uint8_t hasPalette = 0;
@@ -107,8 +112,7 @@ bool RbtParser::parseHeader() {
 
     // read four max cel areas
     for (int ii = 0; ii < 4; ++ii) {
-        int32_t val = readSint32(_bigEndian);
-        (void)val;
+        _maxCelArea[ii] = readSint32(_bigEndian);
     }
 
     // skip 8 reserved bytes
@@ -125,101 +129,31 @@ bool RbtParser::parseHeader() {
             _primerPosition = ftell(_f);
 
             if (_primerCompressionType != 0) {
-                std::fprintf(stderr, "Unknown primer compression type=%d\n", _primerCompressionType);
+                LOG_WARNING(Parser, "Unknown primer compression type=%d\n", _primerCompressionType);
             }
 
-            std::fprintf(stderr, "primer: even=%d odd=%d total=%d reserved=%u\n", 
+            LOG_DEBUG(Audio, "primer: even=%d odd=%d total=%d reserved=%u\n", 
                          _evenPrimerSize, _oddPrimerSize, _evenPrimerSize + _oddPrimerSize, _primerReservedSize);
 
             // total might be slightly less than reserved (padding)
             if (_evenPrimerSize + _oddPrimerSize > _primerReservedSize) {
-                // invalid, move pointer to after reserved area
-                fseek(_f, primerHeaderPosition + _primerReservedSize, SEEK_SET);
-            } else {
-                // read primer data into raw buffers
-                if (_evenPrimerSize > 0) {
-                    _primerEvenRaw.resize((size_t)_evenPrimerSize);
-                    if (fread(_primerEvenRaw.data(), 1, _primerEvenRaw.size(), _f) != _primerEvenRaw.size()) {
-                        _primerEvenRaw.clear();
-                    }
-                }
-                if (_oddPrimerSize > 0) {
-                    _primerOddRaw.resize((size_t)_oddPrimerSize);
-                    if (fread(_primerOddRaw.data(), 1, _primerOddRaw.size(), _f) != _primerOddRaw.size()) {
-                        _primerOddRaw.clear();
-                    }
-                }
-                fseek(_f, primerHeaderPosition + _primerReservedSize, SEEK_SET);
+                // invalid: no primer data
+                _primerPosition = 0;
             }
+            // primer data is read on first use (loadPrimer); move pointer to after reserved area
+            fseek(_f, primerHeaderPosition + _primerReservedSize, SEEK_SET);
         } else if (_primerZeroCompressFlag) {
             _evenPrimerSize = 19922;
             _oddPrimerSize = 21024;
             _totalPrimerSize = _evenPrimerSize + _oddPrimerSize;
             _primerPosition = -1;
-            if (_evenPrimerSize > 0) _primerEvenRaw.assign((size_t)_evenPrimerSize, 0);
-            if (_oddPrimerSize > 0) _primerOddRaw.assign((size_t)_oddPrimerSize, 0);
         }
     }
 
-    // Palette (HunkPalette format)
-    if (hasPalette) {
-        long palOffset = ftell(_f);
-        std::vector<uint8_t> rawPalette(_paletteSize);
-        fread(rawPalette.data(), 1, _paletteSize, _f);
-        
-        // Parse HunkPalette header
-        // Offset 10: numPalettes (1 byte)
-        uint8_t numPalettes = rawPalette[10];
-        
-        if (numPalettes == 1 && _paletteSize >= 35) {
-            // Skip hunk header (13 bytes) + palette offset table (2 bytes)
-            size_t entryOffset = 13 + 2 * numPalettes;
-            
-            // Read entry header (22 bytes total)
-            uint8_t startColor = rawPalette[entryOffset + 10];
-            uint16_t numColors = rawPalette[entryOffset + 14] | (rawPalette[entryOffset + 15] << 8);
-            uint8_t used = rawPalette[entryOffset + 16];
-            uint8_t sharedUsed = rawPalette[entryOffset + 17];
-            
-            std::fprintf(stderr, "HunkPalette: startColor=%u numColors=%u used=%u sharedUsed=%u\n",
-                        startColor, numColors, used, sharedUsed);
-            
-            // Palette data starts at entry offset + 22
-            size_t dataOffset = entryOffset + 22;
-            
-            // Allocate palette for 256 colors (initialized to black)
-            _paletteData.assign(768, 0);
-            
-            if (sharedUsed) {
-                // RGB format (3 bytes per color)
-                for (int i = 0; i < numColors && i + startColor < 256; ++i) {
-                    size_t srcIdx = dataOffset + i * 3;
-                    size_t dstIdx = (startColor + i) * 3;
-                    if (srcIdx + 2 < rawPalette.size()) {
-                        _paletteData[dstIdx] = rawPalette[srcIdx];
-                        _paletteData[dstIdx + 1] = rawPalette[srcIdx + 1];
-                        _paletteData[dstIdx + 2] = rawPalette[srcIdx + 2];
-                    }
-                }
-            } else {
-                // used+RGB format (4 bytes per color)
-                for (int i = 0; i < numColors && i + startColor < 256; ++i) {
-                    size_t srcIdx = dataOffset + i * 4;
-                    size_t dstIdx = (startColor + i) * 3;
-                    if (srcIdx + 3 < rawPalette.size()) {
-                        // Skip 'used' flag at srcIdx
-                        _paletteData[dstIdx] = rawPalette[srcIdx + 1];
-                        _paletteData[dstIdx + 1] = rawPalette[srcIdx + 2];
-                        _paletteData[dstIdx + 2] = rawPalette[srcIdx + 3];
-                    }
-                }
-            }
-        } else {
-            std::fprintf(stderr, "Warning: unexpected palette format (numPalettes=%u)\n", numPalettes);
-        }
-    } else {
-        fseek(_f, _paletteSize, SEEK_CUR);
-    }
+    // Palette (HunkPalette format): offset only, decoded on first getPalette()
+    _hasPalette = (hasPalette != 0);
+    _paletteOffset = ftell(_f);
+    fseek(_f, _paletteSize, SEEK_CUR);
 
     // Continue with existing code: read tables etc.
 
@@ -239,7 +173,7 @@ bool RbtParser::parseHeader() {
 
     // Debug: print first entries of the raw tables for inspection
     if (!tableA.empty()) {
-        std::fprintf(stderr, "tableA[0..4]: %u,%u,%u,%u,%u\n",
+        LOG_TRACE(Parser, "tableA[0..4]: %u,%u,%u,%u,%u\n",
                      tableA.size()>0? tableA[0]:0,
                      tableA.size()>1? tableA[1]:0,
                      tableA.size()>2? tableA[2]:0,
@@ -247,7 +181,7 @@ bool RbtParser::parseHeader() {
                      tableA.size()>4? tableA[4]:0);
     }
     if (!tableB.empty()) {
-        std::fprintf(stderr, "tableB[0..4]: %u,%u,%u,%u,%u\n",
+        LOG_TRACE(Parser, "tableB[0..4]: %u,%u,%u,%u,%u\n",
                      tableB.size()>0? tableB[0]:0,
                      tableB.size()>1? tableB[1]:0,
                      tableB.size()>2? tableB[2]:0,
@@ -328,7 +262,7 @@ bool RbtParser::parseHeader() {
             int count = 0;
             if (!swap) count = countPlausible(tableA, tableB);
             else count = countPlausible(tableB, tableA);
-            std::fprintf(stderr, "candidate offset=%d swap=%d plausible=%d\n", candidateOffset, swap, count);
+            LOG_TRACE(Parser, "candidate offset=%d swap=%d plausible=%d\n", candidateOffset, swap, count);
             if (count > bestCount) {
                 bestCount = count;
                 bestOffset = candidateOffset;
@@ -344,7 +278,7 @@ bool RbtParser::parseHeader() {
         _videoSizes = std::move(tableA);
         _packetSizes = std::move(tableB);
     }
-    std::fprintf(stderr, "chosen fileOffset=%ld tableSwap=%d plausible=%d\n", _fileOffset, bestSwap ? 1 : 0, bestCount);
+    LOG_DEBUG(Parser, "chosen fileOffset=%ld tableSwap=%d plausible=%d\n", _fileOffset, bestSwap ? 1 : 0, bestCount);
 
     // align to next 2048-byte sector (respecting file offset)
     long pos = ftell(_f);
@@ -363,11 +297,13 @@ bool RbtParser::parseHeader() {
         _recordPositions.push_back((uint32_t)cur);
     }
 
+    timer.setBytesIn((uint64_t)(_recordPositions.empty() ? 0 : _recordPositions[0]));
+
     // Debug prints
-    std::fprintf(stderr, "parseHeader: version=%u frames=%u audioBlockSize=%u hasAudio=%d paletteSize=%u primerReservedSize=%u\n",
+    LOG_DEBUG(Parser, "parseHeader: version=%u frames=%u audioBlockSize=%u hasAudio=%d paletteSize=%u primerReservedSize=%u\n",
                  _version, _numFramesTotal, _audioBlockSize, _hasAudio ? 1 : 0, _paletteSize, _primerReservedSize);
     if (!_videoSizes.empty()) {
-        std::fprintf(stderr, "videoSizes[0..4]: %u,%u,%u,%u,%u\n",
+        LOG_DEBUG(Parser, "videoSizes[0..4]: %u,%u,%u,%u,%u\n",
                      _videoSizes.size()>0? _videoSizes[0]:0,
                      _videoSizes.size()>1? _videoSizes[1]:0,
                      _videoSizes.size()>2? _videoSizes[2]:0,
@@ -375,7 +311,7 @@ bool RbtParser::parseHeader() {
                      _videoSizes.size()>4? _videoSizes[4]:0);
     }
     if (!_packetSizes.empty()) {
-        std::fprintf(stderr, "packetSizes[0..4]: %u,%u,%u,%u,%u\n",
+        LOG_DEBUG(Parser, "packetSizes[0..4]: %u,%u,%u,%u,%u\n",
                      _packetSizes.size()>0? _packetSizes[0]:0,
                      _packetSizes.size()>1? _packetSizes[1]:0,
                      _packetSizes.size()>2? _packetSizes[2]:0,
@@ -383,15 +319,145 @@ bool RbtParser::parseHeader() {
                      _packetSizes.size()>4? _packetSizes[4]:0);
     }
     if (!_recordPositions.empty()) {
-        std::fprintf(stderr, "first record position: %u\n", _recordPositions[0]);
+        LOG_DEBUG(Parser, "first record position: %u\n", _recordPositions[0]);
         for (size_t i = 0; i < _recordPositions.size(); ++i) {
-            std::fprintf(stderr, "record[%zu]=%u videoSize=%u packetSize=%u\n", i, _recordPositions[i], i < _videoSizes.size() ? _videoSizes[i] : 0, i < _packetSizes.size() ? _packetSizes[i] : 0);
+            LOG_TRACE(Parser, "record[%zu]=%u videoSize=%u packetSize=%u\n", i, _recordPositions[i], i < _videoSizes.size() ? _videoSizes[i] : 0, i < _packetSizes.size() ? _packetSizes[i] : 0);
         }
     }
 
     return true;
 }
 
+RbtHeaderInfo RbtParser::getHeaderInfo() const {
+    RbtHeaderInfo info;
+    info.version = _version;
+    info.numFrames = _numFramesTotal;
+    info.frameRate = _frameRate;
+    info.hasAudio = _hasAudio;
+    info.hasPalette = _hasPalette;
+    info.isHiRes = _isHiRes != 0;
+    info.xResolution = _xResolution;
+    info.yResolution = _yResolution;
+    info.maxSkippablePackets = _maxSkippablePackets;
+    info.maxCelsPerFrame = _maxCelsPerFrame;
+    for (int i = 0; i < 4; ++i) info.maxCelArea[i] = _maxCelArea[i];
+    info.paletteSize = _paletteSize;
+    info.audioBlockSize = _audioBlockSize;
+    info.primerSize = _totalPrimerSize;
+    for (size_t i = 0; i < _cueTimes.size() && i < _cueValues.size(); ++i) {
+        if (_cueTimes[i] != 0 || _cueValues[i] != 0) ++info.cueCount;
+    }
+    for (uint32_t v : _videoSizes) info.videoBytes += v;
+    for (uint32_t p : _packetSizes) info.packetBytes += p;
+    return info;
+}
+
+const std::vector<uint8_t>& RbtParser::getPalette() {
+    if (_paletteLoaded) {
+        return _paletteData;
+    }
+    _paletteLoaded = true;
+    if (!_hasPalette || _paletteSize == 0) {
+        return _paletteData;
+    }
+
+    long savedPosition = ftell(_f);
+    std::vector<uint8_t> rawPalette(_paletteSize);
+    fseek(_f, _paletteOffset, SEEK_SET);
+    size_t got = fread(rawPalette.data(), 1, _paletteSize, _f);
+    fseek(_f, savedPosition, SEEK_SET);
+    if (got != _paletteSize || _paletteSize < 11) {
+        LOG_WARNING(Parser, "truncated palette (%zu/%u bytes)\n", got, _paletteSize);
+        return _paletteData;
+    }
+    
+    // Parse HunkPalette header
+    // Offset 10: numPalettes (1 byte)
+    uint8_t numPalettes = rawPalette[10];
+    
+    if (numPalettes == 1 && _paletteSize >= 35) {
+        // Skip hunk header (13 bytes) + palette offset table (2 bytes)
+        size_t entryOffset = 13 + 2 * numPalettes;
+        
+        // Read entry header (22 bytes total)
+        uint8_t startColor = rawPalette[entryOffset + 10];
+        uint16_t numColors = rawPalette[entryOffset + 14] | (rawPalette[entryOffset + 15] << 8);
+        [[maybe_unused]] uint8_t used = rawPalette[entryOffset + 16];
+        uint8_t sharedUsed = rawPalette[entryOffset + 17];
+        
+        LOG_DEBUG(Parser, "HunkPalette: startColor=%u numColors=%u used=%u sharedUsed=%u\n",
+                    startColor, numColors, used, sharedUsed);
+        
+        // Palette data starts at entry offset + 22
+        size_t dataOffset = entryOffset + 22;
+        
+        // Allocate palette for 256 colors (initialized to black)
+        _paletteData.assign(768, 0);
+        
+        if (sharedUsed) {
+            // RGB format (3 bytes per color)
+            for (int i = 0; i < numColors && i + startColor < 256; ++i) {
+                size_t srcIdx = dataOffset + i * 3;
+                size_t dstIdx = (startColor + i) * 3;
+                if (srcIdx + 2 < rawPalette.size()) {
+                    _paletteData[dstIdx] = rawPalette[srcIdx];
+                    _paletteData[dstIdx + 1] = rawPalette[srcIdx + 1];
+                    _paletteData[dstIdx + 2] = rawPalette[srcIdx + 2];
+                }
+            }
+        } else {
+            // used+RGB format (4 bytes per color)
+            for (int i = 0; i < numColors && i + startColor < 256; ++i) {
+                size_t srcIdx = dataOffset + i * 4;
+                size_t dstIdx = (startColor + i) * 3;
+                if (srcIdx + 3 < rawPalette.size()) {
+                    // Skip 'used' flag at srcIdx
+                    _paletteData[dstIdx] = rawPalette[srcIdx + 1];
+                    _paletteData[dstIdx + 1] = rawPalette[srcIdx + 2];
+                    _paletteData[dstIdx + 2] = rawPalette[srcIdx + 3];
+                }
+            }
+        }
+    } else {
+        LOG_WARNING(Parser, "unexpected palette format (numPalettes=%u)\n", numPalettes);
+    }
+    return _paletteData;
+}
+
+void RbtParser::loadPrimer() {
+    if (_primerLoaded) {
+        return;
+    }
+    _primerLoaded = true;
+
+    if (_primerPosition < 0) {
+        // zero-compress flag: silent primers
+        if (_evenPrimerSize > 0) _primerEvenRaw.assign((size_t)_evenPrimerSize, 0);
+        if (_oddPrimerSize > 0) _primerOddRaw.assign((size_t)_oddPrimerSize, 0);
+        return;
+    }
+    if (_primerPosition == 0) {
+        return;
+    }
+
+    // read primer data into raw buffers (even then odd, right after the primer header)
+    long savedPosition = ftell(_f);
+    fseek(_f, _primerPosition, SEEK_SET);
+    if (_evenPrimerSize > 0) {
+        _primerEvenRaw.resize((size_t)_evenPrimerSize);
+        if (fread(_primerEvenRaw.data(), 1, _primerEvenRaw.size(), _f) != _primerEvenRaw.size()) {
+            _primerEvenRaw.clear();
+        }
+    }
+    if (_oddPrimerSize > 0) {
+        _primerOddRaw.resize((size_t)_oddPrimerSize);
+        if (fread(_primerOddRaw.data(), 1, _primerOddRaw.size(), _f) != _primerOddRaw.size()) {
+            _primerOddRaw.clear();
+        }
+    }
+    fseek(_f, savedPosition, SEEK_SET);
+}
+
 void RbtParser::dumpMetadata(const char *outDir) {
     std::string meta = std::string(outDir) + "/metadata.txt";
     std::ofstream os(meta);
@@ -408,7 +474,7 @@ void RbtParser::dumpMetadata(const char *outDir) {
         os << "primer_evenSize: " << _evenPrimerSize << "\n";
         os << "primer_oddSize: " << _oddPrimerSize << "\n";
     }
-    if (!_paletteData.empty()) {
+    if (!getPalette().empty()) {
         std::string palout = std::string(outDir) + "/palette.bin";
         std::ofstream p(palout, std::ios::binary);
         p.write((const char*)_paletteData.data(), _paletteData.size());
@@ -476,7 +542,7 @@ bool RbtParser::extractFrame(size_t frameIndex, const char *outDir) {
         if (!seekSet(pos)) return false;
         uint8_t tmp[24] = {0};
         if (fread(tmp,1,20,_f) != 20) return false;
-        std::fprintf(stderr, "  looksPlausibleAt: pos=%u bytes=%02x %02x %02x %02x %02x %02x\n",
+        LOG_TRACE(Cel, "  looksPlausibleAt: pos=%u bytes=%02x %02x %02x %02x %02x %02x\n",
                      (uint32_t)pos, tmp[0], tmp[1], tmp[2], tmp[3], tmp[4], tmp[5]);
         uint16_t screenCount = SciHelpers::READ_SCI11ENDIAN_UINT16(tmp);
         if (screenCount > 10) return false;
@@ -497,36 +563,36 @@ bool RbtParser::extractFrame(size_t frameIndex, const char *outDir) {
 
     // No scanning: if the recorded position is not plausible, skip frame.
     if (!looksPlausibleAt(startPos)) {
-        std::fprintf(stderr, "extractFrame: idx=%zu pos=%u not plausible at recorded position; skipping (no fallback)\n",
+        LOG_WARNING(Parser, "extractFrame: idx=%zu pos=%u not plausible at recorded position; skipping (no fallback)\n",
                      frameIndex, (uint32_t)startPos);
         return true;
     }
     if (!seekSet(startPos)) return false;
 
     uint32_t videoSize = _videoSizes[frameIndex];
-    std::fprintf(stderr, "extractFrame: idx=%zu pos=%u videoSize=%u\n", frameIndex, _recordPositions[frameIndex], videoSize);
+    LOG_DEBUG(Parser, "extractFrame: idx=%zu pos=%u videoSize=%u\n", frameIndex, _recordPositions[frameIndex], videoSize);
     if (videoSize == 0) return true;
 
     std::vector<uint8_t> buf(videoSize);
     if (fread(buf.data(),1,videoSize,_f) != videoSize) return false;
 
-    std::fprintf(stderr, "  first bytes: %02x %02x %02x %02x %02x %02x\n",
+    LOG_TRACE(Cel, "  first bytes: %02x %02x %02x %02x %02x %02x\n",
                  buf.size()>0?buf[0]:0, buf.size()>1?buf[1]:0, buf.size()>2?buf[2]:0,
                  buf.size()>3?buf[3]:0, buf.size()>4?buf[4]:0, buf.size()>5?buf[5]:0);
 
     // first field: number of cels (SCI11 endian 16)
     uint16_t screenItemCount = SciHelpers::READ_SCI11ENDIAN_UINT16(buf.data());
-    std::fprintf(stderr, "  screenItemCount(raw LE)=%u\n", screenItemCount);
+    LOG_DEBUG(Cel, "  screenItemCount(raw LE)=%u\n", screenItemCount);
 
     // ScummVM guard: if too many screen items, ignore this frame
     const uint16_t kScreenItemListSize = 10;
     if (screenItemCount > kScreenItemListSize) {
-        std::fprintf(stderr, "  screenItemCount %u > %u; skipping frame (ScummVM behaviour)\n", screenItemCount, kScreenItemListSize);
+        LOG_DEBUG(Parser, "  screenItemCount %u > %u; skipping frame (ScummVM behaviour)\n", screenItemCount, kScreenItemListSize);
         return true;
     }
 
     // Delegate to createCels5 (port of ScummVM RobotDecoder::createCels5)
-    createCels5(buf.data()+2, (int16_t)screenItemCount, outDir, frameIndex);
+    createCels5(buf.data()+2, (int16_t)screenItemCount, outDir, frameIndex, buf.size() - 2);
 
     return true;
 }
@@ -570,18 +636,20 @@ void RbtParser::setCanvasMode(int16_t x, int16_t y, uint16_t canvasWidth, uint16
     _canvasY = y;
     _canvasWidth = canvasWidth;
     _canvasHeight = canvasHeight;
-    std::fprintf(stderr, "Mode canvas activé: position (%d, %d) sur canvas %ux%u\n", x, y, canvasWidth, canvasHeight);
+    _frameCache.clear();
+    LOG_INFO(Parser, "Mode canvas activé: position (%d, %d) sur canvas %ux%u\n", x, y, canvasWidth, canvasHeight);
 }
 
 void RbtParser::disableCanvasMode() {
     _useCanvasMode = false;
-    std::fprintf(stderr, "Mode canvas désactivé: extraction en crop serré\n");
+    _frameCache.clear();
+    LOG_INFO(Parser, "Mode canvas désactivé: extraction en crop serré\n");
 }
 
 void RbtParser::computeMaxDimensions() {
     if (_maxDimensionsComputed) return;
     
-    std::fprintf(stderr, "Calcul des dimensions maximales du Robot...\n");
+    LOG_INFO(Parser, "Calcul des dimensions maximales du Robot...\n");
     
     _maxCelWidth = 0;
     _maxCelHeight = 0;
@@ -639,110 +707,35 @@ void RbtParser::computeMaxDimensions() {
     if (_maxCelWidth % 2 != 0) _maxCelWidth++;
     if (_maxCelHeight % 2 != 0) _maxCelHeight++;
     
-    std::fprintf(stderr, "✓ Dimensions maximales: %ux%u (analysé %d frames)\n", 
+    LOG_INFO(Parser, "✓ Dimensions maximales: %ux%u (analysé %d frames)\n", 
                  _maxCelWidth, _maxCelHeight, framesProcessed);
     
     _maxDimensionsComputed = true;
+    _frameCache.clear();  // Les frames en cache ont été composées avec l'ancienne taille
     
     // Restaurer position
     fseek(_f, savedPos, SEEK_SET);
 }
 
-uint32_t RbtParser::createCel5(const uint8_t *rawVideoData, const int16_t screenItemIndex, const char *outDir, size_t frameIndex) {
-    const uint8_t verticalScale = rawVideoData[1];
-    const uint16_t celWidth = SciHelpers::READ_SCI11ENDIAN_UINT16(rawVideoData + 2);
-    const uint16_t celHeight = SciHelpers::READ_SCI11ENDIAN_UINT16(rawVideoData + 4);
-    const uint16_t celX = SciHelpers::READ_SCI11ENDIAN_UINT16(rawVideoData + 10);
-    const uint16_t celY = SciHelpers::READ_SCI11ENDIAN_UINT16(rawVideoData + 12);
-    const uint16_t dataSize = SciHelpers::READ_SCI11ENDIAN_UINT16(rawVideoData + 14);
-    const int16_t numDataChunks = (int16_t)SciHelpers::READ_SCI11ENDIAN_UINT16(rawVideoData + 16);
-
-    const uint8_t *p = rawVideoData + 22; // kCelHeaderSize
-
-    std::fprintf(stderr, "    cel %d: pos=(%u,%u) w=%u h=%u dataSize=%u chunks=%d\n", 
-                 screenItemIndex, celX, celY, celWidth, celHeight, dataSize, numDataChunks);
-
-    const uint64_t area = (uint64_t)celWidth * (uint64_t)celHeight;
-    if (area > 20000000) {
-        std::fprintf(stderr, "    cel area too large (%lu), skipping\n", (unsigned long)area);
+uint32_t RbtParser::createCel5(const uint8_t *rawVideoData, const int16_t screenItemIndex, const char *outDir, size_t frameIndex, size_t available) {
+    RobotCel cel;
+    if (!readCelHeader(rawVideoData, available, cel)) {
         return 0;
     }
+    const uint16_t celWidth = cel.width;
+    const uint16_t celHeight = cel.height;
+    const uint16_t celX = cel.celX;
+    const uint16_t celY = cel.celY;
+    const uint16_t dataSize = cel.dataSize;
 
-    // If verticalScale != 100 we will decompress into a temporary "squashed"
-    // buffer and then expand to the target size.
-    const int verticalScaleFactor = verticalScale;
-    int sourceHeight = (celHeight * verticalScaleFactor) / 100;
-    const size_t decompressedArea = (verticalScaleFactor == 100) ? (size_t)area : (size_t)celWidth * (size_t)sourceHeight;
-
-    std::vector<uint8_t> decompressed;
-    decompressed.reserve(decompressedArea);
-
-    for (int i = 0; i < numDataChunks; ++i) {
-        const uint32_t compSize = SciHelpers::READ_SCI11ENDIAN_UINT32(p);
-        const uint32_t decompSize = SciHelpers::READ_SCI11ENDIAN_UINT32(p + 4);
-        const uint16_t compressionType = SciHelpers::READ_SCI11ENDIAN_UINT16(p + 8);
-        p += 10;
-
-        std::fprintf(stderr, "      chunk %d: compSize=%u decompSize=%u compType=%u ptr=%ld\n", i, compSize, decompSize, compressionType, (long)(p - rawVideoData));
-
-        if (compressionType == kCompressionNone) {
-            // raw copy
-            decompressed.insert(decompressed.end(), p, p + decompSize);
-        } else if (compressionType == kCompressionLZS) {
-            // Use Common::MemoryReadStream + DecompressorLZS::unpack (mimic ScummVM path)
-            Common::MemoryReadStream mrs(p, compSize);
-            DecompressorLZS dec;
-            std::vector<uint8_t> out(decompSize);
-            int rc = dec.unpack(&mrs, out.data(), compSize, decompSize);
-            if (rc != 0) {
-                std::fprintf(stderr, "      DecompressorLZS::unpack failed rc=%d\n", rc);
-                return 0;
-            }
-            decompressed.insert(decompressed.end(), out.begin(), out.end());
-        } else {
-            std::fprintf(stderr, "Unknown compression type %u\n", compressionType);
-            return 0;
-        }
-
-        p += compSize;
-    }
-
-    // Now produce final pixel indices, applying vertical expansion if needed
-    std::vector<uint8_t> finalPixels;
-    finalPixels.resize(area);
+    LOG_DEBUG(Cel, "    cel %d: pos=(%u,%u) w=%u h=%u dataSize=%u chunks=%d\n", 
+                 screenItemIndex, celX, celY, celWidth, celHeight, dataSize, cel.numDataChunks);
 
-    if (verticalScaleFactor == 100) {
-        if (decompressed.size() >= area) {
-            std::copy_n(decompressed.data(), area, finalPixels.data());
-        } else {
-            // truncated decompressed data - fill with zeros
-            std::fill(finalPixels.begin(), finalPixels.end(), 0);
-        }
-    } else {
-        // source height is shrunk, expand lines
-        if (sourceHeight <= 0) sourceHeight = 1;
-        int numerator = celHeight;
-        int denominator = sourceHeight;
-        int remainder = 0;
-        const uint8_t *srcPtr = decompressed.data();
-        uint8_t *dstPtr = finalPixels.data();
-        for (int y = sourceHeight - 1; y >= 0; --y) {
-            remainder += numerator;
-            int linesToDraw = remainder / denominator;
-            remainder %= denominator;
-
-            for (int l = 0; l < linesToDraw; ++l) {
-                if ((size_t)(srcPtr - decompressed.data()) + celWidth <= decompressed.size()) {
-                    std::copy_n(srcPtr, celWidth, dstPtr);
-                } else {
-                    // out of data: fill with 0
-                    std::fill_n(dstPtr, celWidth, 0);
-                }
-                dstPtr += celWidth;
-            }
-            srcPtr += celWidth;
-        }
+    // Décompression + expansion verticale (décodeur partagé, cf. robot_cel.cpp)
+    if (decodeRobotCel(rawVideoData, available, cel) == 0) {
+        return 0;
     }
+    const std::vector<uint8_t>& finalPixels = cel.pixels;
 
     // write PPM (RGB) avec palette
     char name[512];
@@ -779,7 +772,7 @@ uint32_t RbtParser::createCel5(const uint8_t *rawVideoData, const int16_t screen
     int paddedWidth = roundToEven(finalWidth);
     int paddedHeight = roundToEven(finalHeight);
     
-    if (!_paletteData.empty() && _paletteSize >= 768) {
+    if (!getPalette().empty() && _paletteSize >= 768) {
         snprintf(name, sizeof(name), "%s/frame_%04zu_cel_%02d.ppm", outDir, frameIndex, screenItemIndex);
         std::ofstream img(name, std::ios::binary);
         img << "P6\n" << paddedWidth << " " << paddedHeight << "\n255\n";
@@ -836,56 +829,240 @@ uint32_t RbtParser::createCel5(const uint8_t *rawVideoData, const int16_t screen
     return 22 + dataSize;
 }
 
-void RbtParser::createCels5(const uint8_t *rawVideoData, const int16_t numCels, const char *outDir, size_t frameIndex) {
+void RbtParser::createCels5(const uint8_t *rawVideoData, const int16_t numCels, const char *outDir, size_t frameIndex, size_t available) {
     const uint8_t *p = rawVideoData;
+    const uint8_t *end = rawVideoData + available;
     for (int16_t i = 0; i < numCels; ++i) {
-        uint32_t consumed = createCel5(p, i, outDir, frameIndex);
+        uint32_t consumed = createCel5(p, i, outDir, frameIndex, (size_t)(end - p));
         if (consumed == 0) break;
         p += consumed;
     }
 }
 
+bool RbtParser::extractFrameCels(size_t frameIndex, std::vector<RobotCel>& outCels) {
+    outCels.clear();
+    if (frameIndex >= _recordPositions.size() || frameIndex >= _videoSizes.size()) {
+        return false;
+    }
+
+    const uint32_t videoSize = _videoSizes[frameIndex];
+    if (videoSize == 0) {
+        return true;  // Frame sans vidéo
+    }
+    if (videoSize < 2 || !seekSet(_recordPositions[frameIndex])) {
+        return false;
+    }
+
+    std::vector<uint8_t> rawVideoData(videoSize);
+    if (fread(rawVideoData.data(), 1, videoSize, _f) != videoSize) {
+        return false;
+    }
+
+    const uint16_t numCels = SciHelpers::READ_SCI11ENDIAN_UINT16(rawVideoData.data());
+    if (numCels > 10) {
+        return true;  // Comportement ScummVM : frame ignorée
+    }
+
+    const uint8_t *p = rawVideoData.data() + 2;
+    const uint8_t *end = rawVideoData.data() + videoSize;
+    outCels.reserve(numCels);
+    for (uint16_t i = 0; i < numCels; ++i) {
+        RobotCel cel;
+        uint32_t consumed = decodeRobotCel(p, (size_t)(end - p), cel);
+        if (consumed == 0) {
+            return false;
+        }
+        outCels.push_back(std::move(cel));
+        p += consumed;
+    }
+    return true;
+}
+
 // ----------------------------------------------------------------------------
-// Helper: interpolateChannel
-// Interpolation des échantillons manquants dans un canal
-// Basé sur ScummVM robot_decoder.cpp (interpolateChannel)
+// verify - Contrôle d'intégrité complet, lecture séquentielle par grands blocs
 // ----------------------------------------------------------------------------
-static void interpolateChannel(int16_t *buffer, int32_t numSamples, const int8_t bufferIndex) {
-    if (numSamples <= 0) {
-        return;
+
+// Fenêtre de lecture glissante : les enregistrements étant rangés dans l'ordre
+// des frames, chaque fenêtre prolonge la précédente et le fichier est lu une
+// seule fois, sans seek arrière.
+namespace {
+class SequentialWindow {
+public:
+    SequentialWindow(FILE *f, uint64_t fileSize) : _f(f), _fileSize(fileSize) {}
+
+    // Rend [pos, pos + len) lisible en mémoire ; nullptr si hors fichier
+    const uint8_t *ensure(uint64_t pos, size_t len) {
+        if (pos + len > _fileSize) return nullptr;
+        if (pos >= _start && pos + len <= _start + _buffer.size()) {
+            return _buffer.data() + (pos - _start);
+        }
+        // Conserver le recouvrement éventuel, lire le reste d'un bloc
+        const size_t want = (size_t)std::min<uint64_t>(std::max(len, kWindowSize), _fileSize - pos);
+        size_t kept = 0;
+        if (pos >= _start && pos < _start + _buffer.size()) {
+            kept = (size_t)(_start + _buffer.size() - pos);
+            std::memmove(_buffer.data(), _buffer.data() + (pos - _start), kept);
+        }
+        _buffer.resize(std::max(want, kept));
+        if (fseek(_f, (long)(pos + kept), SEEK_SET) != 0) return nullptr;
+        const size_t got = fread(_buffer.data() + kept, 1, _buffer.size() - kept, _f);
+        _bytesRead += got;
+        _buffer.resize(kept + got);
+        _start = pos;
+        return _buffer.size() >= len ? _buffer.data() : nullptr;
     }
 
-    int16_t *inBuffer, *outBuffer;
-    int16_t sample, previousSample;
+    uint64_t bytesRead() const { return _bytesRead; }
 
-    // kEOSExpansion = 2 (expansion every-other-sample)
-    constexpr int kEOSExpansion = 2;
+private:
+    static constexpr size_t kWindowSize = 4 * 1024 * 1024;
+    FILE *_f;
+    uint64_t _fileSize;
+    uint64_t _start = 0;
+    uint64_t _bytesRead = 0;
+    std::vector<uint8_t> _buffer;
+};
+}
 
-    if (bufferIndex) {
-        // Canal ODD (indices impairs: 1, 3, 5...)
-        outBuffer = buffer + 1;
-        inBuffer = buffer + 2;
-        previousSample = sample = *buffer;
-        --numSamples;
-    } else {
-        // Canal EVEN (indices pairs: 0, 2, 4...)
-        outBuffer = buffer;
-        inBuffer = buffer + 1;
-        previousSample = sample = *inBuffer;
+// Valide un cel (en-tête, chunks, décompression LZS) sans produire de pixels.
+// Retourne les octets consommés, 0 en cas d'erreur (raison dans `reason`).
+static uint32_t verifyCel(const uint8_t *rawCel, size_t available, std::vector<uint8_t>& scratch,
+                          std::string& reason) {
+    RobotCel cel;
+    if (!readCelHeader(rawCel, available, cel)) {
+        reason = "cel header truncated";
+        return 0;
+    }
+    if ((uint64_t)cel.width * cel.height > 20000000) {
+        reason = "cel area too large";
+        return 0;
     }
+    if (kCelHeaderSize + cel.dataSize > available) {
+        reason = "cel data exceeds videoSize";
+        return 0;
+    }
+    const uint8_t *p = rawCel + kCelHeaderSize;
+    const uint8_t *end = p + cel.dataSize;
+    for (int i = 0; i < cel.numDataChunks; ++i) {
+        if (p + kCelChunkHeaderSize > end) {
+            reason = "chunk header truncated";
+            return 0;
+        }
+        const uint32_t compSize = SciHelpers::READ_SCI11ENDIAN_UINT32(p);
+        const uint32_t decompSize = SciHelpers::READ_SCI11ENDIAN_UINT32(p + 4);
+        const uint16_t compressionType = SciHelpers::READ_SCI11ENDIAN_UINT16(p + 8);
+        p += kCelChunkHeaderSize;
+        if (compSize > (size_t)(end - p) || decompSize > 20000000) {
+            reason = "chunk exceeds cel data";
+            return 0;
+        }
+        if (compressionType == kCompressionLZS) {
+            if (scratch.size() < decompSize) scratch.resize(decompSize);
+            Common::MemoryReadStream mrs(p, compSize);
+            DecompressorLZS dec;
+            if (dec.unpack(&mrs, scratch.data(), compSize, decompSize) != 0) {
+                reason = "LZS decode failed";
+                return 0;
+            }
+        } else if (compressionType != kCompressionNone) {
+            reason = "unknown chunk compression";
+            return 0;
+        }
+        p += compSize;
+    }
+    return (uint32_t)(kCelHeaderSize + cel.dataSize);
+}
+
+bool RbtParser::verify(RbtVerifyReport& report) {
+    report = RbtVerifyReport();
+    if (!_f) return false;
 
-    while (numSamples--) {
-        // Interpolation linéaire: moyenne des deux échantillons voisins
-        sample = (*inBuffer + previousSample) >> 1;
-        previousSample = *inBuffer;
-        *outBuffer = sample;
-        inBuffer += kEOSExpansion;
-        outBuffer += kEOSExpansion;
+    const long savedPosition = ftell(_f);
+    if (fseek(_f, 0, SEEK_END) != 0) return false;
+    const uint64_t fileSize = (uint64_t)ftell(_f);
+    SequentialWindow window(_f, fileSize);
+    std::vector<uint8_t> scratch;
+
+    auto markBad = [&](size_t frame, const std::string& reason) {
+        report.badFrames++;
+        if (!report.corruptRanges.empty() && report.corruptRanges.back().lastFrame + 1 == frame) {
+            report.corruptRanges.back().lastFrame = frame;
+        } else {
+            report.corruptRanges.push_back({frame, frame, reason});
+        }
+    };
+
+    // Primer annoncé mais non localisé par parseHeader
+    if (_hasAudio && _primerReservedSize != 0 && _primerPosition == 0) {
+        report.headerIssues.push_back("invalid audio primer");
     }
 
-    if (bufferIndex) {
-        *outBuffer = sample;
+    const size_t numFrames = std::min({(size_t)_numFramesTotal, _recordPositions.size(),
+                                       _videoSizes.size(), _packetSizes.size()});
+    for (size_t frame = 0; frame < numFrames; ++frame) {
+        report.framesChecked++;
+        const uint64_t recordPos = _recordPositions[frame];
+        const uint32_t videoSize = _videoSizes[frame];
+        const uint32_t packetSize = _packetSizes[frame];
+
+        if (recordPos + packetSize > fileSize) {
+            markBad(frame, "record past end of file");
+            continue;
+        }
+        if (videoSize > packetSize) {
+            markBad(frame, "videoSize exceeds packetSize");
+            continue;
+        }
+        const uint8_t *record = window.ensure(recordPos, packetSize);
+        if (!record) {
+            markBad(frame, "read error");
+            continue;
+        }
+
+        std::string reason;
+        if (videoSize == 1) {
+            reason = "videoSize too small";
+        } else if (videoSize >= 2) {
+            // Frame vidéo : [screenItemCount][cels...]
+            const uint16_t screenItemCount = SciHelpers::READ_SCI11ENDIAN_UINT16(record);
+            if (screenItemCount > 10) {
+                reason = "screen item count > 10";
+            }
+            const uint8_t *p = record + 2;
+            size_t remaining = videoSize - 2;
+            for (uint16_t i = 0; reason.empty() && i < screenItemCount; ++i) {
+                const uint32_t consumed = verifyCel(p, remaining, scratch, reason);
+                if (consumed == 0) break;
+                p += consumed;
+                remaining -= consumed;
+                report.celsChecked++;
+            }
+        }
+
+        // Paquet audio : [position absolue][taille][données]
+        if (reason.empty() && _hasAudio && packetSize > videoSize) {
+            const uint32_t audioBytes = packetSize - videoSize;
+            if (audioBytes < 8) {
+                reason = "audio header truncated";
+            } else {
+                const int32_t position = (int32_t)read_u32_from_buf(record + videoSize, _bigEndian);
+                const int32_t blockSize = (int32_t)read_u32_from_buf(record + videoSize + 4, _bigEndian);
+                if (position < 0 || blockSize <= 0 || 8 + (uint64_t)blockSize > audioBytes) {
+                    reason = "invalid audio header";
+                } else {
+                    report.audioPackets++;
+                }
+            }
+        }
+
+        if (!reason.empty()) {
+            markBad(frame, reason);
+        }
     }
+
+    report.bytesRead = window.bytesRead();
+    fseek(_f, savedPosition, SEEK_SET);
+    return true;
 }
 
 // ----------------------------------------------------------------------------
@@ -926,9 +1103,10 @@ static void writeWavHeader(FILE *f, uint32_t sampleRate, uint16_t numChannels, u
 // ----------------------------------------------------------------------------
 void RbtParser::extractAudio(const char *outDir, size_t maxFrames) {
     if (!_hasAudio) {
-        std::fprintf(stderr, "No audio in file\n");
+        LOG_INFO(Audio, "No audio in file\n");
         return;
     }
+    Perf::ScopedTimer timer(Perf::Stage::Audio);
 
     // Si maxFrames == 0, extraire toutes les frames
     if (maxFrames == 0) maxFrames = _numFramesTotal;
@@ -949,7 +1127,8 @@ void RbtParser::extractAudio(const char *outDir, size_t maxFrames) {
     // ÉTAPE 1: Extraire les PRIMERS (si présents)
     // Les primers initialisent les buffers audio avant la lecture des frames
     // ========================================================================
-    std::fprintf(stderr, "Audio extraction: evenPrimerSize=%d oddPrimerSize=%d\n",
+    loadPrimer();
+    LOG_DEBUG(Audio, "Audio extraction: evenPrimerSize=%d oddPrimerSize=%d\n",
                 _evenPrimerSize, _oddPrimerSize);
     
     if (_evenPrimerSize > 0 && _oddPrimerSize > 0 && !_primerEvenRaw.empty() && !_primerOddRaw.empty()) {
@@ -963,7 +1142,7 @@ void RbtParser::extractAudio(const char *outDir, size_t maxFrames) {
             audioBuffer[evenWritePos] = evenSamples[s];
             evenWritePos += 2;
         }
-        std::fprintf(stderr, "  Primer EVEN: %d samples written\n", _evenPrimerSize);
+        LOG_DEBUG(Audio, "  Primer EVEN: %d samples written\n", _evenPrimerSize);
         
         // Primer ODD (canal impair)
         std::vector<int16_t> oddSamples(_oddPrimerSize);
@@ -975,7 +1154,7 @@ void RbtParser::extractAudio(const char *outDir, size_t maxFrames) {
             audioBuffer[oddWritePos] = oddSamples[s];
             oddWritePos += 2;
         }
-        std::fprintf(stderr, "  Primer ODD: %d samples written\n", _oddPrimerSize);
+        LOG_DEBUG(Audio, "  Primer ODD: %d samples written\n", _oddPrimerSize);
     }
 
     // ========================================================================
@@ -984,6 +1163,7 @@ void RbtParser::extractAudio(const char *outDir, size_t maxFrames) {
     // IMPORTANT: Ne pas générer d'audio pour les frames skip (videoSize == 0)
     // ========================================================================
     size_t packetsProcessed = 0;
+    uint64_t packetBytes = 0;
     
     for (size_t frameIdx = 0; frameIdx < maxFrames && frameIdx < _packetSizes.size(); ++frameIdx) {
         if (_packetSizes[frameIdx] == 0) continue;
@@ -991,7 +1171,7 @@ void RbtParser::extractAudio(const char *outDir, size_t maxFrames) {
         // Vérifier si c'est une frame skip (pas de vidéo)
         // Les frames skip ne doivent PAS générer d'audio pour maintenir la sync A/V
         if (frameIdx < _videoSizes.size() && _videoSizes[frameIdx] == 0) {
-            std::fprintf(stderr, "  Frame %zu: skip (no video) - audio position not advanced\n", frameIdx);
+            LOG_TRACE(Audio, "  Frame %zu: skip (no video) - audio position not advanced\n", frameIdx);
             continue;
         }
         
@@ -1038,16 +1218,18 @@ void RbtParser::extractAudio(const char *outDir, size_t maxFrames) {
         }
         
         packetsProcessed++;
+        Perf::count(Perf::Counter::Packets);
+        packetBytes += (uint64_t)audioBlockSize;
     }
     
-    std::fprintf(stderr, "  Processed %zu audio packets from frames\n", packetsProcessed);
+    LOG_INFO(Audio, "  Processed %zu audio packets from frames\n", packetsProcessed);
 
     // ========================================================================
     // ÉTAPE 3: Interpolation des canaux EVEN/ODD
     // L'interpolation lisse les transitions entre les deux canaux entrelacés
     // pour créer un flux audio continu sans discontinuités.
     // ========================================================================
-    std::fprintf(stderr, "Interpolating missing samples...\n");
+    LOG_DEBUG(Audio, "Interpolating missing samples...\n");
     interpolateChannel(audioBuffer.data(), totalSamples / 2, 0);
     interpolateChannel(audioBuffer.data(), totalSamples / 2, 1);
 
@@ -1057,7 +1239,7 @@ void RbtParser::extractAudio(const char *outDir, size_t maxFrames) {
     std::string audioPath = std::string(outDir) + "/audio.wav";
     FILE *audioFile = fopen(audioPath.c_str(), "wb");
     if (!audioFile) {
-        std::fprintf(stderr, "Failed to create audio file: %s\n", audioPath.c_str());
+        LOG_ERROR(Audio, "Failed to create audio file: %s\n", audioPath.c_str());
         return;
     }
     
@@ -1065,16 +1247,19 @@ void RbtParser::extractAudio(const char *outDir, size_t maxFrames) {
     fwrite(audioBuffer.data(), sizeof(int16_t), audioBuffer.size(), audioFile);
     fclose(audioFile);
     
-    std::fprintf(stderr, "\nWrote %s: %zu samples (%.2f seconds @ 22050Hz)\n",
+    timer.setBytesIn(packetBytes);
+    timer.setBytesOut(audioBuffer.size() * sizeof(int16_t));
+    LOG_INFO(Audio, "\nWrote %s: %zu samples (%.2f seconds @ 22050Hz)\n",
                  audioPath.c_str(), audioBuffer.size(), (double)audioBuffer.size() / 22050.0);
 }
 
 // Surcharge acceptant un chemin complet pour le fichier WAV
 void RbtParser::extractAudio(const std::string& outputWavPath, size_t maxFrames) {
     if (!_hasAudio) {
-        std::fprintf(stderr, "No audio in file\n");
+        LOG_INFO(Audio, "No audio in file\n");
         return;
     }
+    Perf::ScopedTimer timer(Perf::Stage::Audio);
 
     // Si maxFrames == 0, extraire toutes les frames
     if (maxFrames == 0) maxFrames = _numFramesTotal;
@@ -1086,7 +1271,8 @@ void RbtParser::extractAudio(const std::string& outputWavPath, size_t maxFrames)
     size_t evenWritePos = 0;
     size_t oddWritePos = 1;
 
-    std::fprintf(stderr, "Audio extraction: evenPrimerSize=%d oddPrimerSize=%d\n",
+    loadPrimer();
+    LOG_DEBUG(Audio, "Audio extraction: evenPrimerSize=%d oddPrimerSize=%d\n",
                 _evenPrimerSize, _oddPrimerSize);
     
     if (_evenPrimerSize > 0 && _oddPrimerSize > 0 && !_primerEvenRaw.empty() && !_primerOddRaw.empty()) {
@@ -1098,7 +1284,7 @@ void RbtParser::extractAudio(const std::string& outputWavPath, size_t maxFrames)
             audioBuffer[evenWritePos] = evenSamples[s];
             evenWritePos += 2;
         }
-        std::fprintf(stderr, "  Primer EVEN: %d samples written\n", _evenPrimerSize);
+        LOG_DEBUG(Audio, "  Primer EVEN: %d samples written\n", _evenPrimerSize);
         
         std::vector<int16_t> oddSamples(_oddPrimerSize);
         carry = 0;
@@ -1108,10 +1294,11 @@ void RbtParser::extractAudio(const std::string& outputWavPath, size_t maxFrames)
             audioBuffer[oddWritePos] = oddSamples[s];
             oddWritePos += 2;
         }
-        std::fprintf(stderr, "  Primer ODD: %d samples written\n", _oddPrimerSize);
+        LOG_DEBUG(Audio, "  Primer ODD: %d samples written\n", _oddPrimerSize);
     }
 
     size_t packetsProcessed = 0;
+    uint64_t packetBytes = 0;
     
     for (size_t frameIdx = 0; frameIdx < maxFrames && frameIdx < _packetSizes.size(); ++frameIdx) {
         if (_packetSizes[frameIdx] == 0) continue;
@@ -1119,7 +1306,7 @@ void RbtParser::extractAudio(const std::string& outputWavPath, size_t maxFrames)
         // Vérifier si c'est une frame skip (pas de vidéo)
         // Les frames skip ne doivent PAS générer d'audio pour maintenir la sync A/V
         if (frameIdx < _videoSizes.size() && _videoSizes[frameIdx] == 0) {
-            std::fprintf(stderr, "  Frame %zu: skip (no video) - audio position not advanced\n", frameIdx);
+            LOG_TRACE(Audio, "  Frame %zu: skip (no video) - audio position not advanced\n", frameIdx);
             continue;
         }
         
@@ -1160,16 +1347,18 @@ void RbtParser::extractAudio(const std::string& outputWavPath, size_t maxFrames)
         }
         
         packetsProcessed++;
+        Perf::count(Perf::Counter::Packets);
+        packetBytes += (uint64_t)audioBlockSize;
     }
     
-    std::fprintf(stderr, "  Processed %zu audio packets from frames\n", packetsProcessed);
-    std::fprintf(stderr, "Interpolating missing samples...\n");
+    LOG_INFO(Audio, "  Processed %zu audio packets from frames\n", packetsProcessed);
+    LOG_DEBUG(Audio, "Interpolating missing samples...\n");
     interpolateChannel(audioBuffer.data(), totalSamples / 2, 0);
     interpolateChannel(audioBuffer.data(), totalSamples / 2, 1);
 
     FILE *audioFile = fopen(outputWavPath.c_str(), "wb");
     if (!audioFile) {
-        std::fprintf(stderr, "Failed to create audio file: %s\n", outputWavPath.c_str());
+        LOG_ERROR(Audio, "Failed to create audio file: %s\n", outputWavPath.c_str());
         return;
     }
     
@@ -1177,25 +1366,41 @@ void RbtParser::extractAudio(const std::string& outputWavPath, size_t maxFrames)
     fwrite(audioBuffer.data(), sizeof(int16_t), audioBuffer.size(), audioFile);
     fclose(audioFile);
     
-    std::fprintf(stderr, "\nWrote %s: %zu samples (%.2f seconds @ 22050Hz)\n",
+    timer.setBytesIn(packetBytes);
+    timer.setBytesOut(audioBuffer.size() * sizeof(int16_t));
+    LOG_INFO(Audio, "\nWrote %s: %zu samples (%.2f seconds @ 22050Hz)\n",
                  outputWavPath.c_str(), audioBuffer.size(), (double)audioBuffer.size() / 22050.0);
 }
 
 // ============================================================================
 // extractFramePixels - Extrait les pixels indexés d'une frame (sans conversion RGB)
 // ============================================================================
-bool RbtParser::extractFramePixels(size_t frameIndex, std::vector<uint8_t>& outPixels, int& outWidth, int& outHeight) {
-    if (frameIndex >= _recordPositions.size()) {
-        return false;
+std::shared_ptr<const RbtDecodedFrame> RbtParser::getFrame(size_t frameIndex) {
+    if (frameIndex >= _recordPositions.size() || frameIndex >= _videoSizes.size()) {
+        return nullptr;
+    }
+    const bool cached = _frameCache.enabled();
+    if (cached) {
+        if (std::shared_ptr<const RbtDecodedFrame> hit = _frameCache.get(frameIndex)) {
+            return hit;
+        }
     }
     
-    // Position de la frame
-    size_t startPos = _recordPositions[frameIndex];
-    if (!seekSet(startPos)) return false;
+    // Lire les données brutes de la frame
+    const uint32_t videoSize = _videoSizes[frameIndex];
+    if (videoSize < 2 || !seekSet(_recordPositions[frameIndex])) return nullptr;
+    std::vector<uint8_t> rawVideoData(videoSize);
+    if (fread(rawVideoData.data(), 1, videoSize, _f) != videoSize) {
+        return nullptr;
+    }
     
-    // Lire le nombre de cels
-    uint16_t numCels = _bigEndian ? readUint16BE() : readUint16LE();
-    if (numCels == 0 || numCels > 10) return false;
+    // Nombre de cels
+    const uint16_t numCels = SciHelpers::READ_SCI11ENDIAN_UINT16(rawVideoData.data());
+    if (numCels == 0 || numCels > 10) return nullptr;
+    
+    auto frame = std::make_shared<RbtDecodedFrame>();
+    int& outWidth = frame->width;
+    int& outHeight = frame->height;
     
     // Utiliser les dimensions maximales si déjà calculées, sinon utiliser canvas Phantasmagoria
     if (_maxDimensionsComputed && _maxCelWidth > 0 && _maxCelHeight > 0) {
@@ -1216,224 +1421,129 @@ bool RbtParser::extractFramePixels(size_t frameIndex, std::vector<uint8_t>& outP
     const size_t pixelCount = (size_t)outWidth * (size_t)outHeight;
     const size_t MAX_PIXELS = 1920 * 1080;  // Full HD comme limite max raisonnable
     if (pixelCount > MAX_PIXELS) {
-        fprintf(stderr, "Warning: Resolution %dx%d seems unreasonable (>Full HD), possible corrupted data\n", 
+        LOG_WARNING(Parser, "Resolution %dx%d seems unreasonable (>Full HD), possible corrupted data\n", 
                 outWidth, outHeight);
-        return false;  // Éviter de crasher, mais signaler l'erreur
+        return nullptr;  // Éviter de crasher, mais signaler l'erreur
     }
     
     // Allouer le buffer de sortie
+    std::vector<uint8_t>& outPixels = frame->pixels;
     try {
-        outPixels.assign(outWidth * outHeight, 255);  // Fond transparent (skip=255)
+        outPixels.assign(pixelCount, 255);  // Fond transparent (skip=255)
     } catch (const std::bad_alloc& e) {
-        fprintf(stderr, "Error: Failed to allocate memory for %dx%d frame (%zu bytes)\n", 
+        LOG_ERROR(Parser, "Failed to allocate memory for %dx%d frame (%zu bytes)\n", 
                 outWidth, outHeight, pixelCount);
-        return false;
-    }
-    
-    // Lire les données brutes de la frame
-    std::vector<uint8_t> rawVideoData(_videoSizes[frameIndex]);
-    seekSet(startPos);
-    if (fread(rawVideoData.data(), 1, _videoSizes[frameIndex], _f) != _videoSizes[frameIndex]) {
-        return false;
+        return nullptr;
     }
     
     const uint8_t *p = rawVideoData.data() + 2;  // Skip numCels
+    const uint8_t *end = rawVideoData.data() + rawVideoData.size();
     
     // Traiter chaque cel et les composer dans le buffer final
+    RobotCel cel;
     for (uint16_t celIdx = 0; celIdx < numCels; ++celIdx) {
-        // Lire l'en-tête du cel (22 bytes) - MÊME ORDRE QUE createCel5
-        const uint8_t horizontalScale = p[0];
-        const uint8_t verticalScale = p[1];
-        const uint16_t celWidth = SciHelpers::READ_SCI11ENDIAN_UINT16(p + 2);
-        const uint16_t celHeight = SciHelpers::READ_SCI11ENDIAN_UINT16(p + 4);
-        // Note: offset 6-9 sont d'autres champs (priorité, etc.)
-        const uint16_t celX = SciHelpers::READ_SCI11ENDIAN_UINT16(p + 10);
-        const uint16_t celY = SciHelpers::READ_SCI11ENDIAN_UINT16(p + 12);
-        const uint16_t dataSize = SciHelpers::READ_SCI11ENDIAN_UINT16(p + 14);
-        const int16_t numDataChunks = (int16_t)SciHelpers::READ_SCI11ENDIAN_UINT16(p + 16);
-        
-        p += 22;  // kCelHeaderSize
-        
-        if (celWidth == 0 || celHeight == 0 || numDataChunks <= 0) {
-            return false;
+        // En-tête du cel (22 bytes) puis décodage partagé avec createCel5
+        if (!readCelHeader(p, (size_t)(end - p), cel)) {
+            return nullptr;
         }
-        
-        // Calculer la taille de décompression
-        const int verticalScaleFactor = verticalScale;
-        int sourceHeight = (verticalScaleFactor == 100) ? celHeight : (celHeight * verticalScaleFactor) / 100;
-        if (sourceHeight <= 0) sourceHeight = 1;
-        const size_t decompressedArea = (size_t)celWidth * (size_t)sourceHeight;
-        
-        std::vector<uint8_t> decompressed;
-        decompressed.reserve(decompressedArea);
-        
-        // Décompresser les chunks - UTILISER 10 BYTES HEADER COMME createCel5
-        for (int16_t chunk = 0; chunk < numDataChunks; ++chunk) {
-            const uint32_t compSize = SciHelpers::READ_SCI11ENDIAN_UINT32(p);
-            const uint32_t decompSize = SciHelpers::READ_SCI11ENDIAN_UINT32(p + 4);
-            const uint16_t compressionType = SciHelpers::READ_SCI11ENDIAN_UINT16(p + 8);
-            p += 10;  // Header size: 4 + 4 + 2 = 10 bytes
-            
-            if (compressionType == 2) {  // kCompressionNone
-                decompressed.insert(decompressed.end(), p, p + decompSize);
-            } else if (compressionType == 0) {  // kCompressionLZS
-                Common::MemoryReadStream mrs(p, compSize);
-                DecompressorLZS dec;
-                std::vector<uint8_t> out(decompSize);
-                int rc = dec.unpack(&mrs, out.data(), compSize, decompSize);
-                if (rc != 0) return false;
-                decompressed.insert(decompressed.end(), out.begin(), out.end());
-            } else {
-                return false;
-            }
-            
-            p += compSize;
+        if (cel.width == 0 || cel.height == 0 || cel.numDataChunks <= 0) {
+            return nullptr;
         }
+        uint32_t consumed = decodeRobotCel(p, (size_t)(end - p), cel, true);
+        if (consumed == 0) {
+            return nullptr;
+        }
+        p += consumed;
         
-        // Expansion verticale - MÊME ALGORITHME QUE createCel5
-        const size_t area = (size_t)celWidth * (size_t)celHeight;
-        std::vector<uint8_t> finalCelPixels(area, 0);
-        
-        if (verticalScaleFactor == 100) {
-            if (decompressed.size() >= area) {
-                std::copy_n(decompressed.data(), area, finalCelPixels.data());
-            }
-        } else {
-            // Algorithme d'expansion de createCel5 (de bas en haut)
-            int numerator = celHeight;
-            int denominator = sourceHeight;
-            int remainder = 0;
-            const uint8_t *srcPtr = decompressed.data();
-            uint8_t *dstPtr = finalCelPixels.data();
-            
-            for (int y = sourceHeight - 1; y >= 0; --y) {
-                remainder += numerator;
-                int linesToDraw = remainder / denominator;
-                remainder %= denominator;
-                
-                for (int l = 0; l < linesToDraw; ++l) {
-                    if ((size_t)(srcPtr - decompressed.data()) + celWidth <= decompressed.size()) {
-                        std::copy_n(srcPtr, celWidth, dstPtr);
-                    } else {
-                        std::fill_n(dstPtr, celWidth, 0);
-                    }
-                    dstPtr += celWidth;
-                }
-                srcPtr += celWidth;
-            }
+        const uint16_t celWidth = cel.width;
+        const uint16_t celHeight = cel.height;
+        const uint16_t celX = cel.celX;
+        const uint16_t celY = cel.celY;
+        const std::vector<uint8_t>& finalCelPixels = cel.pixels;
+        if (celIdx == 0) {
+            frame->firstCelWidth = celWidth;
+            frame->firstCelHeight = celHeight;
+            frame->firstCelX = celX;
+            frame->firstCelY = celY;
         }
         
         // Composer le cel dans le buffer final
+        Perf::ScopedTimer compositeTimer(Perf::Stage::Composite, finalCelPixels.size());
         // ScummVM formule: screenX = celPosition.x + _position.x
         //                  screenY = celPosition.y + _position.y (pour haute résolution)
         // En mode canvas, _canvasX/_canvasY correspondent à _position de ScummVM
-        for (int y = 0; y < (int)celHeight; ++y) {
-            const int screenY = (_useCanvasMode ? _canvasY : 0) + celY + y;
-            if (screenY < 0 || screenY >= (int)outHeight) continue;
-            
-            for (int x = 0; x < (int)celWidth; ++x) {
-                const int screenX = (_useCanvasMode ? _canvasX : 0) + celX + x;
-                if (screenX < 0 || screenX >= (int)outWidth) continue;
-                
-                uint8_t pixelIdx = finalCelPixels[y * celWidth + x];
-                // Écrire TOUS les pixels (y compris skip=255)
-                outPixels[screenY * outWidth + screenX] = pixelIdx;
-            }
-        }
+        // Seules les suites opaques sont copiées : les pixels skip (255)
+        // laissent visibles les cels précédents, le fond n'est jamais relu
+        blitSpans(finalCelPixels.data(), celWidth, cel.spans,
+                  (_useCanvasMode ? _canvasX : 0) + celX, (_useCanvasMode ? _canvasY : 0) + celY,
+                  outPixels.data(), outWidth, outHeight, &frame->spans);
+    }
+    if (numCels > 1) {
+        mergeSpans(frame->spans);
     }
     
+    Perf::count(Perf::Counter::Frames);
+    if (cached) {
+        _frameCache.put(frameIndex, frame, sizeof(RbtDecodedFrame) + frame->pixels.size() +
+                                           frame->spans.size() * sizeof(PixelSpan));
+    }
+    return frame;
+}
+
+bool RbtParser::extractFramePixels(size_t frameIndex, std::vector<uint8_t>& outPixels, int& outWidth, int& outHeight) {
+    std::shared_ptr<const RbtDecodedFrame> frame = getFrame(frameIndex);
+    if (!frame) {
+        return false;
+    }
+    outPixels.assign(frame->pixels.begin(), frame->pixels.end());
+    outWidth = frame->width;
+    outHeight = frame->height;
     return true;
 }
 
 // Surcharge retournant aussi les offsets pour le mode canvas
 bool RbtParser::extractFramePixels(size_t frameIndex, std::vector<uint8_t>& outPixels, int& outWidth, int& outHeight, int& outOffsetX, int& outOffsetY) {
-    if (frameIndex >= _recordPositions.size()) {
-        return false;
-    }
-    
     // Initialiser offsets à 0 par défaut
     outOffsetX = 0;
     outOffsetY = 0;
     
-    // Position de la frame
-    size_t startPos = _recordPositions[frameIndex];
-    if (!seekSet(startPos)) return false;
-    
-    // Lire le nombre de cels
-    uint16_t numCels = _bigEndian ? readUint16BE() : readUint16LE();
-    if (numCels == 0 || numCels > 10) return false;
-    
-    // Lire les données brutes pour obtenir les dimensions du premier cel
-    std::vector<uint8_t> rawVideoData(_videoSizes[frameIndex]);
-    seekSet(startPos);
-    if (fread(rawVideoData.data(), 1, _videoSizes[frameIndex], _f) != _videoSizes[frameIndex]) {
+    std::shared_ptr<const RbtDecodedFrame> frame = getFrame(frameIndex);
+    if (!frame) {
         return false;
     }
     
-    const uint8_t *p = rawVideoData.data() + 2;  // Skip numCels
-    
-    // Lire le premier cel pour obtenir ses dimensions et position
-    const uint16_t celWidth = SciHelpers::READ_SCI11ENDIAN_UINT16(p + 2);
-    const uint16_t celHeight = SciHelpers::READ_SCI11ENDIAN_UINT16(p + 4);
-    const uint16_t celX = SciHelpers::READ_SCI11ENDIAN_UINT16(p + 10);
-    const uint16_t celY = SciHelpers::READ_SCI11ENDIAN_UINT16(p + 12);
-    
-    // Calculer les offsets selon le mode
+    // Calculer les offsets selon le mode, à partir du premier cel
     if (_useCanvasMode) {
         // Mode canvas: combiner position Robot + offset relatif du cel (comme ScummVM)
-        outOffsetX = _canvasX + celX;
+        outOffsetX = _canvasX + frame->firstCelX;
         // NOTE: _canvasY + celY représente le BAS du sprite (pieds), comme ScummVM
-        outOffsetY = _canvasY + celY - celHeight;
-        outWidth = _canvasWidth;
-        outHeight = _canvasHeight;
-    } else if (_maxDimensionsComputed && _maxCelWidth > 0 && _maxCelHeight > 0) {
-        // Mode crop: utiliser celX/celY comme offsets relatifs
-        outOffsetX = celX;
-        outOffsetY = celY;
-        outWidth = _maxCelWidth;
-        outHeight = _maxCelHeight;
+        outOffsetY = _canvasY + frame->firstCelY - frame->firstCelHeight;
     } else {
-        outOffsetX = celX;
-        outOffsetY = celY;
-        outWidth = celWidth;
-        outHeight = celHeight;
+        // Mode crop: utiliser celX/celY comme offsets relatifs
+        outOffsetX = frame->firstCelX;
+        outOffsetY = frame->firstCelY;
     }
     
-    // Appeler la version originale pour extraire les pixels
-    return extractFramePixels(frameIndex, outPixels, outWidth, outHeight);
+    outPixels.assign(frame->pixels.begin(), frame->pixels.end());
+    outWidth = frame->width;
+    outHeight = frame->height;
+    return true;
 }
 
 bool RbtParser::extractFramePixelsWithMetadata(size_t frameIndex, std::vector<uint8_t>& outPixels, 
                                                int& outWidth, int& outHeight, 
                                                int& outCelX, int& outCelY) {
-    if (frameIndex >= _recordPositions.size()) {
-        return false;
-    }
-    
-    // Position de la frame
-    size_t startPos = _recordPositions[frameIndex];
-    if (!seekSet(startPos)) return false;
-    
-    // Lire le nombre de cels
-    uint16_t numCels = _bigEndian ? readUint16BE() : readUint16LE();
-    if (numCels == 0 || numCels > 10) return false;
-    
-    // Lire les données brutes pour obtenir les dimensions du premier cel
-    std::vector<uint8_t> rawVideoData(_videoSizes[frameIndex]);
-    seekSet(startPos);
-    if (fread(rawVideoData.data(), 1, _videoSizes[frameIndex], _f) != _videoSizes[frameIndex]) {
+    std::shared_ptr<const RbtDecodedFrame> frame = getFrame(frameIndex);
+    if (!frame) {
         return false;
     }
     
-    const uint8_t *p = rawVideoData.data() + 2;  // Skip numCels
+    // Métadonnées du premier cel
+    outCelX = frame->firstCelX;
+    outCelY = frame->firstCelY;
     
-    // Lire le premier cel pour obtenir ses métadonnées complètes
-    outWidth = SciHelpers::READ_SCI11ENDIAN_UINT16(p + 2);
-    outHeight = SciHelpers::READ_SCI11ENDIAN_UINT16(p + 4);
-    outCelX = SciHelpers::READ_SCI11ENDIAN_UINT16(p + 10);
-    outCelY = SciHelpers::READ_SCI11ENDIAN_UINT16(p + 12);
-    
-    // Extraire les pixels (version simple sans offsets)
-    return extractFramePixels(frameIndex, outPixels, outWidth, outHeight);
+    outPixels.assign(frame->pixels.begin(), frame->pixels.end());
+    outWidth = frame->width;
+    outHeight = frame->height;
+    return true;
 }
-
@@ -4,9 +4,77 @@
 #include <vector>
 #include <string>
 #include <functional>
+#include "robot_cel.h"
+#include "../utils/lru_cache.h"
+
+/**
+ * Champs d'en-tête d'un Robot, disponibles après parseHeader() sans lire
+ * aucune frame (catalogues, inventaires)
+ */
+struct RbtHeaderInfo {
+    uint16_t version = 0;
+    uint16_t numFrames = 0;
+    int16_t frameRate = 0;
+    bool hasAudio = false;
+    bool hasPalette = false;
+    bool isHiRes = false;
+    int16_t xResolution = 0;
+    int16_t yResolution = 0;
+    int16_t maxSkippablePackets = 0;
+    int16_t maxCelsPerFrame = 0;
+    int32_t maxCelArea[4] = {0, 0, 0, 0};   // Tampons des cels fixes (ScummVM _maxCelArea)
+    uint16_t paletteSize = 0;
+    uint16_t audioBlockSize = 0;
+    int32_t primerSize = 0;
+    size_t cueCount = 0;                     // Cues non nulles (temps ou valeur)
+    uint64_t videoBytes = 0;                 // Somme des tailles vidéo des frames
+    uint64_t packetBytes = 0;                // Somme des tailles d'enregistrement (vidéo + audio)
+};
+
+/**
+ * Résultat d'une vérification d'intégrité (RbtParser::verify)
+ */
+struct RbtVerifyReport {
+    struct Range {
+        size_t firstFrame = 0;
+        size_t lastFrame = 0;     // Inclus
+        std::string reason;       // Problème de la première frame de la plage
+    };
+    size_t framesChecked = 0;
+    size_t badFrames = 0;
+    size_t celsChecked = 0;
+    size_t audioPackets = 0;
+    uint64_t bytesRead = 0;
+    std::vector<Range> corruptRanges;   // Frames consécutives en erreur regroupées
+    std::vector<std::string> headerIssues;
+
+    bool ok() const { return badFrames == 0 && headerIssues.empty(); }
+};
+
+/**
+ * Frame indexée composée (extractFramePixels), telle que conservée par le cache
+ */
+struct RbtDecodedFrame {
+    std::vector<uint8_t> pixels;    // width * height indices, skip = 255
+    int width = 0;
+    int height = 0;
+    // En-tête du premier cel (offsets et métadonnées des surcharges)
+    uint16_t firstCelWidth = 0;
+    uint16_t firstCelHeight = 0;
+    uint16_t firstCelX = 0;
+    uint16_t firstCelY = 0;
+    // Suites opaques de la frame (union des cels, triées par ligne puis x) :
+    // les consommateurs peuvent ignorer tout le reste, transparent
+    std::vector<ScummVMRobot::PixelSpan> spans;
+};
 
 class RbtParser {
 public:
+    /**
+     * Cache des frames composées, clé = index de frame
+     */
+    using FrameCache = Common::LruCache<size_t, RbtDecodedFrame>;
+
     RbtParser(FILE *f);
     ~RbtParser();
 
@@ -14,6 +82,7 @@ public:
     void dumpMetadata(const char *outDir);
     size_t getNumFrames() const;
     int16_t getFrameRate() const { return _frameRate; }
+    RbtHeaderInfo getHeaderInfo() const;
     // Frame audio helpers (return 0 if none)
     int32_t getFrameAudioPosition(size_t frameIndex);
     int32_t getFrameAudioSize(size_t frameIndex);
@@ -68,9 +137,49 @@ public:
                                         int& outCelX, int& outCelY);
     
     /**
-     * Récupère la palette RGB courante
+     * Frame composée partagée, servie par le cache s'il est actif (sans copie)
+     * @return nullptr si la frame est illisible ou corrompue
+     */
+    std::shared_ptr<const RbtDecodedFrame> getFrame(size_t frameIndex);
+
+    /**
+     * Active le cache LRU des frames composées : un nouvel accès à une frame
+     * (surcharges d'extractFramePixels, passes répétées, navigation) ne coûte
+     * plus qu'une copie. Vidé par setCanvasMode/disableCanvasMode et
+     * computeMaxDimensions, qui changent la composition.
+     * @param bytes Budget en octets (0 = cache désactivé, par défaut)
+     */
+    void setFrameCacheBudget(size_t bytes) { _frameCache.setBudget(bytes); }
+
+    /** Compteurs du cache de frames (succès, échecs, évictions, occupation) */
+    FrameCache::Stats frameCacheStats() const { return _frameCache.stats(); }
+
+    /**
+     * Décode tous les cels d'une frame (chemin createCel5, sans écriture)
+     * @param outCels Cels décodés avec leur position celX/celY
+     * @return false si la frame est illisible ou corrompue
+     */
+    bool extractFrameCels(size_t frameIndex, std::vector<ScummVMRobot::RobotCel>& outCels);
+    
+    /**
+     * Récupère la palette RGB courante (768 octets, vide si absente)
+     * La HunkPalette est lue et décodée au premier appel : parseHeader()
+     * n'en retient que la position.
+     */
+    const std::vector<uint8_t>& getPalette();
+    
+    /**
+     * Vérifie chaque enregistrement sans rien écrire : position et taille
+     * dans le fichier, nombre de screen items, en-têtes de cels et de chunks
+     * (tailles contre videoSize), décompression LZS, en-tête audio.
+     *
+     * Le fichier est lu séquentiellement par blocs de plusieurs Mo (les
+     * enregistrements se suivent), à appeler après parseHeader().
+     *
+     * @return false si le fichier est illisible ; les frames corrompues sont
+     *         signalées dans report sans interrompre la vérification
      */
-    const std::vector<uint8_t>& getPalette() const { return _paletteData; }
+    bool verify(RbtVerifyReport& report);
     
     /**
      * Extrait l'audio complet au format WAV (22050 Hz mono)
@@ -104,12 +213,16 @@ private:
     int16_t _isHiRes = 0;
     int16_t _maxSkippablePackets = 0;
     int16_t _maxCelsPerFrame = 0;
+    int16_t _xResolution = 0;
+    int16_t _yResolution = 0;
+    int32_t _maxCelArea[4] = {0, 0, 0, 0};
     int32_t _totalPrimerSize = 0;
     int16_t _primerCompressionType = 0;
     int32_t _evenPrimerSize = 0;
     int32_t _oddPrimerSize = 0;
-    long _primerPosition = 0;
-    // raw primer buffers (if present and read during header parse)
+    long _primerPosition = 0;   // even primer data; -1 = zero-compressed, 0 = none
+    // raw primer buffers, read on first audio extraction (loadPrimer)
+    bool _primerLoaded = false;
     std::vector<uint8_t> _primerEvenRaw;
     std::vector<uint8_t> _primerOddRaw;
     std::vector<int32_t> _cueTimes;
@@ -117,6 +230,9 @@ private:
     std::vector<uint32_t> _videoSizes;
     std::vector<uint32_t> _recordPositions;
     std::vector<uint32_t> _packetSizes;
+    bool _hasPalette = false;
+    long _paletteOffset = 0;    // HunkPalette, decoded on first getPalette()
+    bool _paletteLoaded = false;
     std::vector<uint8_t> _paletteData;
     // Offset within the containing file/archive (ScummVM uses this when aligning).
     // For a raw, standalone `.rbt` file the resource is stored at the start
@@ -135,7 +251,11 @@ private:
     uint16_t _maxCelHeight = 0;
     bool _maxDimensionsComputed = false;
 
+    // Frames composées (inactif tant que setFrameCacheBudget() n'est pas appelé)
+    FrameCache _frameCache;
+
     // helpers
+    void loadPrimer();
     uint16_t readUint16LE();
     uint16_t readUint16BE();
     int32_t readSint32(bool asBE=false);
@@ -146,6 +266,6 @@ private:
         return ftell(_f);
     }
     // ScummVM-like cel creation helpers (version 5/6)
-    uint32_t createCel5(const uint8_t *rawVideoData, const int16_t screenItemIndex, const char *outDir, size_t frameIndex);
-    void createCels5(const uint8_t *rawVideoData, const int16_t numCels, const char *outDir, size_t frameIndex);
+    uint32_t createCel5(const uint8_t *rawVideoData, const int16_t screenItemIndex, const char *outDir, size_t frameIndex, size_t available);
+    void createCels5(const uint8_t *rawVideoData, const int16_t numCels, const char *outDir, size_t frameIndex, size_t available);
 };
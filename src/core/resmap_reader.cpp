@@ -0,0 +1,175 @@
+/**
+ * @file resmap_reader.cpp
+ * @brief Détection de la disposition RESMAP et décodage des entrées
+ */
+
+#include "resmap_reader.h"
+#include <algorithm>
+#include <cctype>
+
+namespace SCI {
+
+// Index de type de la table d'indirection (0x00-0x15) → ResourceType (0x80-0x95)
+static const uint8_t kTypeConversion[0x16] = {
+    0x88, 0x87, 0x80, 0x83, 0x81, 0x82, 0x86, 0x84,  // View, Pic, Script, Text, Sound, Memory, Vocab, Font
+    0x85, 0x89, 0x8A, 0x8B, 0x8C, 0x8D, 0x8E, 0x8F,  // Cursor, Patch, Bitmap, Palette, CdAudio, Audio, Sync, Message
+    0x90, 0x91, 0x92, 0x93, 0x94, 0x95               // Chunk, Heap, Audio36, Sync36, RobotData, AudioMap
+};
+
+static const uint8_t kHeaderTerminator = 0x1F;
+
+static inline uint32_t readLE16(const uint8_t* p) {
+    return p[0] | (p[1] << 8);
+}
+
+static inline uint32_t readLE24(const uint8_t* p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16);
+}
+
+static inline uint32_t readLE32(const uint8_t* p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+size_t resMapEntrySize(ResMapLayout layout) {
+    switch (layout) {
+        case RESMAP_SCI11: return 5;
+        case RESMAP_SCI1_LATE: return 6;
+        case RESMAP_SCI32_FLAT: return 9;
+        default: return 0;
+    }
+}
+
+const char* resMapLayoutName(ResMapLayout layout) {
+    switch (layout) {
+        case RESMAP_SCI11: return "SCI1.1 (5 bytes/entrée)";
+        case RESMAP_SCI1_LATE: return "SCI1 Late (6 bytes/entrée)";
+        case RESMAP_SCI32_FLAT: return "SCI32 (9 bytes/entrée)";
+        default: return "inconnu";
+    }
+}
+
+// Liste plate de 9 octets : taille multiple de 9, types SCI valides et croissants
+static bool isFlat9(const uint8_t* data, size_t size) {
+    if (size == 0 || size % 9 != 0) {
+        return false;
+    }
+    uint8_t previous = 0x80;
+    for (size_t pos = 0; pos < size; pos += 9) {
+        const uint8_t type = data[pos];
+        if (type < 0x80 || type > 0x95 || type < previous) {
+            return false;
+        }
+        previous = type;
+    }
+    return true;
+}
+
+namespace {
+struct Section {
+    uint8_t type;       // ResourceType
+    uint32_t offset;
+    uint32_t size;
+};
+}
+
+// Décodage à pas fixe d'une section : pas de branchement par entrée
+template <size_t Stride>
+static void decodeSection(const uint8_t* p, size_t count, uint8_t type, ResMapRecord* out) {
+    for (size_t i = 0; i < count; i++, p += Stride) {
+        out[i].type = type;
+        out[i].number = readLE16(p);
+        if (Stride == 5) {
+            out[i].offset = readLE24(p + 2);
+        } else {
+            // Offset complet sur 32 bits : le volume est fourni par l'appelant
+            // (RESSCI.00X associé au RESMAP.00X), aucun bit n'est réservé
+            out[i].offset = readLE32(p + 2);
+        }
+    }
+}
+
+ResMapLayout decodeResMap(const uint8_t* data, size_t size, std::vector<ResMapRecord>& out) {
+    if (!data || size < 6) {
+        return RESMAP_UNKNOWN;
+    }
+
+    if (isFlat9(data, size)) {
+        const size_t count = size / 9;
+        const size_t base = out.size();
+        out.resize(base + count);
+        ResMapRecord* records = out.data() + base;
+        const uint8_t* p = data;
+        for (size_t i = 0; i < count; i++, p += 9) {
+            records[i].type = p[0];
+            records[i].number = readLE32(p + 1);
+            records[i].offset = readLE32(p + 5);
+        }
+        return RESMAP_SCI32_FLAT;
+    }
+
+    // Table d'indirection : (type, offset) jusqu'au terminateur, qui porte la fin de la dernière section
+    std::vector<Section> sections;
+    size_t pos = 0;
+    bool terminated = false;
+    while (pos + 3 <= size) {
+        const uint8_t typeIndex = data[pos] & 0x1F;
+        const uint32_t offset = readLE16(data + pos + 1);
+        pos += 3;
+        if (offset > size || (!sections.empty() && offset < sections.back().offset)) {
+            return RESMAP_UNKNOWN;
+        }
+        if (!sections.empty()) {
+            sections.back().size = offset - sections.back().offset;
+        }
+        if (typeIndex == kHeaderTerminator) {
+            terminated = true;
+            break;
+        }
+        sections.push_back({typeIndex < sizeof(kTypeConversion) ? kTypeConversion[typeIndex] : (uint8_t)0xFF,
+                            offset, 0});
+    }
+    if (!terminated || sections.empty()) {
+        return RESMAP_UNKNOWN;
+    }
+
+    // Taille d'entrée (logique ScummVM) : une section divisible par 6 et pas par 5
+    // désigne SCI1 late, l'inverse SCI1.1 ; la première section décisive l'emporte
+    ResMapLayout layout = RESMAP_UNKNOWN;
+    for (const Section& section : sections) {
+        const bool by5 = section.size % 5 == 0;
+        const bool by6 = section.size % 6 == 0;
+        if (section.size == 0 || by5 == by6) {
+            continue;
+        }
+        layout = by6 ? RESMAP_SCI1_LATE : RESMAP_SCI11;
+        break;
+    }
+    if (layout == RESMAP_UNKNOWN) {
+        layout = RESMAP_SCI1_LATE;
+    }
+
+    const size_t stride = resMapEntrySize(layout);
+    for (const Section& section : sections) {
+        if (section.type == 0xFF) {
+            continue;  // Index de type inutilisé
+        }
+        const size_t count = section.size / stride;
+        const size_t base = out.size();
+        out.resize(base + count);
+        if (layout == RESMAP_SCI11) {
+            decodeSection<5>(data + section.offset, count, section.type, out.data() + base);
+        } else {
+            decodeSection<6>(data + section.offset, count, section.type, out.data() + base);
+        }
+    }
+    return layout;
+}
+
+bool isVolumeFile(const std::string& name) {
+    std::string upper = name;
+    std::transform(upper.begin(), upper.end(), upper.begin(),
+                   [](unsigned char c) { return (char)std::toupper(c); });
+    return upper.rfind("RESMAP.", 0) == 0 || upper.rfind("RESSCI.", 0) == 0;
+}
+
+} // namespace SCI
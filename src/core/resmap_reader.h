@@ -0,0 +1,66 @@
+/**
+ * @file resmap_reader.h
+ * @brief Décodage unique des index RESMAP.00X (toutes dispositions d'entrées)
+ *
+ * Dispositions reconnues :
+ * - Table d'indirection (SCI1 late / SCI1.1 / SCI2.1, style ScummVM) :
+ *   en-tête de triplets (0x80 | type[1B], offset[2B LE]) terminé par 0xFF,
+ *   puis une section par type d'entrées de taille fixe :
+ *     5 octets : number[2B LE] + offset[3B LE]          (SCI1.1 / SCI2)
+ *     6 octets : number[2B LE] + offset[4B LE]          (SCI1 late)
+ *   La taille d'entrée se déduit de la divisibilité des sections par 5 ou 6.
+ * - Liste plate de 9 octets (SCI32) : type[1B] + number[4B LE] + offset[4B LE],
+ *   sans en-tête, triée par type puis numéro.
+ *
+ * Le décodeur lit directement le tampon fourni (fichier projeté) : détection
+ * sur l'en-tête, puis une boucle à pas fixe par section, sans branchement
+ * par entrée.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace SCI {
+
+enum ResMapLayout : uint8_t {
+    RESMAP_UNKNOWN = 0,
+    RESMAP_SCI1_LATE,   // Table d'indirection, entrées de 6 octets
+    RESMAP_SCI11,       // Table d'indirection, entrées de 5 octets
+    RESMAP_SCI32_FLAT   // Liste plate, entrées de 9 octets
+};
+
+/**
+ * @brief Entrée décodée
+ */
+struct ResMapRecord {
+    uint8_t type;       // Type SCI (0x80-0x95, voir ResourceType)
+    uint32_t number;
+    uint32_t offset;    // Offset de l'en-tête dans le RESSCI.00X
+};
+
+/** @brief Taille d'une entrée (5, 6 ou 9 octets ; 0 si inconnue) */
+size_t resMapEntrySize(ResMapLayout layout);
+
+/** @brief Nom lisible d'une disposition */
+const char* resMapLayoutName(ResMapLayout layout);
+
+/**
+ * @brief Décode un RESMAP complet
+ * @param out Entrées ajoutées dans l'ordre du fichier (par type, puis numéro)
+ * @return Disposition détectée, RESMAP_UNKNOWN si le fichier n'est pas reconnu
+ */
+ResMapLayout decodeResMap(const uint8_t* data, size_t size, std::vector<ResMapRecord>& out);
+
+/**
+ * @brief Nom d'index ou de volume de ressources (RESMAP.* / RESSCI.*, casse ignorée)
+ *
+ * Sert à lister les volumes d'un dossier pour invalider catalogue et cache de
+ * coordonnées quand un volume apparaît ou disparaît.
+ */
+bool isVolumeFile(const std::string& name);
+
+} // namespace SCI
@@ -0,0 +1,198 @@
+/**
+ * @file resource_catalog.cpp
+ * @brief Lecture (projection) et écriture du catalogue binaire des ressources
+ */
+
+#include "resource_catalog.h"
+#include "resmap_reader.h"
+#include "../utils/atomic_file.h"
+#include "../utils/file_hash.h"
+#include "../utils/log.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <set>
+
+namespace fs = std::filesystem;
+
+namespace SCI {
+
+static const char kCatalogMagic[8] = {'S', 'C', 'I', 'C', 'A', 'T', 'L', 'G'};
+static const uint32_t kCatalogVersion = 2;
+
+struct CatalogHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t sourceCount;
+    uint32_t entryCount;
+    uint32_t stringsSize;
+    uint32_t entrySize;         // sizeof(CatalogEntry), contrôle de cohérence
+    uint32_t reserved;
+    uint64_t listingHash;       // RESMAP.* / RESSCI.* présents dans les dossiers des sources
+};
+static_assert(sizeof(CatalogHeader) == 40, "CatalogHeader doit rester projetable");
+
+struct CatalogSourceRecord {
+    uint64_t size;
+    int64_t mtime;
+    uint32_t pathOffset;        // Dans la zone des chaînes
+    uint32_t pathLength;
+    uint8_t isMap;
+    uint8_t volume;
+    uint8_t reserved[6];
+};
+static_assert(sizeof(CatalogSourceRecord) == 32, "CatalogSourceRecord doit rester projetable");
+
+// Empreinte de la liste triée des RESMAP / RESSCI des dossiers des sources :
+// un volume ajouté ou retiré à côté des sources périme le catalogue
+static uint64_t listingHash(const std::vector<CatalogSource>& sources) {
+    std::set<std::string> directories;
+    for (const CatalogSource& source : sources) {
+        directories.insert(fs::path(source.path).parent_path().string());
+    }
+
+    std::vector<std::string> names;
+    for (const std::string& directory : directories) {
+        std::error_code ec;
+        for (const auto& entry : fs::directory_iterator(directory.empty() ? "." : directory, ec)) {
+            std::string name = entry.path().filename().string();
+            if (isVolumeFile(name)) {
+                names.push_back(directory + "/" + name);
+            }
+        }
+    }
+    std::sort(names.begin(), names.end());
+
+    uint64_t hash = FileHash::kSeed;
+    for (const std::string& name : names) {
+        hash = FileHash::hashBytes(name.data(), name.size() + 1, hash);  // '\0' séparateur
+    }
+    return hash;
+}
+
+bool ResourceCatalog::fingerprint(const std::string& path, uint64_t& size, int64_t& mtime) {
+    std::error_code ec;
+    size = fs::file_size(path, ec);
+    if (ec) {
+        return false;
+    }
+    auto t = fs::last_write_time(path, ec);
+    if (ec) {
+        return false;
+    }
+    mtime = (int64_t)t.time_since_epoch().count();
+    return true;
+}
+
+void ResourceCatalog::close() {
+    m_file.close();
+    m_entries = nullptr;
+    m_entryCount = 0;
+    m_sources.clear();
+}
+
+bool ResourceCatalog::open(const std::string& path) {
+    close();
+
+    std::error_code ec;
+    if (!fs::exists(path, ec) || !m_file.open(path)) {
+        return false;
+    }
+
+    const uint8_t* data = m_file.data();
+    const size_t size = m_file.size();
+    CatalogHeader header;
+    if (size < sizeof(header)) {
+        close();
+        return false;
+    }
+    std::memcpy(&header, data, sizeof(header));
+    if (std::memcmp(header.magic, kCatalogMagic, sizeof(kCatalogMagic)) != 0 ||
+        header.version != kCatalogVersion || header.entrySize != sizeof(CatalogEntry)) {
+        LOG_WARNING(Ressci, "Ignoring resource catalog %s (other version)\n", path.c_str());
+        close();
+        return false;
+    }
+
+    const size_t sourcesOffset = sizeof(CatalogHeader);
+    const size_t entriesOffset = sourcesOffset + (size_t)header.sourceCount * sizeof(CatalogSourceRecord);
+    const size_t stringsOffset = entriesOffset + (size_t)header.entryCount * sizeof(CatalogEntry);
+    if (header.sourceCount == 0 || stringsOffset + header.stringsSize != size) {
+        LOG_WARNING(Ressci, "Ignoring truncated resource catalog %s\n", path.c_str());
+        close();
+        return false;
+    }
+
+    // Sources : toutes présentes, mêmes taille et date
+    for (uint32_t i = 0; i < header.sourceCount; i++) {
+        CatalogSourceRecord record;
+        std::memcpy(&record, data + sourcesOffset + i * sizeof(record), sizeof(record));
+        if ((size_t)record.pathOffset + record.pathLength > header.stringsSize) {
+            close();
+            return false;
+        }
+
+        CatalogSource source;
+        source.path.assign(reinterpret_cast<const char*>(data + stringsOffset + record.pathOffset), record.pathLength);
+        source.isMap = record.isMap != 0;
+        source.volume = record.volume;
+        source.size = record.size;
+        source.mtime = record.mtime;
+
+        uint64_t currentSize = 0;
+        int64_t currentMtime = 0;
+        if (!fingerprint(source.path, currentSize, currentMtime) ||
+            currentSize != source.size || currentMtime != source.mtime) {
+            close();
+            return false;
+        }
+        m_sources.push_back(std::move(source));
+    }
+    if (listingHash(m_sources) != header.listingHash) {
+        close();
+        return false;
+    }
+
+    m_entries = reinterpret_cast<const CatalogEntry*>(data + entriesOffset);
+    m_entryCount = header.entryCount;
+    return true;
+}
+
+bool ResourceCatalog::write(const std::string& path,
+                            const std::vector<CatalogSource>& sources,
+                            const std::vector<CatalogEntry>& entries) {
+    std::string strings;
+    std::vector<CatalogSourceRecord> records;
+    for (const CatalogSource& source : sources) {
+        CatalogSourceRecord record = {};
+        record.size = source.size;
+        record.mtime = source.mtime;
+        record.pathOffset = (uint32_t)strings.size();
+        record.pathLength = (uint32_t)source.path.size();
+        record.isMap = source.isMap ? 1 : 0;
+        record.volume = source.volume;
+        records.push_back(record);
+        strings += source.path;
+    }
+
+    CatalogHeader header = {};
+    std::memcpy(header.magic, kCatalogMagic, sizeof(kCatalogMagic));
+    header.version = kCatalogVersion;
+    header.sourceCount = (uint32_t)records.size();
+    header.entryCount = (uint32_t)entries.size();
+    header.stringsSize = (uint32_t)strings.size();
+    header.entrySize = sizeof(CatalogEntry);
+    header.listingHash = listingHash(sources);
+
+    std::string bytes;
+    bytes.reserve(sizeof(header) + records.size() * sizeof(CatalogSourceRecord) +
+                  entries.size() * sizeof(CatalogEntry) + strings.size());
+    bytes.append(reinterpret_cast<const char*>(&header), sizeof(header));
+    bytes.append(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(CatalogSourceRecord));
+    bytes.append(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(CatalogEntry));
+    bytes.append(strings.data(), strings.size());
+    return Common::writeFileAtomic(path, bytes);
+}
+
+} // namespace SCI
@@ -0,0 +1,94 @@
+/**
+ * @file resource_catalog.h
+ * @brief Catalogue binaire des ressources RESMAP/RESSCI résolues
+ *
+ * L'ouverture d'une installation relit chaque RESMAP (table d'indirection,
+ * détection 5/6 octets) puis, à chaque extraction, redevine le format de
+ * l'en-tête RESSCI (SCI1.1 ou SCI2.1). Le catalogue conserve le résultat :
+ * l'index trié (type, numéro) → (volume, offset) et, pour chaque ressource,
+ * le format d'en-tête, les tailles et la méthode de compression.
+ *
+ * Disposition (little-endian, projetable tel quel) :
+ *   CatalogHeader
+ *   CatalogSourceRecord[sourceCount]  fichiers RESMAP/RESSCI d'origine
+ *   CatalogEntry[entryCount]          triées par (type, numéro)
+ *   chaînes (chemins des sources)
+ *
+ * Le catalogue est périmé dès qu'une source change de taille ou de date, ou
+ * qu'un RESMAP / RESSCI est ajouté ou retiré dans le dossier des sources.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "../utils/mapped_file.h"
+
+namespace SCI {
+
+/**
+ * @brief Ressource résolue (24 octets)
+ *
+ * headerSize = 0 : en-tête illisible lors de la construction (offset hors
+ * volume), la ressource reste indexée mais n'est pas extractible.
+ */
+struct CatalogEntry {
+    uint32_t number;
+    uint32_t offset;            // Position de l'en-tête dans le volume
+    uint32_t compressedSize;
+    uint32_t decompressedSize;
+    uint16_t method;
+    uint8_t type;
+    uint8_t volume;
+    uint8_t headerSize;         // 13 (SCI2.1), 10 ou 6 (SCI1.1)
+    uint8_t reserved[3];
+};
+static_assert(sizeof(CatalogEntry) == 24, "CatalogEntry doit rester projetable");
+
+/**
+ * @brief Fichier source d'un catalogue
+ */
+struct CatalogSource {
+    std::string path;
+    bool isMap = false;         // RESMAP (true) ou RESSCI (false)
+    uint8_t volume = 0;
+    uint64_t size = 0;
+    int64_t mtime = 0;
+};
+
+class ResourceCatalog {
+public:
+    /**
+     * @brief Projette un catalogue et vérifie que ses sources et la liste des
+     *        volumes de leur dossier n'ont pas changé
+     * @return false si absent, d'une autre version, corrompu ou périmé
+     */
+    bool open(const std::string& path);
+    void close();
+
+    const CatalogEntry* entries() const { return m_entries; }
+    size_t entryCount() const { return m_entryCount; }
+    const std::vector<CatalogSource>& sources() const { return m_sources; }
+
+    /**
+     * @brief Écrit un catalogue (fichier temporaire + rename)
+     * @param sources Sources avec taille et date renseignées (voir fingerprint())
+     * @param entries Entrées triées par (type, numéro), sans doublon
+     */
+    static bool write(const std::string& path,
+                      const std::vector<CatalogSource>& sources,
+                      const std::vector<CatalogEntry>& entries);
+
+    /** @brief Taille et date de modification d'un fichier */
+    static bool fingerprint(const std::string& path, uint64_t& size, int64_t& mtime);
+
+private:
+    Common::MappedFile m_file;
+    const CatalogEntry* m_entries = nullptr;
+    size_t m_entryCount = 0;
+    std::vector<CatalogSource> m_sources;
+};
+
+} // namespace SCI
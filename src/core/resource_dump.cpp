@@ -0,0 +1,162 @@
+/**
+ * @file resource_dump.cpp
+ * @brief Extraction parallèle de toutes les ressources indexées et manifeste JSON
+ */
+
+#include "resource_dump.h"
+#include "../utils/atomic_file.h"
+#include "../utils/file_hash.h"
+#include "../utils/log.h"
+#include "../utils/parallel_for.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <filesystem>
+#include <nlohmann/json.hpp>
+
+namespace fs = std::filesystem;
+
+namespace SCI {
+
+const char* resourceFileExtension(ResourceType type) {
+    switch (type) {
+        case RT_VIEW: return "v56";
+        case RT_PIC: return "p56";
+        case RT_SCRIPT: return "scr";
+        case RT_TEXT: return "tex";
+        case RT_SOUND: return "snd";
+        case RT_MEMORY: return "mem";
+        case RT_VOCAB: return "voc";
+        case RT_FONT: return "fon";
+        case RT_CURSOR: return "cur";
+        case RT_PATCH: return "pat";
+        case RT_BITMAP: return "bit";
+        case RT_PALETTE: return "pal";
+        case RT_CDAUDIO: return "cda";
+        case RT_AUDIO: return "aud";
+        case RT_SYNC: return "syn";
+        case RT_MESSAGE: return "msg";
+        case RT_CHUNK: return "chk";
+        case RT_HEAP: return "hep";
+        case RT_AUDIO36: return "a36";
+        case RT_SYNC36: return "s36";
+        case RT_ROBOTDATA: return "rbd";
+        case RT_AUDIOMAP: return "amp";
+        default: return "bin";
+    }
+}
+
+// Dossier d'un type : nom en minuscules, ou code hexadécimal pour un type inconnu
+static std::string typeDirectory(ResourceType type) {
+    std::string name = RESSCIParser::getResourceTypeName(type);
+    if (name == "Unknown") {
+        char hex[8];
+        std::snprintf(hex, sizeof(hex), "0x%02X", (unsigned)type);
+        return hex;
+    }
+    std::transform(name.begin(), name.end(), name.begin(),
+                   [](unsigned char c) { return (char)std::tolower(c); });
+    return name;
+}
+
+static bool writeFile(const std::string& path, const uint8_t* data, size_t size) {
+    std::FILE* f = std::fopen(path.c_str(), "wb");
+    if (!f) {
+        return false;
+    }
+    // Ressource entière en mémoire : une seule écriture, sans tampon stdio intermédiaire
+    std::setvbuf(f, nullptr, _IONBF, 0);
+    const bool ok = (size == 0 || std::fwrite(data, 1, size, f) == size);
+    return std::fclose(f) == 0 && ok;
+}
+
+std::vector<DumpedResource> dumpResources(RESSCIParser& parser, const std::string& outputDir,
+                                          const DumpOptions& options) {
+    const ResourceIndex& index = parser.getResourceIndex();
+
+    // Ressources retenues et dossiers créés avant de lancer les workers
+    std::vector<DumpedResource> resources;
+    resources.reserve(index.size());
+    std::set<ResourceType> types;
+    for (ResourceIndex::Entry entry : index.all()) {
+        if (!options.types.empty() && !options.types.count(entry.type)) {
+            continue;
+        }
+        DumpedResource resource;
+        resource.type = entry.type;
+        resource.number = entry.number;
+        resource.volume = entry.volume;
+        resource.file = typeDirectory(entry.type) + "/" + std::to_string(entry.number) + "." +
+                        resourceFileExtension(entry.type);
+        resources.push_back(std::move(resource));
+        types.insert(entry.type);
+    }
+
+    std::error_code ec;
+    fs::create_directories(outputDir, ec);
+    for (ResourceType type : types) {
+        fs::create_directories(fs::path(outputDir) / typeDirectory(type), ec);
+        if (ec) {
+            LOG_ERROR(Ressci, "Cannot create %s/%s: %s\n",
+                      outputDir.c_str(), typeDirectory(type).c_str(), ec.message().c_str());
+            return {};
+        }
+    }
+
+    const unsigned jobs = options.jobs > 0 ? options.jobs : Parallel::defaultJobCount();
+    Parallel::parallelFor(resources.size(), jobs, [&](size_t i) {
+        DumpedResource& resource = resources[i];
+        ResourceInfo info;
+        ResourceView view;
+        if (!parser.extractResourceView(resource.type, resource.number, info, view)) {
+            resource.error = "extraction failed";
+            return;
+        }
+        resource.method = info.method;
+        resource.compressedSize = info.compressedSize;
+        resource.size = view.size();
+        resource.hash = FileHash::hashBytes(view.data(), view.size());
+        if (!writeFile(outputDir + "/" + resource.file, view.data(), view.size())) {
+            resource.error = "write failed";
+        }
+    });
+
+    return resources;
+}
+
+bool writeDumpManifest(const std::string& path, const std::vector<DumpedResource>& resources) {
+    nlohmann::json list = nlohmann::json::array();
+    uint64_t totalSize = 0;
+    size_t written = 0;
+    for (const DumpedResource& resource : resources) {
+        nlohmann::json entry = {
+            {"type", RESSCIParser::getResourceTypeName(resource.type)},
+            {"number", resource.number},
+            {"volume", resource.volume},
+            {"file", resource.file},
+        };
+        if (!resource.error.empty()) {
+            entry["error"] = resource.error;
+        } else {
+            entry["method"] = RESSCIParser::getCompressionMethodName(resource.method);
+            entry["compressedSize"] = resource.compressedSize;
+            entry["size"] = resource.size;
+            entry["hash"] = FileHash::toHex(resource.hash);
+            totalSize += resource.size;
+            written++;
+        }
+        list.push_back(std::move(entry));
+    }
+
+    nlohmann::json root = {
+        {"version", 1},
+        {"resources", written},
+        {"failed", resources.size() - written},
+        {"totalSize", totalSize},
+        {"entries", std::move(list)},
+    };
+
+    return Common::writeFileAtomic(path, root.dump(2) + "\n");
+}
+
+} // namespace SCI
@@ -0,0 +1,61 @@
+/**
+ * @file resource_dump.h
+ * @brief Extraction en masse des ressources RESSCI vers out/<type>/<numéro>.<ext>
+ *
+ * Parcourt tout l'index d'un RESSCIParser déjà chargé : chaque ressource est
+ * décompressée sur un pool de threads directement depuis le volume projeté
+ * (aucune copie pour CM_NONE) puis écrite en un seul appel. Les dossiers par
+ * type sont créés avant le lancement des workers.
+ *
+ * Le manifeste (manifest.json) liste, dans l'ordre de l'index, la taille
+ * compressée et décompressée, la méthode et le hash FNV-1a de chaque fichier.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <set>
+#include <string>
+#include <vector>
+#include "ressci_parser.h"
+
+namespace SCI {
+
+/**
+ * @brief Résultat de l'extraction d'une ressource
+ */
+struct DumpedResource {
+    ResourceType type;
+    uint32_t number;
+    uint8_t volume;
+    CompressionMethod method = CM_NONE;
+    uint32_t compressedSize = 0;
+    uint64_t size = 0;          // Octets écrits
+    uint64_t hash = 0;          // FNV-1a 64 bits du contenu écrit
+    std::string file;           // Chemin relatif au dossier de sortie
+    std::string error;          // Vide si la ressource a été écrite
+};
+
+struct DumpOptions {
+    unsigned jobs = 0;                 // 0 = un thread par cœur
+    std::set<ResourceType> types;      // Vide = tous les types
+};
+
+/**
+ * @brief Extension de fichier d'un type (conventions des patchs SCI : scr, hep, v56...)
+ */
+const char* resourceFileExtension(ResourceType type);
+
+/**
+ * @brief Écrit chaque ressource indexée dans outputDir/<type>/<numéro>.<ext>
+ * @return Une entrée par ressource retenue, dans l'ordre de l'index
+ */
+std::vector<DumpedResource> dumpResources(RESSCIParser& parser, const std::string& outputDir,
+                                          const DumpOptions& options = DumpOptions());
+
+/**
+ * @brief Écrit le manifeste JSON d'une extraction (fichier temporaire + rename)
+ */
+bool writeDumpManifest(const std::string& path, const std::vector<DumpedResource>& resources);
+
+} // namespace SCI
@@ -2,15 +2,8 @@
  * @file ressci_parser.cpp
  * @brief Implémentation du parser RESSCI/RESMAP avec détection automatique
  * 
- * Ce parser supporte automatiquement :
- * - Format 6 octets : type[1B] + number[2B LE] + offset[3B LE]
- *   Utilisé par variantes, démos et versions modifiées de Phantasmagoria
- * 
- * - Format 9 octets : type[1B] + number[4B LE] + offset[4B LE]
- *   Format SCI32 standard utilisé par les CD originaux de Phantasmagoria
- * 
- * La détection est effectuée automatiquement en analysant les 100 premières
- * entrées avec des critères de validation adaptés à chaque format.
+ * Le décodage des RESMAP (table d'indirection 5/6 octets ou liste plate
+ * SCI32 de 9 octets) est partagé avec ressci_extractor : voir resmap_reader.h.
  * 
  * @see docs/RESMAP_FORMAT_DETECTION.md
  * @author Extractor Sierra Project
@@ -18,7 +11,13 @@
  */
 
 #include "ressci_parser.h"
+#include "resmap_reader.h"
+#include "sci_bytecode.h"
+#include "../formats/huffman.h"
 #include "../formats/lzs.h"
+#include "../utils/log.h"
+#include "../utils/parallel_for.h"
+#include <filesystem>
 #include <fstream>
 #include <iostream>
 #include <cstring>
@@ -43,6 +42,7 @@ static const char* s_compressionMethodNames[] = {
 
 // Suivi des méthodes de compression non supportées
 std::set<uint8_t> RESSCIParser::s_unsupportedMethodsLogged;
+std::mutex RESSCIParser::s_unsupportedMethodsMutex;
 
 // Helpers pour lecture little-endian
 static inline uint16_t readLE16(const uint8_t* data) {
@@ -53,10 +53,116 @@ static inline uint32_t readLE32(const uint8_t* data) {
     return data[0] | (data[1] << 8) | (data[2] << 16) | (data[3] << 24);
 }
 
-static inline int16_t readSLE16(const uint8_t* data) {
-    return static_cast<int16_t>(readLE16(data));
+// ============================================================================
+// ResourceIndex
+// ============================================================================
+
+static inline uint64_t resourceKey(uint8_t type, uint32_t number) {
+    return (static_cast<uint64_t>(type) << 32) | number;
+}
+
+// Mélange de Fibonacci : répartit des numéros consécutifs sur toute la table
+static inline size_t hashSlot(uint64_t key, uint32_t mask) {
+    return static_cast<size_t>((key * 0x9E3779B97F4A7C15ULL) >> 32) & mask;
+}
+
+void ResourceIndex::insert(ResourceType type, uint32_t number, uint8_t volume, uint32_t offset) {
+    m_types.push_back(type);
+    m_numbers.push_back(number);
+    m_volumes.push_back(volume);
+    m_offsets.push_back(offset);
+}
+
+void ResourceIndex::finalize() {
+    const size_t count = m_types.size();
+    
+    // Tri stable par clé : à clé égale, l'ordre d'insertion est conservé
+    std::vector<uint32_t> order(count);
+    for (size_t i = 0; i < count; i++) order[i] = static_cast<uint32_t>(i);
+    std::stable_sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b) {
+        return resourceKey(m_types[a], m_numbers[a]) < resourceKey(m_types[b], m_numbers[b]);
+    });
+    
+    // Réordonner les colonnes en ne gardant que la dernière insertion de chaque clé
+    std::vector<uint8_t> types, volumes;
+    std::vector<uint32_t> numbers, offsets;
+    types.reserve(count);
+    numbers.reserve(count);
+    volumes.reserve(count);
+    offsets.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        uint32_t src = order[i];
+        if (i + 1 < count) {
+            uint32_t next = order[i + 1];
+            if (m_types[next] == m_types[src] && m_numbers[next] == m_numbers[src]) continue;
+        }
+        types.push_back(m_types[src]);
+        numbers.push_back(m_numbers[src]);
+        volumes.push_back(m_volumes[src]);
+        offsets.push_back(m_offsets[src]);
+    }
+    m_types = std::move(types);
+    m_numbers = std::move(numbers);
+    m_volumes = std::move(volumes);
+    m_offsets = std::move(offsets);
+    
+    buildLookup();
+}
+
+void ResourceIndex::assignSorted(std::vector<uint8_t> types, std::vector<uint32_t> numbers,
+                                 std::vector<uint8_t> volumes, std::vector<uint32_t> offsets) {
+    m_types = std::move(types);
+    m_numbers = std::move(numbers);
+    m_volumes = std::move(volumes);
+    m_offsets = std::move(offsets);
+    buildLookup();
+}
+
+void ResourceIndex::buildLookup() {
+    // Plages par type (colonnes triées : chaque type est contigu)
+    const size_t size = m_types.size();
+    m_typeStart.assign(257, 0);
+    for (uint8_t type : m_types) m_typeStart[type + 1]++;
+    for (size_t t = 0; t < 256; t++) m_typeStart[t + 1] += m_typeStart[t];
+    
+    // Hachage à adressage ouvert, facteur de charge <= 0.5
+    size_t capacity = 16;
+    while (capacity < size * 2) capacity <<= 1;
+    m_slots.assign(capacity, 0);
+    m_slotMask = static_cast<uint32_t>(capacity - 1);
+    for (size_t pos = 0; pos < size; pos++) {
+        size_t slot = hashSlot(resourceKey(m_types[pos], m_numbers[pos]), m_slotMask);
+        while (m_slots[slot] != 0) slot = (slot + 1) & m_slotMask;
+        m_slots[slot] = static_cast<uint32_t>(pos + 1);
+    }
+}
+
+void ResourceIndex::clear() {
+    m_types.clear();
+    m_numbers.clear();
+    m_volumes.clear();
+    m_offsets.clear();
+    m_slots.clear();
+    m_slotMask = 0;
+    m_typeStart.clear();
 }
 
+size_t ResourceIndex::find(ResourceType type, uint32_t number) const {
+    if (m_slots.empty()) return npos;
+    
+    size_t slot = hashSlot(resourceKey(type, number), m_slotMask);
+    while (m_slots[slot] != 0) {
+        size_t pos = m_slots[slot] - 1;
+        if (m_types[pos] == type && m_numbers[pos] == number) return pos;
+        slot = (slot + 1) & m_slotMask;
+    }
+    return npos;
+}
+
+// ============================================================================
+// RESSCIParser
+// ============================================================================
+
 RESSCIParser::RESSCIParser() : m_currentVolume(1), m_detectedFormat(ResMapFormat::FORMAT_UNKNOWN) {
 }
 
@@ -64,8 +170,9 @@ RESSCIParser::~RESSCIParser() {
 }
 
 bool RESSCIParser::loadResMap(const std::string& path, uint8_t volumeNumber) {
-    std::ifstream file(path, std::ios::binary);
-    if (!file) {
+    // Projection : le décodeur lit les entrées en place, sans copie du fichier
+    Common::MappedFile file;
+    if (!file.open(path)) {
         std::cerr << "Erreur: impossible d'ouvrir " << path << std::endl;
         return false;
     }
@@ -73,382 +180,287 @@ bool RESSCIParser::loadResMap(const std::string& path, uint8_t volumeNumber) {
     // Sauvegarder le numéro de volume pour l'indexation
     m_currentVolume = volumeNumber;
     
-    // Lire tout le fichier
-    file.seekg(0, std::ios::end);
-    size_t size = file.tellg();
-    file.seekg(0, std::ios::beg);
-    
-    m_resMapData.resize(size);
-    file.read(reinterpret_cast<char*>(m_resMapData.data()), size);
+    std::cout << "RESMAP chargé: " << file.size() << " octets" << std::endl;
     
-    std::cout << "RESMAP chargé: " << size << " octets" << std::endl;
+    // L'index change : les ressources en cache peuvent ne plus correspondre,
+    // et un catalogue chargé ne décrit plus l'index
+    m_cache.clear();
+    m_resolved = nullptr;
+    m_catalog.close();
+    addSource(path, true, volumeNumber);
     
-    return parseResMapHeader();
+    return parseResMap(file.data(), file.size());
+}
+
+RESSCIParser::ResMapFormat RESSCIParser::detectFormat() const {
+    return m_detectedFormat;
 }
 
 /**
- * @brief Détecte automatiquement le format du RESMAP (6 ou 9 octets)
- * 
- * Analyse les 100 premières entrées avec chaque format candidat et valide
- * leur cohérence selon des critères spécifiques :
- * 
- * Format 6 octets (SCI1.1/variantes) :
- *   - Offset < 150 MB
- *   - Number < 65536 (uint16)
- *   - Validation permissive (tous types acceptés)
- * 
- * Format 9 octets (SCI32 standard) :
- *   - Type dans plage SCI (0x80-0x95)
- *   - Offset < 150 MB
- *   - Number < 100000
- *   - Offsets généralement croissants
- * 
- * @return FORMAT_6_BYTES, FORMAT_9_BYTES ou FORMAT_UNKNOWN
+ * @brief Décode le RESMAP (voir resmap_reader.h) et l'ajoute à l'index
+ * @return true si au moins une ressource valide a été indexée
  */
-RESSCIParser::ResMapFormat RESSCIParser::detectFormat() const {
-    if (m_resMapData.size() < 6) return ResMapFormat::FORMAT_UNKNOWN;
-    
-    // Test format 6 octets  
-    size_t numEntries6 = m_resMapData.size() / 6;
-    int valid6 = 0;
-    uint32_t lastOffset6 = 0;
-    
-    for (size_t i = 0; i < std::min(numEntries6, size_t(100)); i++) {
-        const ResMapEntry6* entry = reinterpret_cast<const ResMapEntry6*>(&m_resMapData[i * 6]);
-        uint8_t type = entry->type;
-        uint16_t number = entry->resourceNumber;
-        uint32_t offset = entry->getOffset();
-        
-        // Validation très permissive pour format 6 octets (variantes):
-        // - Offset raisonnable (< 150 MB)
-        // - Number raisonnable (< 65536, c'est un uint16)
-        // - Offset généralement croissant (mais accepte offset=0 pour placeholders)
-        if (offset < 150000000 && number < 65536) {
-            valid6++;
-            if (offset > 0 && offset > lastOffset6) lastOffset6 = offset;
-        }
+bool RESSCIParser::parseResMap(const uint8_t* data, size_t size) {
+    std::vector<ResMapRecord> records;
+    const ResMapLayout layout = decodeResMap(data, size, records);
+    if (layout == RESMAP_UNKNOWN) {
+        std::cerr << "RESMAP non reconnu (" << size << " octets)" << std::endl;
+        m_detectedFormat = FORMAT_UNKNOWN;
+        return false;
     }
     
-    // Test format 9 octets
-    size_t numEntries9 = m_resMapData.size() / 9;
-    int valid9 = 0;
-    uint32_t lastOffset9 = 0;
-    
-    for (size_t i = 0; i < std::min(numEntries9, size_t(100)); i++) {
-        const ResMapEntry9* entry = reinterpret_cast<const ResMapEntry9*>(&m_resMapData[i * 9]);
-        uint8_t type = entry->type;
-        uint32_t offset = entry->offset;
-        uint32_t number = entry->resourceNumber;
-        
-        // Pour format 9 octets: plus strict car c'est le format officiel
-        if ((type >= 0x80 && type <= 0x95) && 
-            offset < 150000000 && 
-            number < 100000 &&
-            (offset >= lastOffset9 || offset == 0)) {
-            valid9++;
-            if (offset > lastOffset9) lastOffset9 = offset;
-        }
+    switch (layout) {
+        case RESMAP_SCI11: m_detectedFormat = RES_FORMAT_SCI11; break;
+        case RESMAP_SCI1_LATE: m_detectedFormat = RES_FORMAT_SCI1_LATE; break;
+        default: m_detectedFormat = FORMAT_9_BYTES; break;
     }
+    std::cout << "  Format détecté: " << resMapLayoutName(layout) << std::endl;
     
-    // Décision: au moins 50% des 100 premières entrées doivent être valides
-    size_t samplesChecked = std::min(size_t(100), std::max(numEntries6, numEntries9));
-    float threshold6 = 0.5f * samplesChecked;
-    float threshold9 = 0.5f * samplesChecked;
+    // Indexer les ressources (un RESMAP chargé plus tard l'emporte)
+    std::map<uint8_t, int> typeCounts;
+    for (const ResMapRecord& record : records) {
+        m_index.insert(static_cast<ResourceType>(record.type), record.number, m_currentVolume, record.offset);
+        typeCounts[record.type]++;
+    }
+    m_index.finalize();
     
-    std::cout << "  [Détection] 6 octets: " << valid6 << "/" << std::min(numEntries6, size_t(100)) 
-              << " valides, 9 octets: " << valid9 << "/" << std::min(numEntries9, size_t(100)) << " valides" << std::endl;
+    std::cout << "  Types de ressources trouvés: " << typeCounts.size() << std::endl;
     
-    if (valid6 >= threshold6 && valid6 > valid9) {
-        return ResMapFormat::FORMAT_6_BYTES;
-    } else if (valid9 >= threshold9) {
-        return ResMapFormat::FORMAT_9_BYTES;
+    for (const auto& [type, count] : typeCounts) {
+        std::cout << "    " << getResourceTypeName(static_cast<ResourceType>(type))
+                 << " (0x" << std::hex << (int)type << std::dec << "): "
+                 << count << " ressources" << std::endl;
     }
     
-    return ResMapFormat::FORMAT_UNKNOWN;
+    std::cout << "  Total ressources indexées: " << m_index.size() << std::endl;
+    
+    return !m_index.empty();
 }
 
-/**
- * @brief Parse le header RESMAP avec détection automatique du format
- * 
- * Cette méthode :
- * 1. Détecte automatiquement le format (6 ou 9 octets)
- * 2. Parse toutes les entrées selon le format détecté
- * 3. Filtre les entrées invalides (types hors plage SCI)
- * 4. Construit l'index des ressources (type, number) -> offset
- * 
- * Format 6 octets : 1920 entrées max (11520 octets)
- * Format 9 octets : 12847+ entrées (Phantasmagoria CD1)
- * 
- * @return true si au moins une ressource valide a été indexée
- */
-bool RESSCIParser::parseResMapHeader() {
-    if (m_resMapData.size() < 6) {
-        std::cerr << "RESMAP trop petit" << std::endl;
+bool RESSCIParser::loadRessci(const std::string& path, uint8_t volumeNumber) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) {
+        std::cerr << "Erreur: impossible d'ouvrir " << path << std::endl;
         return false;
     }
+    size_t size = file.tellg();
     
-    // PARSING STYLE SCUMMVM : Table d'indirection + listes par type
-    // Format SCI1/SCI1.1 : Header avec (type[1B] + offset[2B LE]) répété jusqu'à 0xFF
-    // Puis pour chaque type : liste de (number[2B LE] + offset[3B ou 4B LE])
+    // Projection différée : seul le chemin est retenu
+    std::lock_guard<std::mutex> lock(m_volumeMutex);
+    Volume& volume = m_volumes[volumeNumber];
+    volume.path = path;
+    volume.file.reset();
+    volume.failed = false;
+    m_cache.clear();
+    addSource(path, false, volumeNumber);
     
-    std::map<uint8_t, int> typeCounts;
-    std::map<uint8_t, std::pair<uint16_t, uint16_t>> typeTable; // type -> (offset, size)
+    std::cout << "RESSCI volume " << (int)volumeNumber << " enregistré: " 
+              << size << " octets" << std::endl;
     
-    // ÉTAPE 1 : Lire la table d'indirection (header)
-    size_t pos = 0;
-    uint8_t prevType = 0;
-    uint16_t prevOffset = 0;
-    
-    std::cout << "Parsing RESMAP (style ScummVM avec table d'indirection)..." << std::endl;
-    
-    // Table de conversion type index → ResourceType (comme ScummVM)
-    // Index dans RESMAP (0-31) → ResourceType (0x80-0x95)
-    static const uint8_t typeConversionTable[] = {
-        0x88, // 0x00 → RT_VIEW
-        0x87, // 0x01 → RT_PIC  
-        0x80, // 0x02 → RT_SCRIPT
-        0x83, // 0x03 → RT_TEXT
-        0x81, // 0x04 → RT_SOUND
-        0x82, // 0x05 → RT_MEMORY
-        0x86, // 0x06 → RT_VOCAB
-        0x84, // 0x07 → RT_FONT
-        0x85, // 0x08 → RT_CURSOR
-        0x89, // 0x09 → RT_PATCH
-        0x8A, // 0x0A → RT_BITMAP
-        0x8B, // 0x0B → RT_PALETTE
-        0x8C, // 0x0C → RT_CDAUDIO
-        0x8D, // 0x0D → RT_AUDIO
-        0x8E, // 0x0E → RT_SYNC
-        0x8F, // 0x0F → RT_MESSAGE
-        0x90, // 0x10 → RT_CHUNK
-        0x91, // 0x11 → RT_HEAP
-        0x92, // 0x12 → RT_AUDIO36
-        0x93, // 0x13 → RT_SYNC36
-        0x94, // 0x14 → RT_CHUNK
-        0x95, // 0x15 → RT_AUDIOMAP
-        0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF  // 0x16-0x1F unused
-    };
-    
-    // ÉTAPE 1a : Lire tous les (type, offset) y compris le terminateur
-    std::vector<std::pair<uint8_t, uint16_t>> allEntries;
-    
-    while (pos + 3 <= m_resMapData.size()) {
-        uint8_t typeRaw = m_resMapData[pos];
-        uint8_t type = typeRaw & 0x1F;  // Masquer pour obtenir type réel
-        uint16_t offset = readLE16(&m_resMapData[pos + 1]);
-        
-        pos += 3;
-        
-        allEntries.push_back({type, offset});
-        
-        // 0x1F (0xFF & 0x1F) = terminateur
-        if (type == 0x1F) {
-            std::cout << "  Terminateur trouvé à l'offset " << pos - 3 << std::endl;
-            break;
+    return true;
+}
+
+void RESSCIParser::addSource(const std::string& path, bool isMap, uint8_t volumeNumber) {
+    // Un RESSCI rechargé pour le même volume remplace le précédent
+    for (CatalogSource& source : m_sources) {
+        if (source.path == path || (!isMap && !source.isMap && source.volume == volumeNumber)) {
+            source.path = path;
+            source.isMap = isMap;
+            source.volume = volumeNumber;
+            return;
         }
     }
+    CatalogSource source;
+    source.path = path;
+    source.isMap = isMap;
+    source.volume = volumeNumber;
+    m_sources.push_back(std::move(source));
+}
+
+bool RESSCIParser::loadCatalog(const std::string& path, const std::string& resourceDir) {
+    if (!m_catalog.open(path)) {
+        return false;
+    }
     
-    // ÉTAPE 1b : Calculer les tailles en utilisant l'offset suivant
-    for (size_t i = 0; i < allEntries.size(); i++) {
-        uint8_t type = allEntries[i].first;
-        uint16_t offset = allEntries[i].second;
-        
-        if (type == 0x1F) break;  // Ignorer le terminateur
-        
-        // Calculer la taille jusqu'au prochain offset (ou fin du fichier)
-        uint16_t size;
-        if (i + 1 < allEntries.size()) {
-            size = allEntries[i + 1].second - offset;
-        } else {
-            // Dernier type : utiliser la taille du fichier RESMAP
-            size = m_resMapData.size() - offset;
+    // Catalogue d'une autre installation : à reconstruire
+    if (!resourceDir.empty()) {
+        for (const CatalogSource& source : m_catalog.sources()) {
+            std::error_code ec;
+            if (!std::filesystem::equivalent(std::filesystem::path(source.path).parent_path(), resourceDir, ec)) {
+                m_catalog.close();
+                return false;
+            }
         }
-        
-        typeTable[type] = std::make_pair(offset, size);
     }
     
-    std::cout << "  Table d'indirection : " << typeTable.size() << " types trouvés" << std::endl;
-    
-    // ÉTAPE 2 : Détection automatique du format d'entrée (comme ScummVM)
-    // SCI1.1/SCI2: 5 bytes (number[2B] + offset[3B])
-    // SCI0/SCI1:   6 bytes (number[2B] + offset[4B])
-    // Méthode ScummVM: tester si les tailles de sections sont divisibles par 5 ou 6
-    
-    ResMapFormat mapDetected = RES_FORMAT_UNKNOWN;
-    
-    // Parcourir les sections pour détecter le format
-    for (const auto& [typeRaw, offsetSize] : typeTable) {
-        uint16_t sizeBytes = offsetSize.second;
-        
-        if (sizeBytes == 0) continue;
-        
-        // ScummVM logic (resource.cpp ligne 1352-1356):
-        // if ((directorySize % 5) && (directorySize % 6 == 0))
-        //     mapDetected = kResVersionSci1Late;
-        // if ((directorySize % 5 == 0) && (directorySize % 6))
-        //     mapDetected = kResVersionSci11;
-        
-        bool divisibleBy5 = (sizeBytes % 5 == 0);
-        bool divisibleBy6 = (sizeBytes % 6 == 0);
-        
-        if (!divisibleBy5 && divisibleBy6) {
-            // Divisible par 6 mais pas 5 → SCI1 Late (6 bytes/entrée)
-            if (mapDetected == RES_FORMAT_UNKNOWN || mapDetected == RES_FORMAT_SCI1_LATE) {
-                mapDetected = RES_FORMAT_SCI1_LATE;
-            }
-        } else if (divisibleBy5 && !divisibleBy6) {
-            // Divisible par 5 mais pas 6 → SCI1.1 (5 bytes/entrée)
-            if (mapDetected == RES_FORMAT_UNKNOWN || mapDetected == RES_FORMAT_SCI11) {
-                mapDetected = RES_FORMAT_SCI11;
+    const CatalogEntry* entries = m_catalog.entries();
+    const size_t count = m_catalog.entryCount();
+    std::vector<uint8_t> types(count), volumes(count);
+    std::vector<uint32_t> numbers(count), offsets(count);
+    for (size_t i = 0; i < count; i++) {
+        types[i] = entries[i].type;
+        numbers[i] = entries[i].number;
+        volumes[i] = entries[i].volume;
+        offsets[i] = entries[i].offset;
+    }
+    m_index.assignSorted(std::move(types), std::move(numbers), std::move(volumes), std::move(offsets));
+    m_resolved = entries;
+    m_sources = m_catalog.sources();
+    
+    // Volumes RESSCI : projection différée, comme loadRessci()
+    {
+        std::lock_guard<std::mutex> lock(m_volumeMutex);
+        m_volumes.clear();
+        for (const CatalogSource& source : m_sources) {
+            if (!source.isMap) {
+                Volume& volume = m_volumes[source.volume];
+                volume.path = source.path;
             }
         }
-        // Note: Si divisible par les deux (ex: 30 bytes), on ne peut pas décider avec cette section seule
     }
+    m_cache.clear();
     
-    // Par défaut, assumer SCI1 Late si pas de détection claire
-    if (mapDetected == RES_FORMAT_UNKNOWN) {
-        mapDetected = RES_FORMAT_SCI1_LATE;
+    std::cout << "Catalogue chargé: " << path << " (" << count << " ressources, "
+              << m_volumes.size() << " volume(s) RESSCI)" << std::endl;
+    return true;
+}
+
+bool RESSCIParser::saveCatalog(const std::string& path) {
+    if (m_index.empty() || m_sources.empty()) {
+        return false;
     }
     
-    bool isSCI11 = (mapDetected == RES_FORMAT_SCI11);
-    size_t entrySize = isSCI11 ? 5 : 6;
-    
-    std::cout << "  Format détecté: " << (isSCI11 ? "SCI1.1 (5 bytes/entrée)" : "SCI1 Late (6 bytes/entrée)") << std::endl;
+    std::vector<CatalogSource> sources = m_sources;
+    for (CatalogSource& source : sources) {
+        if (!ResourceCatalog::fingerprint(source.path, source.size, source.mtime)) {
+            std::cerr << "Erreur: impossible de lire " << source.path << std::endl;
+            return false;
+        }
+    }
     
-    for (const auto& [typeRaw, offsetSize] : typeTable) {
-        uint16_t offset = offsetSize.first;
-        uint16_t sizeBytes = offsetSize.second;
-        
-        if (offset >= m_resMapData.size()) continue;
-        
-        // Convertir type index (0x00-0x1F) vers ResourceType (0x80-0x95)
-        if (typeRaw > 0x15) continue;  // Type invalide
-        uint8_t type = typeConversionTable[typeRaw];
-        if (type == 0xFF) continue;  // Type non utilisé
+    // Résoudre chaque en-tête une fois (lecture des seuls en-têtes dans les volumes projetés)
+    std::vector<CatalogEntry> entries(m_index.size());
+    for (size_t pos = 0; pos < m_index.size(); pos++) {
+        ResourceIndex::Entry e = m_index.at(pos);
+        CatalogEntry& entry = entries[pos];
+        entry = CatalogEntry();
+        entry.type = e.type;
+        entry.number = e.number;
+        entry.volume = e.volume;
+        entry.offset = e.offset;
         
-        ResourceType resType = static_cast<ResourceType>(type);
-        
-        // Calculer nombre d'entrées
-        size_t numEntries = sizeBytes / entrySize;
+        if (m_resolved) {
+            entry.headerSize = m_resolved[pos].headerSize;
+            entry.compressedSize = m_resolved[pos].compressedSize;
+            entry.decompressedSize = m_resolved[pos].decompressedSize;
+            entry.method = m_resolved[pos].method;
+            continue;
+        }
         
-        for (size_t i = 0; i < numEntries; i++) {
-            size_t entryPos = offset + i * entrySize;
-            
-            if (entryPos + entrySize > m_resMapData.size()) break;
-            
-            // Lire number (2 bytes LE)
-            uint16_t number = readLE16(&m_resMapData[entryPos]);
-            
-            // Lire offset
-            uint32_t resOffset;
-            if (isSCI11) {
-                // SCI1.1/SCI2: 3 bytes (low word[2B] + high byte[1B]), peut avoir shift
-                resOffset = m_resMapData[entryPos + 2] | 
-                           (m_resMapData[entryPos + 3] << 8) | 
-                           (m_resMapData[entryPos + 4] << 16);
-                // Note: SCI1.1 utilise shift, SCI2 non (à implémenter si nécessaire)
-            } else {
-                // SCI0/SCI1: 4 bytes LE, pas de shift
-                resOffset = readLE32(&m_resMapData[entryPos + 2]);
-            }
-            
-            // Indexer la ressource
-            auto key = std::make_pair(resType, static_cast<uint32_t>(number));
-            m_resourceIndex[key] = resOffset;
-            m_resourceVolumes[key] = m_currentVolume;
-            
-            typeCounts[type]++;
+        const Common::MappedFile* volumeFile = getVolume(e.volume);
+        if (!volumeFile) {
+            continue;
+        }
+        ResourceInfo info;
+        info.offset = e.offset;
+        size_t headerSize = 0;
+        if (readResourceHeader(e.type, volumeFile->data(), volumeFile->size(), info, headerSize)) {
+            entry.headerSize = static_cast<uint8_t>(headerSize);
+            entry.compressedSize = info.compressedSize;
+            entry.decompressedSize = info.decompressedSize;
+            entry.method = info.method;
         }
     }
     
-    std::cout << "  Types de ressources trouvés: " << typeCounts.size() << std::endl;
-    
-    for (const auto& [type, count] : typeCounts) {
-        std::cout << "    " << getResourceTypeName(static_cast<ResourceType>(type))
-                 << " (0x" << std::hex << (int)type << std::dec << "): "
-                 << count << " ressources" << std::endl;
-    }
-    
-    std::cout << "  Total ressources indexées: " << m_resourceIndex.size() << std::endl;
-    
-    return !m_resourceIndex.empty();
+    return ResourceCatalog::write(path, sources, entries);
 }
 
-bool RESSCIParser::loadRessci(const std::string& path, uint8_t volumeNumber) {
-    std::ifstream file(path, std::ios::binary);
-    if (!file) {
-        std::cerr << "Erreur: impossible d'ouvrir " << path << std::endl;
-        return false;
+const Common::MappedFile* RESSCIParser::getVolume(uint8_t volumeNumber) {
+    std::lock_guard<std::mutex> lock(m_volumeMutex);
+    auto it = m_volumes.find(volumeNumber);
+    if (it == m_volumes.end()) {
+        return nullptr;
     }
     
-    // Lire tout le fichier
-    file.seekg(0, std::ios::end);
-    size_t size = file.tellg();
-    file.seekg(0, std::ios::beg);
-    
-    auto& volumeData = m_ressciData[volumeNumber];
-    volumeData.resize(size);
-    file.read(reinterpret_cast<char*>(volumeData.data()), size);
-    
-    std::cout << "RESSCI volume " << (int)volumeNumber << " chargé: " 
-              << size << " octets" << std::endl;
-    
-    return true;
+    Volume& volume = it->second;
+    if (!volume.file && !volume.failed) {
+        auto mapped = std::make_unique<Common::MappedFile>();
+        if (mapped->open(volume.path)) {
+            LOG_DEBUG(Ressci, "RESSCI volume %d projeté: %zu octets\n", (int)volumeNumber, mapped->size());
+            volume.file = std::move(mapped);
+        } else {
+            std::cerr << "Erreur: impossible de projeter " << volume.path << std::endl;
+            volume.failed = true;
+        }
+    }
+    return volume.file.get();
 }
 
 ResourceInfo RESSCIParser::extractResource(ResourceType type, uint32_t number) {
     ResourceInfo info;
-    info.type = type;
-    info.number = number;
-    info.offset = 0;
-    info.compressedSize = 0;
-    info.decompressedSize = 0;
-    info.method = CM_NONE;
-    info.volume = 1;
     
-    // Chercher dans l'index
-    auto key = std::make_pair(type, number);
-    auto it = m_resourceIndex.find(key);
-    if (it == m_resourceIndex.end()) {
-        std::cerr << "Ressource " << getResourceTypeName(type) 
-                  << " #" << number << " non trouvée" << std::endl;
+    if (m_cache.enabled()) {
+        std::shared_ptr<const ResourceInfo> shared = getResource(type, number);
+        if (shared) {
+            return *shared;
+        }
+        info = ResourceInfo();
+        info.type = type;
+        info.number = number;
         return info;
     }
     
-    info.offset = it->second;
-    
-    // Trouver le volume
-    auto volIt = m_resourceVolumes.find(key);
-    if (volIt != m_resourceVolumes.end()) {
-        info.volume = volIt->second;
+    ResourceView view;
+    if (extractResourceView(type, number, info, view)) {
+        info.data = view.release();
     }
-    
-    // Vérifier que le volume est chargé
-    auto dataIt = m_ressciData.find(info.volume);
-    if (dataIt == m_ressciData.end()) {
-        std::cerr << "Volume " << (int)info.volume << " non chargé" << std::endl;
-        return info;
+    return info;
+}
+
+std::shared_ptr<const ResourceInfo> RESSCIParser::getResource(ResourceType type, uint32_t number) {
+    const uint64_t key = resourceKey(type, number);
+    const bool cached = m_cache.enabled();
+    if (cached) {
+        if (std::shared_ptr<const ResourceInfo> hit = m_cache.get(key)) {
+            return hit;
+        }
     }
     
-    const auto& volumeData = dataIt->second;
+    ResourceInfo info;
+    ResourceView view;
+    if (!extractResourceView(type, number, info, view)) {
+        return nullptr;
+    }
+    info.data = view.release();
     
+    auto shared = std::make_shared<const ResourceInfo>(std::move(info));
+    if (cached) {
+        // Un autre thread a pu décompresser la même ressource entre-temps
+        const size_t bytes = sizeof(ResourceInfo) + shared->data.size();
+        return m_cache.insert(key, std::move(shared), bytes);
+    }
+    return shared;
+}
+
+bool RESSCIParser::readResourceHeader(ResourceType type,
+                                     const uint8_t* volumeBytes, size_t volumeSize,
+                                     ResourceInfo& info, size_t& headerSize)
+{
     // Vérifier que l'offset est valide pour un header minimum
-    if (info.offset + 13 > volumeData.size()) {  // SCI2.1 nécessite 13 octets
+    if (info.offset + 13 > volumeSize) {  // SCI2.1 nécessite 13 octets
         std::cerr << "Offset invalide: " << info.offset << std::endl;
-        return info;
+        return false;
     }
     
-    const uint8_t* headerPtr = volumeData.data() + info.offset;
-    size_t headerSize = 0;
+    const uint8_t* headerPtr = volumeBytes + info.offset;
     
-    // Lire octet 0 et octets 1-2
+    // Octet 0 : type (bit 7 = compression en SCI1.1), octets 1-2 : numéro
     uint8_t resType = headerPtr[0];
-    uint16_t resNumber = readLE16(headerPtr + 1);
     
     // Détecter le format RESSCI : SCI1.1 (6-10 bytes) ou SCI2.1 (13 bytes)
     // Phantasmagoria (SCI2.1) utilise RESMAP 6 bytes + RESSCI 13 bytes
     // Heuristique : Forcer SCI2.1 si le volume est > 50 Mo (CD-ROM game)
-    bool forceSCI21 = (volumeData.size() > 50000000);
+    bool forceSCI21 = (volumeSize > 50000000);
     
     // Lire les valeurs comme SCI2.1
     uint32_t compSize4 = readLE32(headerPtr + 3);
@@ -456,8 +468,8 @@ ResourceInfo RESSCIParser::extractResource(ResourceType type, uint32_t number) {
     uint16_t method16 = readLE16(headerPtr + 11);
     
     // SCI2.1 si forcé OU si les valeurs semblent valides
-    bool validSizes = (compSize4 > 0 && compSize4 < volumeData.size() &&
-                       decompSize4 > 0 && decompSize4 < volumeData.size() * 10);
+    bool validSizes = (compSize4 > 0 && compSize4 < volumeSize &&
+                       decompSize4 > 0 && decompSize4 < volumeSize * 10);
     bool validMethod = (method16 == 0 || method16 == 1 || method16 == 2 || method16 == 3 ||
                         method16 == 4 || method16 == 18 || method16 == 19 || method16 == 20 ||
                         method16 == 32 || method16 < 256);
@@ -476,12 +488,10 @@ ResourceInfo RESSCIParser::extractResource(ResourceType type, uint32_t number) {
         info.decompressedSize = decompSize4;
         info.method = static_cast<CompressionMethod>(method16);
         
-        // DEBUG
         if (type == RT_SCRIPT || type == RT_HEAP) {
-            std::cout << "  " << getResourceTypeName(type) << " #" << number 
-                      << " (SCI2.1): method=0x" << std::hex << method16 << std::dec
-                      << ", compSize=" << info.compressedSize 
-                      << ", decompSize=" << info.decompressedSize << std::endl;
+            LOG_DEBUG(Ressci, "  %s #%u (SCI2.1): method=0x%x, compSize=%u, decompSize=%u\n",
+                      getResourceTypeName(type), (unsigned)readLE16(headerPtr + 1), method16,
+                      info.compressedSize, info.decompressedSize);
         }
     } else {
         // FORMAT SCI1.1 : 6-10 bytes (variable)
@@ -497,54 +507,121 @@ ResourceInfo RESSCIParser::extractResource(ResourceType type, uint32_t number) {
         headerSize = 6;
         
         // Si compression, lire méthode (1B) + decompSize (3B)
-        if (hasCompression && info.offset + 10 <= volumeData.size()) {
+        if (hasCompression && info.offset + 10 <= volumeSize) {
             info.method = static_cast<CompressionMethod>(headerPtr[6]);
             info.decompressedSize = headerPtr[7] | (headerPtr[8] << 8) | (headerPtr[9] << 16);
             headerSize = 10;
         }
         
-        // DEBUG
         if (type == RT_SCRIPT || type == RT_HEAP) {
-            std::cout << "  " << getResourceTypeName(type) << " #" << number 
-                      << " (SCI1.1): method=0x" << std::hex << (int)info.method << std::dec
-                      << ", compSize=" << info.compressedSize 
-                      << ", decompSize=" << info.decompressedSize << std::endl;
+            LOG_DEBUG(Ressci, "  %s #%u (SCI1.1): method=0x%x, compSize=%u, decompSize=%u\n",
+                      getResourceTypeName(type), (unsigned)readLE16(headerPtr + 1), (unsigned)info.method,
+                      info.compressedSize, info.decompressedSize);
         }
     }
     
+    return true;
+}
+
+bool RESSCIParser::extractResourceView(ResourceType type, uint32_t number,
+                                       ResourceInfo& info, ResourceView& view) {
+    view = ResourceView();
+    info.data.clear();
+    info.type = type;
+    info.number = number;
+    info.offset = 0;
+    info.compressedSize = 0;
+    info.decompressedSize = 0;
+    info.method = CM_NONE;
+    info.volume = 1;
+    
+    // Chercher dans l'index
+    size_t pos = m_index.find(type, number);
+    if (pos == ResourceIndex::npos) {
+        std::cerr << "Ressource " << getResourceTypeName(type) 
+                  << " #" << number << " non trouvée" << std::endl;
+        return false;
+    }
+    
+    info.offset = m_index.offsetAt(pos);
+    info.volume = m_index.volumeAt(pos);
+    
+    // Vérifier que le volume est disponible (projeté au premier accès)
+    const Common::MappedFile* volumeFile = getVolume(info.volume);
+    if (!volumeFile) {
+        std::cerr << "Volume " << (int)info.volume << " non chargé" << std::endl;
+        return false;
+    }
+    
+    const uint8_t* volumeBytes = volumeFile->data();
+    const size_t volumeSize = volumeFile->size();
+    
+    size_t headerSize = 0;
+    if (m_resolved) {
+        // En-tête déjà résolu par le catalogue
+        const CatalogEntry& resolved = m_resolved[pos];
+        if (resolved.headerSize == 0) {
+            return false;
+        }
+        headerSize = resolved.headerSize;
+        info.compressedSize = resolved.compressedSize;
+        info.decompressedSize = resolved.decompressedSize;
+        info.method = static_cast<CompressionMethod>(resolved.method);
+    } else if (!readResourceHeader(type, volumeBytes, volumeSize, info, headerSize)) {
+        return false;
+    }
+    
     // Lire les données compressées
     size_t dataOffset = info.offset + headerSize;
     size_t dataSize = info.compressedSize;
     
     // Validation stricte
-    if (dataOffset >= volumeData.size() || dataSize == 0 || dataSize > volumeData.size() || 
-        dataOffset + dataSize > volumeData.size()) {
+    if (dataOffset >= volumeSize || dataSize == 0 || dataSize > volumeSize || 
+        dataOffset + dataSize > volumeSize) {
         // Ne logger que si c'est proche d'être valide
-        if (dataOffset < volumeData.size() && dataSize > 0 && dataSize < volumeData.size() * 2) {
+        if (dataOffset < volumeSize && dataSize > 0 && dataSize < volumeSize * 2) {
             std::cerr << "Données invalides ignorées: offset=" << dataOffset 
-                      << " size=" << dataSize << " total=" << volumeData.size() << std::endl;
+                      << " size=" << dataSize << " total=" << volumeSize << std::endl;
         }
-        return info;
+        return false;
     }
     
-    std::vector<uint8_t> compressedData(volumeData.begin() + dataOffset,
-                                        volumeData.begin() + dataOffset + dataSize);
+    const uint8_t* compressedData = volumeBytes + dataOffset;
     
-    // Décompresser
-    info.data = decompress(compressedData, info.method, info.decompressedSize);
+    // Non compressée : vue directe dans le volume
+    if (info.method == CM_NONE || info.method == CM_NONE_ALIAS) {
+        view.m_mapped = compressedData;
+        view.m_mappedSize = dataSize;
+        return true;
+    }
     
-    return info;
+    // Décompresser directement depuis le volume vers le tampon final
+    view.m_buffer.resize(info.decompressedSize);
+    size_t produced = 0;
+    if (!decompressInto(compressedData, dataSize, info.method,
+                        view.m_buffer.data(), view.m_buffer.size(), produced)) {
+        view.m_buffer.clear();
+        return false;
+    }
+    view.m_buffer.resize(produced);
+    
+    return !view.m_buffer.empty();
 }
 
-std::vector<ResourceInfo> RESSCIParser::extractAllResourcesOfType(ResourceType type) {
-    std::vector<ResourceInfo> resources;
+std::vector<ResourceInfo> RESSCIParser::extractAllResourcesOfType(ResourceType type, unsigned jobs) {
+    ResourceIndex::Range range = m_index.ofType(type);
     
-    for (const auto& [key, offset] : m_resourceIndex) {
-        if (key.first == type) {
-            ResourceInfo info = extractResource(type, key.second);
-            if (!info.data.empty()) {
-                resources.push_back(info);
-            }
+    // Une case par ressource : l'ordre du résultat suit l'index, pas les threads
+    std::vector<ResourceInfo> slots(range.size());
+    Parallel::parallelFor(range.size(), jobs > 0 ? jobs : Parallel::defaultJobCount(), [&](size_t i) {
+        slots[i] = extractResource(type, range[i].number);
+    });
+    
+    std::vector<ResourceInfo> resources;
+    resources.reserve(slots.size());
+    for (ResourceInfo& info : slots) {
+        if (!info.data.empty()) {
+            resources.push_back(std::move(info));
         }
     }
     
@@ -556,185 +633,258 @@ std::vector<uint8_t> RESSCIParser::decompress(
     CompressionMethod method,
     uint32_t decompressedSize)
 {
+    if (method == CM_NONE || method == CM_NONE_ALIAS) {
+        return compressed;
+    }
+    
+    std::vector<uint8_t> result(decompressedSize);
+    size_t produced = 0;
+    if (!decompressInto(compressed.data(), compressed.size(), method,
+                        result.data(), result.size(), produced)) {
+        return std::vector<uint8_t>();
+    }
+    result.resize(produced);
+    return result;
+}
+
+bool RESSCIParser::decompressInto(
+    const uint8_t* data, size_t size,
+    CompressionMethod method,
+    uint8_t* out, size_t outSize,
+    size_t& produced)
+{
+    int64_t written = -1;
+    
     switch (method) {
         case CM_NONE:
         case CM_NONE_ALIAS:
-            return compressed;
+            written = static_cast<int64_t>(std::min(size, outSize));
+            if (written > 0) {
+                std::memcpy(out, data, static_cast<size_t>(written));
+            }
+            break;
             
         case CM_RLE_SIMPLE:
         case CM_RLE_ADV:
         case CM_RLE_0x34:
-            return decompressRLE(compressed, decompressedSize);
+            written = decompressRLE(data, size, out, outSize);
+            break;
             
         case CM_HUFFMAN:
         case CM_HUFFMAN_V56:
-            return decompressHuffman(compressed, decompressedSize);
+            written = decompressHuffman(data, size, out, outSize);
+            break;
             
         case CM_LZ_BIT:
         case CM_LZ_ADV:
         case CM_LZSS_31:
         case CM_UNKNOWN:
-            return decompressLZ(compressed, decompressedSize);
+            written = decompressLZ(data, size, out, outSize);
+            break;
             
         case CM_LZS:         // 0x20 - LZS pour Phantasmagoria scripts
         case CM_STACPACK:
         case CM_STACPACK_OLD:
-            return decompressSTACpack(compressed, decompressedSize);
+            written = decompressSTACpack(data, size, out, outSize);
+            break;
             
         case CM_RLE_HUFF:
-            // Décompresser d'abord avec Huffman, puis RLE
+            // Décompresser d'abord avec Huffman, puis RLE. Le flux RLE
+            // intermédiaire compte au plus un octet de code par 127 octets
+            // produits ; la sortie RLE doit couvrir exactement outSize
             {
-                auto temp = decompressHuffman(compressed, decompressedSize * 2);
-                return decompressRLE(temp, decompressedSize);
+                std::vector<uint8_t> temp(outSize + (outSize + 126) / 127);
+                int64_t tempSize = decompressHuffman(data, size, temp.data(), temp.size());
+                if (tempSize >= 0) {
+                    int64_t rleSize = decompressRLE(temp.data(), static_cast<size_t>(tempSize), out, outSize);
+                    written = rleSize == static_cast<int64_t>(outSize) ? rleSize : -1;
+                }
             }
+            break;
             
         default:
             // Logger seulement une fois par méthode inconnue pour éviter le spam
-            if (s_unsupportedMethodsLogged.find((uint8_t)method) == s_unsupportedMethodsLogged.end()) {
-                std::cerr << "Méthode de compression non supportée: 0x" 
-                         << std::hex << (int)method << std::dec << std::endl;
-                s_unsupportedMethodsLogged.insert((uint8_t)method);
+            {
+                std::lock_guard<std::mutex> lock(s_unsupportedMethodsMutex);
+                if (s_unsupportedMethodsLogged.insert((uint8_t)method).second) {
+                    std::cerr << "Méthode de compression non supportée: 0x" 
+                             << std::hex << (int)method << std::dec << std::endl;
+                }
             }
-            return std::vector<uint8_t>();
+            break;
     }
+    
+    if (written < 0) {
+        produced = 0;
+        return false;
+    }
+    produced = static_cast<size_t>(written);
+    return true;
 }
 
-std::vector<uint8_t> RESSCIParser::decompressRLE(
-    const std::vector<uint8_t>& data,
-    uint32_t decompSize)
+int64_t RESSCIParser::decompressRLE(
+    const uint8_t* data, size_t size,
+    uint8_t* out, size_t outSize)
 {
-    std::vector<uint8_t> result;
-    result.reserve(decompSize);
-    
     size_t pos = 0;
-    while (pos < data.size() && result.size() < decompSize) {
+    size_t written = 0;
+    while (pos < size && written < outSize) {
         uint8_t code = data[pos++];
         
         if (code & 0x80) {
             // Run: répéter le prochain octet (code & 0x7F) fois
-            if (pos >= data.size()) break;
+            if (pos >= size) break;
             
             uint8_t value = data[pos++];
-            int count = code & 0x7F;
-            
-            for (int i = 0; i < count && result.size() < decompSize; i++) {
-                result.push_back(value);
-            }
+            size_t count = std::min<size_t>(code & 0x7F, outSize - written);
+            std::memset(out + written, value, count);
+            written += count;
         } else {
             // Literal: copier les (code) octets suivants
-            int count = code;
-            
-            for (int i = 0; i < count && pos < data.size() && result.size() < decompSize; i++) {
-                result.push_back(data[pos++]);
-            }
+            size_t count = std::min<size_t>({(size_t)code, size - pos, outSize - written});
+            std::memcpy(out + written, data + pos, count);
+            pos += count;
+            written += count;
         }
     }
     
-    return result;
+    return static_cast<int64_t>(written);
 }
 
-std::vector<uint8_t> RESSCIParser::decompressHuffman(
-    const std::vector<uint8_t>& data,
-    uint32_t decompSize)
+int64_t RESSCIParser::decompressHuffman(
+    const uint8_t* data, size_t size,
+    uint8_t* out, size_t outSize)
 {
-    // Implémentation simplifiée de Huffman
-    // Pour une implémentation complète, voir ScummVM engines/sci/util.cpp
-    
-    std::vector<uint8_t> result;
-    result.reserve(decompSize);
-    
-    // TODO: Implémenter l'arbre Huffman complet
-    // Pour l'instant, retourner les données telles quelles
-    std::cerr << "AVERTISSEMENT: Décompression Huffman non implémentée complètement" << std::endl;
-    
-    return data;
+    // Table de décodage multi-bits (formats/huffman.cpp) ; -1 si l'arbre est invalide
+    return HuffmanDecompress(data, static_cast<uint32_t>(size), out, static_cast<uint32_t>(outSize));
 }
 
-std::vector<uint8_t> RESSCIParser::decompressLZ(
-    const std::vector<uint8_t>& data,
-    uint32_t decompSize)
+int64_t RESSCIParser::decompressLZ(
+    const uint8_t* data, size_t size,
+    uint8_t* out, size_t outSize)
 {
     // Implémentation LZSS-like pour SCI
-    std::vector<uint8_t> result;
-    result.reserve(decompSize);
-    
     size_t pos = 0;
-    while (pos < data.size() && result.size() < decompSize) {
+    size_t written = 0;
+    while (pos < size && written < outSize) {
         uint8_t code = data[pos++];
         
-        for (int bit = 0; bit < 8 && result.size() < decompSize; bit++) {
-            if (pos >= data.size()) break;
+        for (int bit = 0; bit < 8 && written < outSize; bit++) {
+            if (pos >= size) break;
             
             if (code & (1 << bit)) {
                 // Literal
-                result.push_back(data[pos++]);
+                out[written++] = data[pos++];
             } else {
                 // LZ reference: [offset(12 bits), length(4 bits)]
-                if (pos + 1 >= data.size()) break;
+                if (pos + 1 >= size) break;
                 
-                uint16_t ref = readLE16(&data[pos]);
+                uint16_t ref = readLE16(data + pos);
                 pos += 2;
                 
-                int offset = ref >> 4;
-                int length = (ref & 0x0F) + 3;
+                size_t offset = ref >> 4;
+                size_t length = (ref & 0x0F) + 3;
                 
-                // Copier depuis le dictionnaire
-                for (int i = 0; i < length && result.size() < decompSize; i++) {
-                    if (offset <= result.size()) {
-                        result.push_back(result[result.size() - offset]);
-                    }
+                // Copier depuis le dictionnaire (octet par octet : les
+                // références peuvent chevaucher la sortie)
+                if (offset == 0 || offset > written) continue;
+                length = std::min(length, outSize - written);
+                for (size_t i = 0; i < length; i++, written++) {
+                    out[written] = out[written - offset];
                 }
             }
         }
     }
     
-    return result;
+    return static_cast<int64_t>(written);
 }
 
-std::vector<uint8_t> RESSCIParser::decompressSTACpack(
-    const std::vector<uint8_t>& data,
-    uint32_t decompSize)
+int64_t RESSCIParser::decompressSTACpack(
+    const uint8_t* data, size_t size,
+    uint8_t* out, size_t outSize)
 {
     // STACpack est l'algorithme LZS utilisé par Phantasmagoria
-    // On utilise la fonction LZSDecompress existante
-    
-    std::vector<uint8_t> result(decompSize);
+    // On utilise la fonction LZSDecompress existante : 0 si le flux a produit
+    // exactement outSize octets, 1 sinon (flux tronqué, référence invalide)
+    int ret = LZSDecompress(data, static_cast<uint32_t>(size), out, static_cast<uint32_t>(outSize));
     
-    int ret = LZSDecompress(data.data(), data.size(), result.data(), decompSize);
-    
-    if (ret < 0) {
+    if (ret != 0) {
         std::cerr << "Erreur LZS decompression: " << ret << std::endl;
-        return std::vector<uint8_t>();
+        return -1;
     }
     
-    return result;
+    return static_cast<int64_t>(outSize);
 }
 
-std::vector<RobotCoordinates> RESSCIParser::extractRobotCoordinates() {
+std::vector<RobotCoordinates> RESSCIParser::extractRobotCoordinates(unsigned jobs) {
     std::vector<RobotCoordinates> allCoords;
     
-    // Extraire tous les scripts
-    auto scripts = extractAllResourcesOfType(RT_SCRIPT);
+    // Décompresser et analyser chaque script sur le pool ; le script n'est
+    // gardé en mémoire que le temps de son analyse
+    ResourceIndex::Range range = m_index.ofType(RT_SCRIPT);
+    std::vector<std::vector<RobotCoordinates>> coordsByScript(range.size());
+    std::vector<uint8_t> scriptLoaded(range.size(), 0);
     
-    std::cout << "Analyse de " << scripts.size() << " scripts pour CALLK Robot (opcode 0x76)...\n";
+    std::vector<std::vector<ScriptObject>> objectsByScript(range.size());
     
+    Parallel::parallelFor(range.size(), jobs > 0 ? jobs : Parallel::defaultJobCount(), [&](size_t i) {
+        std::shared_ptr<const ResourceInfo> script = getResource(RT_SCRIPT, range[i].number);
+        if (!script || script->data.empty()) {
+            return;
+        }
+        scriptLoaded[i] = 1;
+        coordsByScript[i] = parseScriptForRobotCalls(script->data, script->number);
+        objectsByScript[i] = loadScriptObjects(static_cast<uint16_t>(range[i].number), *script);
+    });
+    
+    size_t scriptCount = 0;
+    for (uint8_t loaded : scriptLoaded) {
+        scriptCount += loaded;
+    }
+    
+    std::cout << "Analyse de " << scriptCount << " scripts pour les appels callk Robot...\n";
+    
+    // Fusion dans l'ordre des numéros de script (déterministe)
     int scriptsWithRobot = 0;
-    for (const auto& script : scripts) {
-        auto coords = parseScriptForRobotCalls(script.data, script.number);
+    std::set<uint32_t> robotsFound;
+    for (size_t i = 0; i < range.size(); i++) {
+        std::vector<RobotCoordinates>& coords = coordsByScript[i];
         if (!coords.empty()) {
             scriptsWithRobot++;
-            std::cout << "  Script #" << script.number << ": " 
+            std::cout << "  Script #" << range[i].number << ": " 
                      << coords.size() << " appel(s) kRobot trouvé(s)\n";
             for (const auto& c : coords) {
                 std::cout << "    → Robot #" << c.robotId 
                          << " @ (" << c.x << ", " << c.y << ")"
                          << " [Pri:" << c.priority << "]\n";
+                robotsFound.insert(c.robotId);
             }
         }
         allCoords.insert(allCoords.end(), coords.begin(), coords.end());
     }
     
+    // Objets Robot des HEAP : uniquement pour les robots sans appel kRobot littéral
+    ObjectTable objects;
+    for (auto& scriptObjects : objectsByScript) {
+        objects.addObjects(std::move(scriptObjects));
+    }
+    finalizeObjectTable(objects);
+    
+    size_t fromObjects = 0;
+    for (const RobotCoordinates& c : findRobotObjects(objects)) {
+        if (robotsFound.insert(c.robotId).second) {
+            std::cout << "  Heap #" << c.scriptId << ": objet → Robot #" << c.robotId
+                     << " @ (" << c.x << ", " << c.y << ")"
+                     << " [Pri:" << c.priority << "]\n";
+            allCoords.push_back(c);
+            fromObjects++;
+        }
+    }
+    
     std::cout << "\n✅ " << scriptsWithRobot << " script(s) avec appels kRobot\n";
+    if (fromObjects > 0) {
+        std::cout << "✅ " << fromObjects << " robot(s) supplémentaire(s) depuis les objets HEAP\n";
+    }
     std::cout << "📊 Total: " << allCoords.size() << " coordonnée(s) Robot extraite(s)\n";
     
     return allCoords;
@@ -751,32 +901,29 @@ bool RESSCIParser::exportResourcesList(const std::string& outputPath) {
     file << "=================================================================\n";
     file << "LISTE DES RESSOURCES SIERRA SCI - RESMAP/RESSCI\n";
     file << "=================================================================\n";
-    file << "Total ressources indexées: " << m_resourceIndex.size() << "\n";
-    file << "Volumes RESSCI chargés: " << m_ressciData.size() << "\n";
+    file << "Total ressources indexées: " << m_index.size() << "\n";
+    file << "Volumes RESSCI chargés: " << m_volumes.size() << "\n";
     file << "=================================================================\n\n";
     
-    // Compter par type
-    std::map<ResourceType, int> countByType;
-    for (const auto& entry : m_resourceIndex) {
-        countByType[entry.first.first]++;
-    }
-    
-    // Résumé par type
+    // Résumé par type (plages contiguës de l'index)
     file << "RÉSUMÉ PAR TYPE DE RESSOURCE:\n";
     file << "-----------------------------------------------------------------\n";
-    for (const auto& count : countByType) {
-        file << getResourceTypeName(count.first) 
-             << " (0x" << std::hex << (int)count.first << std::dec << "): "
-             << count.second << " ressource(s)\n";
+    for (int t = 0; t < 256; t++) {
+        ResourceType type = static_cast<ResourceType>(t);
+        size_t count = m_index.ofType(type).size();
+        if (count == 0) continue;
+        file << getResourceTypeName(type) 
+             << " (0x" << std::hex << t << std::dec << "): "
+             << count << " ressource(s)\n";
     }
     file << "\n=================================================================\n\n";
     
     // Liste détaillée par type
     ResourceType currentType = RT_INVALID;
-    for (const auto& entry : m_resourceIndex) {
-        ResourceType type = entry.first.first;
-        uint32_t number = entry.first.second;
-        uint32_t offset = entry.second;
+    for (const ResourceIndex::Entry& entry : m_index.all()) {
+        ResourceType type = entry.type;
+        uint32_t number = entry.number;
+        uint32_t offset = entry.offset;
         
         // Nouvelle section de type
         if (type != currentType) {
@@ -786,12 +933,7 @@ bool RESSCIParser::exportResourcesList(const std::string& outputPath) {
             file << "-----------------------------------------------------------------\n";
         }
         
-        // Trouver le volume
-        uint8_t volume = 0;
-        auto volIt = m_resourceVolumes.find(entry.first);
-        if (volIt != m_resourceVolumes.end()) {
-            volume = volIt->second;
-        }
+        uint8_t volume = entry.volume;
         
         file << "  " << number 
              << " -> Offset: " << offset 
@@ -820,81 +962,40 @@ std::vector<RobotCoordinates> RESSCIParser::parseScriptForRobotCalls(
     
     if (scriptData.size() < 20) return coords;
     
-    // Opcodes SCI32 (format réel selon ScummVM)
-    const uint8_t OP_PUSHI = 0x38;      // Push immediate 16-bit value
-    const uint8_t OP_CALLK = 0x76;      // Call kernel (format: 0x76 kernelId argc)
+    // Désassemblage linéaire du bytecode + pile abstraite : seuls les appels
+    // `callk Robot` dont argc est vérifié sont retenus, avec leurs arguments
+    // littéraux exacts (pushi/push0/push1/push2/ldi+push)
+    std::vector<KernelCall> calls = findKernelCalls(
+        scriptData.data(), scriptData.size(),
+        scriptCodeStart(scriptData.data(), scriptData.size()),
+        m_robotKernelIds);
     
-    // Scanner le bytecode pour CALLK avec différents kernel IDs possibles pour Robot
-    // Kernel ID peut varier selon version SCI, on cherche patterns connus
-    for (size_t i = 0; i < scriptData.size() - 15; i++) {
-        // Chercher CALLK (0x76)
-        if (scriptData[i] != OP_CALLK) continue;
-        
-        // Vérifier qu'on a assez de bytes pour lire kernelId + argc
-        if (i + 3 >= scriptData.size()) continue;
-        
-        // Format: 0x76 <kernelId> <argc>
-        uint8_t kernelId = scriptData[i + 1];
-        uint8_t argc = scriptData[i + 2];
-        
-        // Kernel IDs Robot observés dans Phantasmagoria: 57, 67, 74, 84
-        // Filtrer pour réduire les faux positifs
-        const std::set<uint8_t> robotKernelIds = {57, 67, 74, 84};
-        if (robotKernelIds.find(kernelId) == robotKernelIds.end()) continue;
-        
-        // On cherche argc=4 à 6 (robotId, x, y, priority, [palette], [extra])
-        if (argc < 4 || argc > 6) continue;
-        
-        // Chercher les PUSHI en arrière (arguments empilés avant CALLK)
-        std::vector<int16_t> params;
-        
-        // Scanner jusqu'à 50 bytes en arrière
-        for (int back = std::min<int>(i, 50); back > 0; back--) {
-            size_t pos = i - back;
-            
-            if (scriptData[pos] == OP_PUSHI && pos + 3 <= scriptData.size()) {
-                int16_t value = (int16_t)readLE16(&scriptData[pos + 1]);
-                params.push_back(value);
-                
-                // On a assez de params
-                if (params.size() >= argc) break;
-            }
-        }
-        
-        // Vérifier qu'on a au moins 3 params (robotId, x, y)
-        if (params.size() < 3) continue;
-        
-        // Les params sont empilés dans l'ordre: robotId, x, y, priority...
-        // Donc le premier PUSHI trouvé en arrière est le dernier argument
-        // Il faut inverser pour avoir l'ordre correct
-        std::reverse(params.begin(), params.end());
+    for (const KernelCall& call : calls) {
+        const std::vector<StackValue>& args = call.args;
         
-        // Debug: afficher tous les params pour comprendre l'ordre
-        if (scriptId == 90 || scriptId == 91 || scriptId == 161 || scriptId == 162 || scriptId == 170 || scriptId == 260 ||
-            scriptId == 1800 || scriptId == 22100) {
-            std::cout << "      DEBUG params (reversed): ";
-            for (size_t p = 0; p < params.size(); p++) {
-                std::cout << params[p];
-                if (p < params.size() - 1) std::cout << ", ";
+#ifdef ROBOT_DEBUG_LOGS
+        // Trace : tous les arguments de l'appel ('?' = valeur non littérale)
+        if (Log::enabled(Log::Level::Trace, Log::Category::Ressci)) {
+            std::string list;
+            for (size_t p = 0; p < args.size(); p++) {
+                list += args[p].known ? std::to_string(args[p].value) : std::string("?");
+                if (p < args.size() - 1) list += ", ";
             }
-            std::cout << std::endl;
+            LOG_TRACE(Ressci, "      script %u kernel %u args: %s\n", scriptId, (unsigned)call.kernelId, list.c_str());
         }
+#endif
         
-        // Ordre des paramètres kRobotOpen: robotId, plane, priority, x, y, scale
-        // params[0] = robotId
-        // params[1] = plane (objet, pas une coordonnée)
-        // params[2] = priority
-        // params[3] = x ← coordonnée X
-        // params[4] = y ← coordonnée Y
-        // params[5] = scale (optionnel)
+        // kRobot(0 = Open, robotId, plane, priority, x, y, [scale])
+        // args[2] = plane (objet, pas une coordonnée)
+        if (args.size() < 6 || args.size() > 7) continue;
+        if (!args[0].known || args[0].value != 0) continue;
+        if (!args[1].known || !args[4].known || !args[5].known) continue;
         
-        if (params.size() < 5) continue;  // Besoin d'au moins robotId, plane, priority, x, y
-        
-        int16_t robotId = params[0];
-        int16_t x = params[3];  // Position X (4ème paramètre)
-        int16_t y = params[4];  // Position Y (5ème paramètre)
-        int16_t priority = params[2];
-        int16_t scale = (params.size() >= 6) ? params[5] : 128;
+        int16_t robotId = args[1].value;
+        int16_t x = args[4].value;
+        int16_t y = args[5].value;
+        int16_t priority = args[3].known ? args[3].value : 0;
+        int16_t scale = (args.size() == 7 && args[6].known) ? args[6].value : 128;
         
         // Canvas Phantasmagoria: 640×480 pixels (mais peut être 630×450 en pratique)
         // Accepter coordonnées négatives (robots hors écran)
@@ -912,70 +1013,98 @@ std::vector<RobotCoordinates> RESSCIParser::parseScriptForRobotCalls(
             
             coords.push_back(rc);
             
-            // Debug: afficher ce qu'on a trouvé
-            std::cout << "    [Script " << scriptId << " offset 0x" << std::hex << i << std::dec 
-                      << "] CALLK Robot argc=" << (int)argc
-                      << " → Robot #" << robotId << " @ (" << x << ", " << y << ")"
-                      << " priority=" << priority << " scale=" << scale << std::endl;
+            LOG_DEBUG(Ressci, "    [Script %u offset 0x%x] callk %u argc=%zu → Robot #%d @ (%d, %d) priority=%d scale=%d\n",
+                      scriptId, (unsigned)call.offset, (unsigned)call.kernelId, args.size(),
+                      robotId, x, y, priority, scale);
         }
     }
     
     return coords;
 }
 
-std::vector<RobotCoordinates> RESSCIParser::parseHeapForCoordinates(
-    const std::vector<uint8_t>& heapData,
-    uint32_t scriptId)
-{
-    std::vector<RobotCoordinates> coords;
+std::vector<ScriptObject> RESSCIParser::loadScriptObjects(uint16_t scriptNumber, const ResourceInfo& script) {
+    std::vector<ScriptObject> objects;
+    
+    // SCI1.1/SCI32 : les objets sont dans le HEAP de même numéro que le script
+    std::shared_ptr<const ResourceInfo> heap = getResource(RT_HEAP, scriptNumber);
+    if (!heap || heap->data.empty()) {
+        return objects;
+    }
+    
+    if (!parseScriptObjects(scriptNumber, script.data.data(), script.data.size(),
+                            heap->data.data(), heap->data.size(), objects)) {
+        LOG_DEBUG(Ressci, "    [Heap %u] disposition d'objets invalide après %zu objet(s)\n",
+                  (unsigned)scriptNumber, objects.size());
+    }
+    return objects;
+}
+
+void RESSCIParser::finalizeObjectTable(ObjectTable& table) {
+    // VOCAB 997 : noms des sélecteurs (sans lui, requêtes par numéro seulement)
+    std::shared_ptr<const ResourceInfo> names = getResource(RT_VOCAB, 997);
+    if (names && !names->data.empty()) {
+        if (!table.loadSelectorNames(names->data.data(), names->data.size())) {
+            LOG_WARNING(Ressci, "VOCAB 997 (noms de sélecteurs) invalide\n");
+        }
+    }
+    table.finalize();
+}
+
+bool RESSCIParser::loadObjectTable(ObjectTable& table, unsigned jobs) {
+    ResourceIndex::Range range = m_index.ofType(RT_SCRIPT);
+    std::vector<std::vector<ScriptObject>> objectsByScript(range.size());
+    
+    Parallel::parallelFor(range.size(), jobs > 0 ? jobs : Parallel::defaultJobCount(), [&](size_t i) {
+        std::shared_ptr<const ResourceInfo> script = getResource(RT_SCRIPT, range[i].number);
+        if (script && !script->data.empty()) {
+            objectsByScript[i] = loadScriptObjects(static_cast<uint16_t>(range[i].number), *script);
+        }
+    });
     
-    if (heapData.size() < 20) return coords;
+    for (auto& objects : objectsByScript) {
+        table.addObjects(std::move(objects));
+    }
+    finalizeObjectTable(table);
+    return !table.objects().empty();
+}
+
+std::vector<RobotCoordinates> RESSCIParser::findRobotObjects(const ObjectTable& table) {
+    std::vector<RobotCoordinates> coords;
     
-    // Dans le HEAP, chercher des paires de valeurs qui pourraient être des coordonnées
-    // Résolution Phantasmagoria: 630x450
+    static const char* const kRobotIdSelectors[] = {"robot", "robotNum", "number"};
     
-    for (size_t i = 0; i < heapData.size() - 10; i += 2) {
-        if (i + 4 > heapData.size()) break;
+    for (const ScriptObject* object : table.findObjectsWith({"x", "y"})) {
+        if (!table.inheritsFromName(*object, "robot")) {
+            continue;
+        }
+        
+        int16_t robotId = 0;
+        for (const char* selector : kRobotIdSelectors) {
+            if (table.getProperty(*object, selector, robotId) && robotId > 0) {
+                break;
+            }
+        }
         
-        int16_t val1 = readSLE16(&heapData[i]);
-        int16_t val2 = readSLE16(&heapData[i + 2]);
+        int16_t x = 0, y = 0, priority = 0, scale = 128;
+        table.getProperty(*object, "x", x);
+        table.getProperty(*object, "y", y);
+        table.getProperty(*object, "priority", priority);
+        table.getProperty(*object, "scaleX", scale);
         
-        // Vérifier si ce sont des coordonnées plausibles
-        if (val1 >= 0 && val1 <= 630 && val2 >= 0 && val2 <= 450) {
-            // Chercher un Robot ID à proximité
-            // Format typique: [robotId(2), ..., x(2), y(2)]
+        // Mêmes bornes que pour les appels kRobot
+        if (robotId > 0 && robotId < 10000 &&
+            x >= -100 && x <= 740 && y >= -100 && y <= 580) {
+            RobotCoordinates rc;
+            rc.robotId = robotId;
+            rc.x = x;
+            rc.y = y;
+            rc.priority = priority;
+            rc.scale = scale;
+            rc.scriptId = object->script;
+            coords.push_back(rc);
             
-            for (size_t j = (i > 20 ? i - 20 : 0); j < i; j += 2) {
-                if (j + 2 > heapData.size()) break;
-                
-                int16_t potentialId = readSLE16(&heapData[j]);
-                
-                // Les Robot IDs sont généralement entre 1 et 10000
-                if (potentialId > 0 && potentialId < 10000) {
-                    // Vérifier qu'il n'y a pas de valeurs aberrantes entre
-                    bool valid = true;
-                    for (size_t k = j + 2; k < i; k += 2) {
-                        int16_t intermediate = readSLE16(&heapData[k]);
-                        // Les valeurs intermédiaires doivent être raisonnables
-                        if (intermediate < -1000 || intermediate > 10000) {
-                            valid = false;
-                            break;
-                        }
-                    }
-                    
-                    if (valid) {
-                        RobotCoordinates rc;
-                        rc.robotId = potentialId;
-                        rc.x = val1;
-                        rc.y = val2;
-                        rc.priority = 0;
-                        rc.scale = 128;
-                        rc.scriptId = scriptId;
-                        coords.push_back(rc);
-                        break;
-                    }
-                }
-            }
+            LOG_DEBUG(Ressci, "    [Heap %u] objet %s → Robot #%d @ (%d, %d) priority=%d\n",
+                      (unsigned)object->script, object->name.c_str(), robotId, x, y, priority);
         }
     }
     
@@ -2,9 +2,9 @@
  * @file ressci_parser.h
  * @brief Parser universel pour fichiers RESSCI/RESMAP de Sierra SCI
  * 
- * Supporte la détection automatique de formats :
- * - Format 6 octets (SCI1.1 / variantes et démos)
- * - Format 9 octets (SCI32 standard - Phantasmagoria CD original)
+ * Supporte la détection automatique de formats (voir resmap_reader.h) :
+ * - Table d'indirection, entrées de 5 octets (SCI1.1 / SCI2) ou 6 octets (SCI1 late)
+ * - Liste plate de 9 octets (SCI32)
  * 
  * Basé sur les spécifications ScummVM et SCI Wiki
  * Testé sur Phantasmagoria CD1-7 et variantes
@@ -22,6 +22,11 @@
 #include <set>
 #include <string>
 #include <memory>
+#include <mutex>
+#include "../utils/lru_cache.h"
+#include "resource_catalog.h"
+#include "sci_objects.h"
+#include "../utils/mapped_file.h"
 
 namespace SCI {
 
@@ -76,37 +81,6 @@ enum CompressionMethod : uint8_t {
     CM_STACPACK   = 0x7B,  // STACpack (RFC 1974) - SCI32, utilisé par Phantasmagoria
 };
 
-/**
- * @brief Entrée RESMAP format 6 octets (SCI1.1 / variantes)
- * Format: type[1B] + number[2B LE] + offset[3B LE]
- * Utilisé par certaines versions/démos de Phantasmagoria
- */
-#pragma pack(push, 1)
-struct ResMapEntry6 {
-    uint8_t  type;            // Type de ressource (0x80-0x91)
-    uint16_t resourceNumber;  // Numéro de ressource (2 octets, LE, < 65536)
-    uint8_t  offset_bytes[3]; // Offset sur 3 octets (LE, max 16 MB)
-    
-    uint32_t getOffset() const {
-        return offset_bytes[0] | (offset_bytes[1] << 8) | (offset_bytes[2] << 16);
-    }
-};
-#pragma pack(pop)
-
-/**
- * @brief Entrée RESMAP format 9 octets (SCI32 standard - Phantasmagoria CD original)
- * Format: type[1B] + number[4B LE] + offset[4B LE]
- * Les entrées sont triées par type (croissant), puis par numéro (croissant)
- * TESTÉ sur Phantasmagoria CD1-7 : 12847 entrées pour CD1
- */
-#pragma pack(push, 1)
-struct ResMapEntry9 {
-    uint8_t  type;            // Type de ressource (0x80-0x91, 1 octet)
-    uint32_t resourceNumber;  // Numéro de ressource (4 octets, little-endian)
-    uint32_t offset;          // Offset absolu dans RESSCI.00X (4 octets, LE)
-};
-#pragma pack(pop)
-
 /**
  * @brief Header de ressource dans RESSCI.00X (14 octets pour SCI32)
  */
@@ -137,6 +111,36 @@ struct ResourceInfo {
     std::vector<uint8_t> data;// Données décompressées
 };
 
+/**
+ * @brief Données d'une ressource sans copie superflue
+ *
+ * Ressource non compressée (CM_NONE) : vue directe dans le volume projeté,
+ * valide tant que le parser existe et que le volume n'est pas réenregistré.
+ * Ressource compressée : tampon propre, décompressé en place.
+ */
+class ResourceView {
+public:
+    const uint8_t* data() const { return m_mapped ? m_mapped : m_buffer.data(); }
+    size_t size() const { return m_mapped ? m_mappedSize : m_buffer.size(); }
+    bool empty() const { return size() == 0; }
+    
+    /** @brief Vrai si les données pointent dans le volume (aucune copie) */
+    bool isZeroCopy() const { return m_mapped != nullptr; }
+    
+    /** @brief Copie (vue) ou transfert (tampon) vers un vecteur */
+    std::vector<uint8_t> release() {
+        if (m_mapped) return std::vector<uint8_t>(m_mapped, m_mapped + m_mappedSize);
+        return std::move(m_buffer);
+    }
+    
+private:
+    friend class RESSCIParser;
+    
+    const uint8_t* m_mapped = nullptr;
+    size_t m_mappedSize = 0;
+    std::vector<uint8_t> m_buffer;
+};
+
 /**
  * @brief Coordonnées x,y extraites pour un Robot
  */
@@ -149,6 +153,117 @@ struct RobotCoordinates {
     uint32_t scriptId;        // Script d'où proviennent les coordonnées
 };
 
+/**
+ * @brief Index RESMAP plat : (type, numéro) -> (volume, offset)
+ *
+ * Table struct-of-arrays triée par (type, numéro), doublée d'une table de
+ * hachage à adressage ouvert (sondage linéaire) pour la recherche en O(1).
+ * Chaque type occupe une plage contiguë de la table, parcourue via des vues
+ * non propriétaires (Range) sans copie.
+ *
+ * Les insertions s'accumulent puis finalize() trie, dédoublonne (la dernière
+ * insertion d'une clé l'emporte) et reconstruit le hachage. Recherches et
+ * parcours ne sont valides qu'après finalize().
+ */
+class ResourceIndex {
+public:
+    struct Entry {
+        ResourceType type;
+        uint32_t number;
+        uint8_t volume;
+        uint32_t offset;
+    };
+    
+    /**
+     * @brief Vue non propriétaire sur une plage [begin, end) de l'index
+     * Invalidée par toute insertion suivie de finalize().
+     */
+    class Range {
+    public:
+        class iterator {
+        public:
+            iterator(const ResourceIndex* index, size_t pos) : m_index(index), m_pos(pos) {}
+            Entry operator*() const { return m_index->at(m_pos); }
+            iterator& operator++() { ++m_pos; return *this; }
+            bool operator==(const iterator& other) const { return m_pos == other.m_pos; }
+            bool operator!=(const iterator& other) const { return m_pos != other.m_pos; }
+        private:
+            const ResourceIndex* m_index;
+            size_t m_pos;
+        };
+        
+        Range(const ResourceIndex* index, size_t begin, size_t end)
+            : m_index(index), m_begin(begin), m_end(end) {}
+        
+        iterator begin() const { return iterator(m_index, m_begin); }
+        iterator end() const { return iterator(m_index, m_end); }
+        size_t size() const { return m_end - m_begin; }
+        bool empty() const { return m_begin == m_end; }
+        Entry operator[](size_t i) const { return m_index->at(m_begin + i); }
+        
+    private:
+        const ResourceIndex* m_index;
+        size_t m_begin;
+        size_t m_end;
+    };
+    
+    static constexpr size_t npos = static_cast<size_t>(-1);
+    
+    /** @brief Ajoute (ou remplace, après finalize) une ressource */
+    void insert(ResourceType type, uint32_t number, uint8_t volume, uint32_t offset);
+    
+    /** @brief Trie, dédoublonne et reconstruit le hachage et les plages par type */
+    void finalize();
+    
+    /** @brief Reprend des colonnes déjà triées et sans doublon (catalogue) : seules les tables de recherche sont reconstruites */
+    void assignSorted(std::vector<uint8_t> types, std::vector<uint32_t> numbers,
+                      std::vector<uint8_t> volumes, std::vector<uint32_t> offsets);
+    
+    void clear();
+    
+    /**
+     * @brief Recherche en O(1)
+     * @return Position dans l'index, npos si absente
+     */
+    size_t find(ResourceType type, uint32_t number) const;
+    
+    Entry at(size_t pos) const {
+        return Entry{static_cast<ResourceType>(m_types[pos]), m_numbers[pos], m_volumes[pos], m_offsets[pos]};
+    }
+    
+    uint32_t offsetAt(size_t pos) const { return m_offsets[pos]; }
+    uint8_t volumeAt(size_t pos) const { return m_volumes[pos]; }
+    
+    /** @brief Toutes les ressources, triées par (type, numéro) */
+    Range all() const { return Range(this, 0, m_types.size()); }
+    
+    /** @brief Ressources d'un type, triées par numéro */
+    Range ofType(ResourceType type) const {
+        if (m_typeStart.empty()) return Range(this, 0, 0);
+        return Range(this, m_typeStart[type], m_typeStart[type + 1]);
+    }
+    
+    size_t size() const { return m_types.size(); }
+    bool empty() const { return m_types.empty(); }
+    
+private:
+    // Colonnes (struct-of-arrays), triées par (type, numéro) après finalize()
+    std::vector<uint8_t> m_types;
+    std::vector<uint32_t> m_numbers;
+    std::vector<uint8_t> m_volumes;
+    std::vector<uint32_t> m_offsets;
+    
+    // Plages par type et table de hachage, d'après les colonnes triées
+    void buildLookup();
+    
+    // Hachage : position + 1 dans les colonnes, 0 = case vide
+    std::vector<uint32_t> m_slots;
+    uint32_t m_slotMask = 0;
+    
+    // Plage du type t : [m_typeStart[t], m_typeStart[t + 1])
+    std::vector<uint32_t> m_typeStart;
+};
+
 /**
  * @brief Parser pour fichiers RESSCI/RESMAP
  */
@@ -162,10 +277,15 @@ public:
         RES_FORMAT_SCI1_LATE = 1, // SCI1 Late (6 bytes: number[2B] + offset[4B])
         RES_FORMAT_SCI11 = 2,     // SCI1.1 (5 bytes: number[2B] + offset[3B])
         FORMAT_6_BYTES = RES_FORMAT_SCI1_LATE,  // Alias pour compatibilité
-        FORMAT_9_BYTES = 3,       // SCI32 (9 bytes - non utilisé dans ce code)
+        FORMAT_9_BYTES = 3,       // SCI32 (9 bytes: type[1B] + number[4B] + offset[4B])
         FORMAT_UNKNOWN = RES_FORMAT_UNKNOWN    // Alias
     };
     
+    /**
+     * @brief Cache des ressources décompressées, clé (type << 32) | numéro
+     */
+    using ResourceCache = Common::LruCache<uint64_t, ResourceInfo>;
+    
     RESSCIParser();
     ~RESSCIParser();
     
@@ -178,19 +298,43 @@ public:
     bool loadResMap(const std::string& path, uint8_t volumeNumber = 1);
     
     /**
-     * @brief Détecte automatiquement le format du RESMAP chargé
-     * @return Format détecté (6 ou 9 octets)
+     * @brief Format du dernier RESMAP chargé
+     * @return Format détecté (5, 6 ou 9 octets), FORMAT_UNKNOWN si aucun
      */
     ResMapFormat detectFormat() const;
     
     /**
-     * @brief Charge un fichier RESSCI.00X
+     * @brief Enregistre un fichier RESSCI.00X
+     *
+     * Le volume n'est pas lu ici : il est projeté en mémoire (lecture seule)
+     * au premier accès à l'une de ses ressources.
+     *
      * @param path Chemin vers RESSCI.00X
      * @param volumeNumber Numéro du volume (1-7)
-     * @return true si succès
+     * @return true si le fichier existe et est lisible
      */
     bool loadRessci(const std::string& path, uint8_t volumeNumber);
     
+    /**
+     * @brief Charge l'index et les en-têtes résolus depuis un catalogue binaire
+     *
+     * Remplace loadResMap()/loadRessci() : les volumes RESSCI du catalogue
+     * sont enregistrés, aucun RESMAP n'est relu et le format des en-têtes
+     * RESSCI n'est plus redeviné à chaque extraction.
+     *
+     * @param resourceDir Si non vide, le catalogue doit décrire ce répertoire
+     * @return false si le catalogue est absent, invalide ou périmé
+     */
+    bool loadCatalog(const std::string& path, const std::string& resourceDir = "");
+    
+    /**
+     * @brief Écrit le catalogue des RESMAP/RESSCI chargés
+     *
+     * L'en-tête de chaque ressource est résolu une fois (format, tailles,
+     * méthode) ; le catalogue est invalidé dès qu'une source change.
+     */
+    bool saveCatalog(const std::string& path);
+    
     /**
      * @brief Extrait une ressource par type et numéro
      * @param type Type de ressource
@@ -199,18 +343,79 @@ public:
      */
     ResourceInfo extractResource(ResourceType type, uint32_t number);
     
+    /**
+     * @brief Extrait une ressource sans copier les données compressées
+     *
+     * Les décompresseurs lisent directement le volume projeté et écrivent dans
+     * un tampon dimensionné d'après l'en-tête ; CM_NONE ne copie rien.
+     *
+     * @param info Rempli avec l'en-tête de la ressource (info.data reste vide)
+     * @param view Données de la ressource
+     * @return true si la ressource a été trouvée et décodée
+     */
+    bool extractResourceView(ResourceType type, uint32_t number, ResourceInfo& info, ResourceView& view);
+    
+    /**
+     * @brief Ressource décompressée partagée, servie par le cache s'il est actif
+     *
+     * Appelable depuis plusieurs threads : une ressource déjà décompressée par
+     * un autre consommateur est rendue sans copie, et reste valide même si le
+     * cache l'évince ensuite.
+     *
+     * @return nullptr si la ressource est introuvable ou illisible
+     */
+    std::shared_ptr<const ResourceInfo> getResource(ResourceType type, uint32_t number);
+    
+    /**
+     * @brief Active le cache des ressources décompressées (LRU)
+     * @param bytes Budget en octets (0 = cache désactivé, par défaut)
+     */
+    void setCacheBudget(size_t bytes) { m_cache.setBudget(bytes); }
+    
+    /** @brief Compteurs du cache (succès, échecs, évictions, occupation) */
+    ResourceCache::Stats cacheStats() const { return m_cache.stats(); }
+    
     /**
      * @brief Extrait toutes les ressources d'un type donné
+     *
+     * Les ressources sont décompressées en parallèle ; le résultat est trié
+     * par numéro quel que soit le nombre de threads.
+     *
      * @param type Type de ressource à extraire
+     * @param jobs Nombre de threads (0 = un par cœur)
      * @return Vecteur de ressources
      */
-    std::vector<ResourceInfo> extractAllResourcesOfType(ResourceType type);
+    std::vector<ResourceInfo> extractAllResourcesOfType(ResourceType type, unsigned jobs = 0);
     
     /**
      * @brief Extrait les coordonnées Robot depuis les scripts
+     *
+     * Chaque script est décompressé puis analysé sur un pool de threads ; les
+     * coordonnées sont fusionnées dans l'ordre des numéros de script.
+     *
+     * @param jobs Nombre de threads (0 = un par cœur)
      * @return Vecteur de coordonnées trouvées
      */
-    std::vector<RobotCoordinates> extractRobotCoordinates();
+    std::vector<RobotCoordinates> extractRobotCoordinates(unsigned jobs = 0);
+    
+    /**
+     * @brief Charge les objets (classes et instances) de tous les scripts
+     *
+     * Chaque paire SCRIPT/HEAP est lue en parallèle ; la table est finalisée
+     * et interrogeable par nom de sélecteur si VOCAB 997 est présent.
+     *
+     * @param jobs Nombre de threads (0 = un par cœur)
+     * @return false si aucun objet n'a été trouvé
+     */
+    bool loadObjectTable(ObjectTable& table, unsigned jobs = 0);
+    
+    /**
+     * @brief Numéros des kernels Robot recherchés dans les scripts
+     *
+     * Le numéro de kRobot dépend de la table kernel de l'interpréteur ; par
+     * défaut, les valeurs observées sur Phantasmagoria {57, 67, 74, 84}.
+     */
+    void setRobotKernelIds(const std::vector<uint16_t>& kernelIds) { m_robotKernelIds = kernelIds; }
     
     /**
      * @brief Exporte la liste de toutes les ressources indexées dans un fichier texte
@@ -221,10 +426,10 @@ public:
     
     /**
      * @brief Obtient toutes les ressources indexées
-     * @return Map des ressources (type, number) -> offset
+     * @return Index (type, number) -> (volume, offset), parcouru par ofType()/all()
      */
-    const std::map<std::pair<ResourceType, uint32_t>, uint32_t>& getResourceIndex() const {
-        return m_resourceIndex;
+    const ResourceIndex& getResourceIndex() const {
+        return m_index;
     }
     
     /**
@@ -240,6 +445,22 @@ public:
         uint32_t decompressedSize
     );
     
+    /**
+     * @brief Décompresse dans un tampon fourni par l'appelant
+     * @param data Données compressées
+     * @param size Taille des données compressées
+     * @param method Méthode de compression
+     * @param out Tampon de sortie de outSize octets (taille décompressée attendue)
+     * @param produced Octets écrits dans out
+     * @return false si la méthode n'est pas supportée ou si le flux est invalide
+     */
+    static bool decompressInto(
+        const uint8_t* data, size_t size,
+        CompressionMethod method,
+        uint8_t* out, size_t outSize,
+        size_t& produced
+    );
+    
     /**
      * @brief Obtient le nom d'un type de ressource
      * @param type Type de ressource
@@ -256,10 +477,23 @@ public:
 
 private:
     /**
-     * @brief Parse le header RESMAP et construit l'index
+     * @brief Décode un RESMAP (resmap_reader) et l'ajoute à l'index
      * @return true si succès
      */
-    bool parseResMapHeader();
+    bool parseResMap(const uint8_t* data, size_t size);
+    
+    /** @brief Note un RESMAP/RESSCI chargé comme source du catalogue */
+    void addSource(const std::string& path, bool isMap, uint8_t volumeNumber);
+    
+    /**
+     * @brief Lit l'en-tête RESSCI à info.offset (SCI2.1 13 octets ou SCI1.1 6/10 octets)
+     * @param info Complété avec tailles et méthode
+     * @param headerSize Taille de l'en-tête lu
+     * @return false si l'offset est hors du volume
+     */
+    static bool readResourceHeader(ResourceType type,
+                                   const uint8_t* volumeBytes, size_t volumeSize,
+                                   ResourceInfo& info, size_t& headerSize);
     
     /**
      * @brief Parse un script pour trouver les appels kRobot
@@ -273,25 +507,44 @@ private:
     );
     
     /**
-     * @brief Parse la section HEAP d'un script pour trouver les propriétés d'objets
-     * @param heapData Données HEAP décompressées
-     * @param scriptId ID du script
-     * @return Coordonnées trouvées dans le HEAP
+     * @brief Objets SCRIPT/HEAP d'un script (vide si le HEAP est absent ou invalide)
      */
-    std::vector<RobotCoordinates> parseHeapForCoordinates(
-        const std::vector<uint8_t>& heapData,
-        uint32_t scriptId
-    );
+    std::vector<ScriptObject> loadScriptObjects(uint16_t scriptNumber, const ResourceInfo& script);
     
-    // Méthodes de décompression spécifiques
-    static std::vector<uint8_t> decompressRLE(const std::vector<uint8_t>& data, uint32_t decompSize);
-    static std::vector<uint8_t> decompressHuffman(const std::vector<uint8_t>& data, uint32_t decompSize);
-    static std::vector<uint8_t> decompressLZ(const std::vector<uint8_t>& data, uint32_t decompSize);
-    static std::vector<uint8_t> decompressSTACpack(const std::vector<uint8_t>& data, uint32_t decompSize);
+    /**
+     * @brief Complète la table avec les noms de sélecteurs (VOCAB 997) et la finalise
+     */
+    void finalizeObjectTable(ObjectTable& table);
+    
+    /**
+     * @brief Coordonnées Robot portées par des propriétés d'objets
+     *
+     * Objets dont le nom (ou celui d'un ancêtre) contient "robot" et qui
+     * possèdent les propriétés x, y et un numéro de robot (robot / robotNum
+     * / number) ; priority et scaleX sont lus s'ils existent.
+     */
+    static std::vector<RobotCoordinates> findRobotObjects(const ObjectTable& table);
+    
+    /**
+     * @brief Volume RESSCI projeté (projection au premier appel, thread-safe)
+     * @return nullptr si le volume n'est pas enregistré ou illisible
+     */
+    const Common::MappedFile* getVolume(uint8_t volumeNumber);
+    
+    // Méthodes de décompression spécifiques : (entrée, taille) -> tampon prédimensionné,
+    // retournent le nombre d'octets écrits (-1 si erreur)
+    static int64_t decompressRLE(const uint8_t* data, size_t size, uint8_t* out, size_t outSize);
+    static int64_t decompressHuffman(const uint8_t* data, size_t size, uint8_t* out, size_t outSize);
+    static int64_t decompressLZ(const uint8_t* data, size_t size, uint8_t* out, size_t outSize);
+    static int64_t decompressSTACpack(const uint8_t* data, size_t size, uint8_t* out, size_t outSize);
     
 private:
-    // Données RESMAP chargées
-    std::vector<uint8_t> m_resMapData;
+    // RESMAP/RESSCI chargés, dans l'ordre (sources du catalogue)
+    std::vector<CatalogSource> m_sources;
+    
+    // Catalogue projeté : en-têtes résolus dans l'ordre de m_index (nullptr sans catalogue)
+    ResourceCatalog m_catalog;
+    const CatalogEntry* m_resolved = nullptr;
     
     // Numéro de volume courant lors du parsing RESMAP
     uint8_t m_currentVolume;
@@ -299,17 +552,27 @@ private:
     // Format RESMAP détecté (6 ou 9 octets)
     ResMapFormat m_detectedFormat;
     
-    // Index: (type, number) -> offset dans RESSCI (SCI32 utilise uint32)
-    std::map<std::pair<ResourceType, uint32_t>, uint32_t> m_resourceIndex;
+    // Index: (type, number) -> (volume, offset dans RESSCI)
+    ResourceIndex m_index;
+    
+    // Volumes RESSCI enregistrés, projetés à la demande
+    struct Volume {
+        std::string path;
+        std::unique_ptr<Common::MappedFile> file;  // nullptr tant que non projeté
+        bool failed = false;
+    };
+    std::map<uint8_t, Volume> m_volumes;
+    std::mutex m_volumeMutex;
     
-    // Données RESSCI chargées par volume
-    std::map<uint8_t, std::vector<uint8_t>> m_ressciData;
+    // Ressources décompressées (budget fixé par les outils de scan et de listage)
+    ResourceCache m_cache;
     
-    // Mapping: (type, number) -> volume
-    std::map<std::pair<ResourceType, uint32_t>, uint8_t> m_resourceVolumes;
+    // Kernels kRobot recherchés par parseScriptForRobotCalls
+    std::vector<uint16_t> m_robotKernelIds = {57, 67, 74, 84};
     
     // Suivi des méthodes de compression non supportées (pour éviter le spam)
     static std::set<uint8_t> s_unsupportedMethodsLogged;
+    static std::mutex s_unsupportedMethodsMutex;
 };
 
 } // namespace SCI
@@ -0,0 +1,243 @@
+#include "robot_cel.h"
+#include <algorithm>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#include "formats/decompressor_lzs.h"
+#include "utils/log.h"
+#include "utils/memstream.h"
+#include "utils/sci_util.h"
+#include "utils/perf_stats.h"
+
+namespace ScummVMRobot {
+
+// Types de compression des chunks de cel
+static const uint16_t kCompressionLZS = 0;
+static const uint16_t kCompressionNone = 2;
+
+bool readCelHeader(const uint8_t *rawCel, size_t available, RobotCel& out) {
+    if (!rawCel || available < kCelHeaderSize) {
+        return false;
+    }
+    out.horizontalScale = rawCel[0];
+    out.verticalScale = rawCel[1];
+    out.width = SciHelpers::READ_SCI11ENDIAN_UINT16(rawCel + 2);
+    out.height = SciHelpers::READ_SCI11ENDIAN_UINT16(rawCel + 4);
+    out.celX = SciHelpers::READ_SCI11ENDIAN_UINT16(rawCel + 10);
+    out.celY = SciHelpers::READ_SCI11ENDIAN_UINT16(rawCel + 12);
+    out.dataSize = SciHelpers::READ_SCI11ENDIAN_UINT16(rawCel + 14);
+    out.numDataChunks = (int16_t)SciHelpers::READ_SCI11ENDIAN_UINT16(rawCel + 16);
+    return true;
+}
+
+void expandCelVertically(const uint8_t *src, size_t srcSize, uint16_t width,
+                         int sourceHeight, uint16_t height, uint8_t *dst) {
+    if (sourceHeight <= 0) sourceHeight = 1;
+    const int numerator = height;
+    const int denominator = sourceHeight;
+    int remainder = 0;
+    const uint8_t *srcPtr = src;
+    uint8_t *dstPtr = dst;
+    uint8_t *const dstEnd = dst + (size_t)width * height;
+
+    for (int y = sourceHeight - 1; y >= 0; --y) {
+        remainder += numerator;
+        int linesToDraw = remainder / denominator;
+        remainder %= denominator;
+
+        for (int l = 0; l < linesToDraw && dstPtr < dstEnd; ++l) {
+            if ((size_t)(srcPtr - src) + width <= srcSize) {
+                std::copy_n(srcPtr, width, dstPtr);
+            } else {
+                // Plus de données : ligne à 0
+                std::fill_n(dstPtr, width, 0);
+            }
+            dstPtr += width;
+        }
+        srcPtr += width;
+    }
+}
+
+uint32_t decodeRobotCel(const uint8_t *rawCel, size_t available, RobotCel& out, bool withSpans) {
+    if (!readCelHeader(rawCel, available, out)) {
+        return 0;
+    }
+
+    const uint64_t area = (uint64_t)out.width * (uint64_t)out.height;
+    if (area > 20000000) {
+        LOG_ERROR(Cel, "cel area too large (%lu), skipping\n", (unsigned long)area);
+        return 0;
+    }
+    if (kCelHeaderSize + out.dataSize > available) {
+        LOG_ERROR(Cel, "cel data truncated (%u bytes, %zu available)\n",
+                  out.dataSize, available - kCelHeaderSize);
+        return 0;
+    }
+
+    // verticalScale != 100 : les données sont "écrasées" en hauteur
+    const int verticalScaleFactor = out.verticalScale;
+    int sourceHeight = (out.height * verticalScaleFactor) / 100;
+    const size_t decompressedArea = (verticalScaleFactor == 100)
+        ? (size_t)area : (size_t)out.width * (size_t)sourceHeight;
+
+    std::vector<uint8_t> decompressed;
+    decompressed.reserve(decompressedArea);
+
+    const uint8_t *p = rawCel + kCelHeaderSize;
+    const uint8_t *end = p + out.dataSize;
+    for (int i = 0; i < out.numDataChunks; ++i) {
+        if (p + kCelChunkHeaderSize > end) {
+            LOG_ERROR(Cel, "chunk %d header truncated\n", i);
+            return 0;
+        }
+        const uint32_t compSize = SciHelpers::READ_SCI11ENDIAN_UINT32(p);
+        const uint32_t decompSize = SciHelpers::READ_SCI11ENDIAN_UINT32(p + 4);
+        const uint16_t compressionType = SciHelpers::READ_SCI11ENDIAN_UINT16(p + 8);
+        p += kCelChunkHeaderSize;
+
+        if (compSize > (size_t)(end - p) || decompSize > 20000000) {
+            LOG_ERROR(Cel, "chunk %d truncated (compSize=%u)\n", i, compSize);
+            return 0;
+        }
+
+        const size_t before = decompressed.size();
+        if (compressionType == kCompressionNone) {
+            // Copie brute
+            decompressed.insert(decompressed.end(), p, p + std::min(compSize, decompSize));
+        } else if (compressionType == kCompressionLZS) {
+            // Common::MemoryReadStream + DecompressorLZS::unpack (chemin ScummVM)
+            Perf::ScopedTimer timer(Perf::Stage::LzsDecode, compSize);
+            timer.setBytesOut(decompSize);
+            Common::MemoryReadStream mrs(p, compSize);
+            DecompressorLZS dec;
+            decompressed.resize(before + decompSize);
+            int rc = dec.unpack(&mrs, decompressed.data() + before, compSize, decompSize);
+            if (rc != 0) {
+                LOG_ERROR(Cel, "DecompressorLZS::unpack failed rc=%d\n", rc);
+                return 0;
+            }
+        } else {
+            LOG_ERROR(Cel, "Unknown compression type %u\n", compressionType);
+            return 0;
+        }
+
+        p += compSize;
+        Perf::count(Perf::Counter::Chunks);
+    }
+
+    // Pixels finaux, avec expansion verticale si nécessaire
+    out.pixels.assign((size_t)area, 0);
+    if (verticalScaleFactor == 100) {
+        if (decompressed.size() >= area) {
+            std::copy_n(decompressed.data(), (size_t)area, out.pixels.data());
+        }
+        // Sinon données tronquées : cel laissé à 0
+    } else {
+        Perf::ScopedTimer timer(Perf::Stage::VerticalExpand, decompressed.size());
+        timer.setBytesOut(out.pixels.size());
+        expandCelVertically(decompressed.data(), decompressed.size(), out.width,
+                            sourceHeight, out.height, out.pixels.data());
+    }
+    Perf::count(Perf::Counter::Cels);
+
+    if (withSpans) {
+        buildOpaqueSpans(out.pixels.data(), out.width, out.height, out.spans);
+    } else {
+        out.spans.clear();
+    }
+    return (uint32_t)(kCelHeaderSize + out.dataSize);
+}
+
+// Bloc de 16 pixels entièrement transparent / sans aucun pixel transparent
+static inline bool allSkip16(const uint8_t *p) {
+#if defined(__SSE2__)
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8((char)0xFF))) == 0xFFFF;
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    return vminvq_u8(vld1q_u8(p)) == 0xFF;
+#else
+    for (int i = 0; i < 16; ++i) {
+        if (p[i] != 0xFF) return false;
+    }
+    return true;
+#endif
+}
+
+static inline bool noSkip16(const uint8_t *p) {
+#if defined(__SSE2__)
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8((char)0xFF))) == 0;
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    return vmaxvq_u8(vceqq_u8(vld1q_u8(p), vdupq_n_u8(0xFF))) == 0;
+#else
+    for (int i = 0; i < 16; ++i) {
+        if (p[i] == 0xFF) return false;
+    }
+    return true;
+#endif
+}
+
+void buildOpaqueSpans(const uint8_t *pixels, uint16_t width, uint16_t height, std::vector<PixelSpan>& out) {
+    out.clear();
+    for (uint16_t y = 0; y < height; ++y) {
+        const uint8_t *row = pixels + (size_t)y * width;
+        size_t x = 0;
+        while (x < width) {
+            // Suite transparente
+            while (x + 16 <= width && allSkip16(row + x)) x += 16;
+            while (x < width && row[x] == 0xFF) ++x;
+            if (x >= width) {
+                break;
+            }
+            // Suite opaque
+            const size_t start = x;
+            while (x + 16 <= width && noSkip16(row + x)) x += 16;
+            while (x < width && row[x] != 0xFF) ++x;
+            out.push_back({y, (uint16_t)start, (uint16_t)(x - start)});
+        }
+    }
+}
+
+void blitSpans(const uint8_t *src, uint16_t width, const std::vector<PixelSpan>& spans, int dstX, int dstY,
+               uint8_t *dst, int dstWidth, int dstHeight, std::vector<PixelSpan> *outSpans) {
+    for (const PixelSpan& span : spans) {
+        const int y = dstY + span.y;
+        if (y < 0 || y >= dstHeight) {
+            continue;
+        }
+        const int x0 = std::max(dstX + (int)span.x, 0);
+        const int x1 = std::min(dstX + (int)span.x + (int)span.length, dstWidth);
+        if (x0 >= x1) {
+            continue;
+        }
+        std::copy_n(src + (size_t)span.y * width + (x0 - dstX), x1 - x0, dst + (size_t)y * dstWidth + x0);
+        if (outSpans) {
+            outSpans->push_back({(uint16_t)y, (uint16_t)x0, (uint16_t)(x1 - x0)});
+        }
+    }
+}
+
+void mergeSpans(std::vector<PixelSpan>& spans) {
+    std::sort(spans.begin(), spans.end(), [](const PixelSpan& a, const PixelSpan& b) {
+        return a.y != b.y ? a.y < b.y : a.x < b.x;
+    });
+    size_t merged = 0;
+    for (size_t i = 0; i < spans.size(); ++i) {
+        if (merged > 0) {
+            PixelSpan& last = spans[merged - 1];
+            const int lastEnd = last.x + last.length;
+            if (last.y == spans[i].y && spans[i].x <= lastEnd) {
+                last.length = (uint16_t)(std::max(lastEnd, spans[i].x + spans[i].length) - last.x);
+                continue;
+            }
+        }
+        spans[merged++] = spans[i];
+    }
+    spans.resize(merged);
+}
+
+} // namespace ScummVMRobot
@@ -0,0 +1,93 @@
+#ifndef ROBOT_CEL_H
+#define ROBOT_CEL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ScummVMRobot {
+
+// Taille de l'en-tête d'un cel et d'un chunk (RobotDecoder::createCel5)
+constexpr size_t kCelHeaderSize = 22;
+constexpr size_t kCelChunkHeaderSize = 10;
+
+/**
+ * Suite de pixels opaques (différents de la skip color 255) sur une ligne.
+ * Les pixels sont pixels[y * width + x .. + length) du tampon dense associé.
+ */
+struct PixelSpan {
+    uint16_t y;
+    uint16_t x;
+    uint16_t length;
+};
+
+/**
+ * Cel Robot décodé (indices palette, skip = 255)
+ */
+struct RobotCel {
+    uint8_t horizontalScale = 100;
+    uint8_t verticalScale = 100;
+    uint16_t width = 0;
+    uint16_t height = 0;
+    uint16_t celX = 0;          // Offset X relatif (en-tête +10)
+    uint16_t celY = 0;          // Offset Y relatif (en-tête +12)
+    uint16_t dataSize = 0;      // Taille des chunks (hors en-tête)
+    int16_t numDataChunks = 0;
+    std::vector<uint8_t> pixels;  // width * height indices, après expansion verticale
+    std::vector<PixelSpan> spans; // Suites opaques par ligne (decodeRobotCel avec withSpans)
+};
+
+/**
+ * Lit uniquement l'en-tête d'un cel (22 octets)
+ * @return false si moins de 22 octets disponibles
+ */
+bool readCelHeader(const uint8_t *rawCel, size_t available, RobotCel& out);
+
+/**
+ * Décode un cel complet : en-tête, chunks LZS/bruts puis expansion verticale.
+ * Port de RobotDecoder::createCel5 (ScummVM), partagé par l'extraction PPM,
+ * la composition de frames et l'export atlas.
+ *
+ * @param rawCel     Début de l'en-tête du cel
+ * @param available  Octets lisibles depuis rawCel
+ * @param out        Cel décodé (pixels redimensionnés à width*height)
+ * @param withSpans  Remplit aussi out.spans (buildOpaqueSpans)
+ * @return Octets consommés (22 + dataSize), 0 en cas d'erreur
+ */
+uint32_t decodeRobotCel(const uint8_t *rawCel, size_t available, RobotCel& out, bool withSpans = false);
+
+/**
+ * Expansion verticale d'un cel compressé en hauteur (verticalScale != 100).
+ * Les lignes source sont répétées selon le ratio height / sourceHeight
+ * (algorithme de createCel5, de bas en haut) ; les lignes manquantes sont
+ * remplies de 0.
+ */
+void expandCelVertically(const uint8_t *src, size_t srcSize, uint16_t width,
+                         int sourceHeight, uint16_t height, uint8_t *dst);
+
+/**
+ * Liste des suites opaques d'une image indexée, ligne par ligne puis par x.
+ * Les blocs de 16 pixels entièrement transparents ou entièrement opaques
+ * sont franchis d'un seul test (SSE2 / NEON).
+ */
+void buildOpaqueSpans(const uint8_t *pixels, uint16_t width, uint16_t height, std::vector<PixelSpan>& out);
+
+/**
+ * Compose une image sur un canvas indexé en ne copiant que ses suites
+ * opaques (une copie par suite, transparence ignorée).
+ *
+ * @param outSpans Si non nul, reçoit les suites écrites, clippées et en
+ *                 coordonnées du canvas
+ */
+void blitSpans(const uint8_t *src, uint16_t width, const std::vector<PixelSpan>& spans, int dstX, int dstY,
+               uint8_t *dst, int dstWidth, int dstHeight, std::vector<PixelSpan> *outSpans = nullptr);
+
+/**
+ * Trie les suites par (y, x) et fusionne celles qui se chevauchent ou se
+ * touchent (union des cels d'une frame)
+ */
+void mergeSpans(std::vector<PixelSpan>& spans);
+
+} // namespace ScummVMRobot
+
+#endif // ROBOT_CEL_H
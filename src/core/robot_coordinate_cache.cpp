@@ -0,0 +1,182 @@
+/**
+ * @file robot_coordinate_cache.cpp
+ * @brief Cache persistant des coordonnées Robot (JSON, invalidé par empreinte des volumes)
+ */
+
+#include "robot_coordinate_cache.h"
+#include "resmap_reader.h"
+#include "../utils/atomic_file.h"
+#include "../utils/file_hash.h"
+#include "../utils/log.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+
+namespace fs = std::filesystem;
+
+namespace SCI {
+
+static const int kCoordinateCacheVersion = 3;
+
+static nlohmann::json volumeToJson(const VolumeFingerprint& v) {
+    return {{"name", v.name}, {"size", v.size}, {"mtime", v.mtime}, {"hash", v.hash}};
+}
+
+RobotCoordinateCache::RobotCoordinateCache(const std::string& path)
+    : m_path(path) {
+}
+
+std::vector<VolumeFingerprint> RobotCoordinateCache::listVolumes(const std::string& resourceDir) {
+    std::vector<VolumeFingerprint> volumes;
+    std::error_code ec;
+
+    for (const auto& entry : fs::directory_iterator(resourceDir, ec)) {
+        std::string name = entry.path().filename().string();
+        if (!isVolumeFile(name)) {
+            continue;
+        }
+        std::error_code fileEc;
+        VolumeFingerprint v;
+        v.name = name;
+        v.size = entry.file_size(fileEc);
+        if (fileEc) {
+            continue;
+        }
+        auto t = entry.last_write_time(fileEc);
+        v.mtime = fileEc ? 0 : (int64_t)t.time_since_epoch().count();
+        volumes.push_back(std::move(v));
+    }
+
+    std::sort(volumes.begin(), volumes.end(),
+              [](const VolumeFingerprint& a, const VolumeFingerprint& b) { return a.name < b.name; });
+    return volumes;
+}
+
+bool RobotCoordinateCache::load() {
+    if (m_loaded) {
+        return m_root.is_object();
+    }
+    m_loaded = true;
+
+    std::ifstream file(m_path);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    nlohmann::json root = nlohmann::json::parse(file, nullptr, false);
+    if (root.is_discarded() || !root.is_object() ||
+        root.value("version", 0) != kCoordinateCacheVersion ||
+        !root.contains("volumes") || !root["volumes"].is_array() ||
+        !root.contains("coordinates") || !root["coordinates"].is_array()) {
+        LOG_WARNING(Export, "Ignoring invalid coordinate cache %s\n", m_path.c_str());
+        return false;
+    }
+
+    m_root = std::move(root);
+    return true;
+}
+
+bool RobotCoordinateCache::save() const {
+    return Common::writeFileAtomic(m_path, m_root.dump(2) + "\n");
+}
+
+std::string RobotCoordinateCache::knownHash(const VolumeFingerprint& volume) const {
+    if (!m_root.is_object()) {
+        return std::string();
+    }
+    for (const auto& v : m_root["volumes"]) {
+        if (v.value("name", std::string()) == volume.name &&
+            v.value("size", (uint64_t)0) == volume.size &&
+            v.value("mtime", (int64_t)0) == volume.mtime) {
+            return v.value("hash", std::string());
+        }
+    }
+    return std::string();
+}
+
+bool RobotCoordinateCache::lookup(const std::string& resourceDir, std::vector<RobotCoordinates>& coords) {
+    if (!load()) {
+        return false;
+    }
+
+    std::vector<VolumeFingerprint> current = listVolumes(resourceDir);
+    nlohmann::json& stored = m_root["volumes"];
+    if (current.empty() || current.size() != stored.size()) {
+        return false;
+    }
+
+    bool touched = false;
+    for (size_t i = 0; i < current.size(); i++) {
+        VolumeFingerprint& v = current[i];
+        nlohmann::json& s = stored[i];
+        if (s.value("name", std::string()) != v.name || s.value("size", (uint64_t)0) != v.size) {
+            return false;
+        }
+        if (s.value("mtime", (int64_t)0) == v.mtime) {
+            continue;
+        }
+
+        // Date différente, même taille : comparer le contenu
+        uint64_t hash = 0;
+        if (!FileHash::hashFile((fs::path(resourceDir) / v.name).string(), hash) ||
+            FileHash::toHex(hash) != s.value("hash", std::string())) {
+            return false;
+        }
+        s["mtime"] = v.mtime;
+        touched = true;
+    }
+
+    coords.clear();
+    for (const auto& c : m_root["coordinates"]) {
+        RobotCoordinates rc;
+        rc.robotId = c.value("robot", (uint32_t)0);
+        rc.x = c.value("x", (int16_t)0);
+        rc.y = c.value("y", (int16_t)0);
+        rc.priority = c.value("priority", (int16_t)0);
+        rc.scale = c.value("scale", (int16_t)128);
+        rc.scriptId = c.value("script", (uint32_t)0);
+        coords.push_back(rc);
+    }
+
+    if (touched) {
+        save();
+    }
+    return true;
+}
+
+bool RobotCoordinateCache::store(const std::string& resourceDir, const std::vector<RobotCoordinates>& coords) {
+    load();
+
+    std::vector<VolumeFingerprint> volumes = listVolumes(resourceDir);
+    if (volumes.empty()) {
+        return false;
+    }
+
+    nlohmann::json volumesJson = nlohmann::json::array();
+    for (auto& v : volumes) {
+        v.hash = knownHash(v);
+        if (v.hash.empty()) {
+            uint64_t hash = 0;
+            if (!FileHash::hashFile((fs::path(resourceDir) / v.name).string(), hash)) {
+                LOG_WARNING(Export, "Cannot hash %s\n", v.name.c_str());
+                return false;
+            }
+            v.hash = FileHash::toHex(hash);
+        }
+        volumesJson.push_back(volumeToJson(v));
+    }
+
+    nlohmann::json coordsJson = nlohmann::json::array();
+    for (const auto& c : coords) {
+        coordsJson.push_back({{"robot", c.robotId}, {"x", c.x}, {"y", c.y},
+                              {"priority", c.priority}, {"scale", c.scale}, {"script", c.scriptId}});
+    }
+
+    m_root = {{"version", kCoordinateCacheVersion},
+              {"resourceDir", resourceDir},
+              {"volumes", volumesJson},
+              {"coordinates", coordsJson}};
+    return save();
+}
+
+} // namespace SCI
@@ -0,0 +1,77 @@
+/**
+ * @file robot_coordinate_cache.h
+ * @brief Cache persistant des coordonnées Robot extraites des scripts SCI
+ *
+ * Le scan des scripts (décompression + recherche des CALLK Robot) est refait
+ * à chaque lancement alors que les RESMAP/RESSCI ne changent jamais une fois
+ * le jeu installé. Le résultat est conservé dans un fichier JSON, avec pour
+ * chaque coordonnée le script d'où elle provient, et l'empreinte de chaque
+ * volume (nom, taille, date, hash du contenu).
+ *
+ * Validation au chargement : taille et date identiques suffisent ; si seule
+ * la date a changé (copie, restauration), le contenu est rehaché et le cache
+ * reste valide tant que le hash est le même.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "ressci_parser.h"
+
+namespace SCI {
+
+/**
+ * @brief Empreinte d'un fichier RESMAP.* / RESSCI.*
+ */
+struct VolumeFingerprint {
+    std::string name;   // Nom de fichier (sans répertoire)
+    uint64_t size = 0;
+    int64_t mtime = 0;
+    std::string hash;   // FNV-1a 64 bits du contenu (hexadécimal)
+};
+
+/**
+ * @brief Coordonnées Robot mises en cache pour un répertoire Resource/
+ */
+class RobotCoordinateCache {
+public:
+    explicit RobotCoordinateCache(const std::string& path);
+
+    /**
+     * @brief Coordonnées enregistrées, si les volumes de resourceDir n'ont pas changé
+     * @param coords Coordonnées dans l'ordre du scan d'origine
+     * @return false si le cache est absent, invalide ou périmé
+     */
+    bool lookup(const std::string& resourceDir, std::vector<RobotCoordinates>& coords);
+
+    /**
+     * @brief Enregistre le résultat d'un scan (fichier temporaire + rename)
+     *
+     * Les volumes dont taille et date sont inchangées depuis le dernier
+     * enregistrement ne sont pas rehachés.
+     */
+    bool store(const std::string& resourceDir, const std::vector<RobotCoordinates>& coords);
+
+    /**
+     * @brief Liste les RESMAP.* / RESSCI.* de resourceDir, triés par nom (sans hash)
+     */
+    static std::vector<VolumeFingerprint> listVolumes(const std::string& resourceDir);
+
+    const std::string& path() const { return m_path; }
+
+private:
+    bool load();
+    bool save() const;
+
+    /** Hash enregistré pour ce volume si taille et date correspondent, vide sinon */
+    std::string knownHash(const VolumeFingerprint& volume) const;
+
+    std::string m_path;
+    nlohmann::json m_root;
+    bool m_loaded = false;
+};
+
+} // namespace SCI
@@ -0,0 +1,302 @@
+/**
+ * @file sci_bytecode.cpp
+ * @brief Désassembleur linéaire SCI32 : table des formats d'opérandes et pile abstraite
+ */
+
+#include "sci_bytecode.h"
+#include <algorithm>
+
+namespace SCI {
+
+// Formats d'opérandes (ScummVM opcode_formats)
+enum OperandFormat : uint8_t {
+    F_END = 0,
+    F_BYTE,      // 1 octet non signé
+    F_VAR,       // 1 ou 2 octets non signés selon le bit b
+    F_SVAR,      // 1 ou 2 octets signés selon le bit b
+    F_INVALID
+};
+
+static const uint8_t kOperandFormats[0x40][3] = {
+    /*00*/ {F_END}, {F_END}, {F_END}, {F_END}, {F_END}, {F_END}, {F_END}, {F_END},
+    /*08*/ {F_END}, {F_END}, {F_END}, {F_END}, {F_END}, {F_END}, {F_END}, {F_END},
+    /*10*/ {F_END}, {F_END}, {F_END}, {F_END}, {F_END}, {F_END}, {F_END}, {F_SVAR},
+    /*18*/ {F_SVAR}, {F_SVAR}, {F_SVAR}, {F_END}, {F_SVAR}, {F_END}, {F_END}, {F_VAR},
+    /*20*/ {F_SVAR, F_BYTE}, {F_VAR, F_BYTE}, {F_VAR, F_BYTE}, {F_VAR, F_VAR, F_BYTE},
+    /*24*/ {F_END}, {F_BYTE}, {F_INVALID}, {F_INVALID},
+    /*28*/ {F_VAR}, {F_INVALID}, {F_BYTE}, {F_VAR, F_BYTE},
+    /*2C*/ {F_VAR}, {F_VAR, F_VAR}, {F_END}, {F_INVALID},
+    /*30*/ {F_END}, {F_VAR}, {F_VAR}, {F_VAR}, {F_VAR}, {F_VAR}, {F_VAR}, {F_VAR},
+    /*38*/ {F_VAR}, {F_VAR}, {F_VAR}, {F_END}, {F_END}, {F_END}, {F_END}, {F_INVALID},
+};
+
+static inline uint16_t readLE16(const uint8_t* data) {
+    return data[0] | (data[1] << 8);
+}
+
+bool decodeInstruction(const uint8_t* code, size_t size, size_t offset, Instruction& out) {
+    if (offset >= size) {
+        return false;
+    }
+
+    const uint8_t raw = code[offset];
+    const bool byteOperands = (raw & 1) != 0;
+    out.offset = static_cast<uint32_t>(offset);
+    out.opcode = raw >> 1;
+    out.numOperands = 0;
+
+    // 0x40-0x7F : une seule opérande (index de variable)
+    static const uint8_t kVariableAccess[3] = {F_VAR, F_END, F_END};
+    const uint8_t* formats = (out.opcode >= OP_FIRST_VAR) ? kVariableAccess : kOperandFormats[out.opcode];
+
+    size_t pos = offset + 1;
+    for (int i = 0; i < 3 && formats[i] != F_END; i++) {
+        int32_t value = 0;
+        switch (formats[i]) {
+            case F_INVALID:
+                return false;
+            case F_BYTE:
+                if (pos + 1 > size) return false;
+                value = code[pos++];
+                break;
+            case F_VAR:
+            case F_SVAR:
+                if (byteOperands) {
+                    if (pos + 1 > size) return false;
+                    value = (formats[i] == F_SVAR) ? (int8_t)code[pos] : code[pos];
+                    pos += 1;
+                } else {
+                    if (pos + 2 > size) return false;
+                    uint16_t word = readLE16(code + pos);
+                    value = (formats[i] == F_SVAR) ? (int16_t)word : word;
+                    pos += 2;
+                }
+                break;
+        }
+        out.operands[out.numOperands++] = value;
+    }
+
+    out.size = static_cast<uint8_t>(pos - offset);
+    return true;
+}
+
+size_t scriptCodeStart(const uint8_t* script, size_t size) {
+    // SCI1.1 / SCI2 : [0-5] en-tête, [6] nombre d'exports, [8] table d'exports
+    if (size < 8) {
+        return size;
+    }
+    size_t start = 8 + static_cast<size_t>(readLE16(script + 6)) * 2;
+    return std::min(start, size);
+}
+
+namespace {
+
+/**
+ * Pile abstraite bornée : au-delà de kMaxDepth (bytecode désaligné), les
+ * valeurs les plus anciennes sont oubliées
+ */
+class AbstractStack {
+public:
+    void reset() { _values.clear(); _acc = StackValue(); }
+
+    void push(StackValue v) {
+        if (_values.size() >= kMaxDepth) {
+            _values.erase(_values.begin());
+        }
+        _values.push_back(v);
+    }
+    void pushUnknown() { push(StackValue()); }
+    void pushConstant(int32_t value) { push(StackValue{true, static_cast<int16_t>(value)}); }
+
+    void pop(size_t count) {
+        _values.resize(_values.size() > count ? _values.size() - count : 0);
+    }
+
+    size_t depth() const { return _values.size(); }
+    const StackValue& fromTop(size_t i) const { return _values[_values.size() - 1 - i]; }
+
+    StackValue& acc() { return _acc; }
+
+private:
+    static const size_t kMaxDepth = 256;
+    std::vector<StackValue> _values;
+    StackValue _acc;
+};
+
+} // namespace
+
+std::vector<KernelCall> findKernelCalls(const uint8_t* code, size_t size, size_t start,
+                                        const std::vector<uint16_t>& kernelIds) {
+    std::vector<KernelCall> calls;
+    AbstractStack stack;
+    std::vector<uint8_t> branchTarget(size, 0);  // Cibles de branchements avant
+    bool restPending = false;                    // &rest : nombre d'arguments inconnu
+
+    size_t pos = start;
+    while (pos < size) {
+        // Point de jonction : l'état de la pile dépend du chemin
+        if (branchTarget[pos]) {
+            stack.reset();
+            restPending = false;
+        }
+
+        Instruction ins;
+        if (!decodeInstruction(code, size, pos, ins)) {
+            stack.reset();
+            restPending = false;
+            pos++;
+            continue;
+        }
+        pos += ins.size;
+
+        const uint8_t op = ins.opcode;
+        if (op >= OP_FIRST_VAR) {
+            // Bits : 0x04 = vers la pile, 0x08 = indexé par acc, 0x10 = store, 0x20/0x30 = ++/--
+            const bool toStack = (op & 0x04) != 0;
+            const bool store = (op & 0x30) == 0x10;
+            if (store) {
+                if (toStack || (op & 0x08)) {
+                    stack.pop(1);
+                }
+                if (op & 0x08) {
+                    stack.acc() = StackValue();  // sagi : acc = valeur dépilée
+                }
+            } else if (toStack) {
+                stack.pushUnknown();
+            } else {
+                stack.acc() = StackValue();
+            }
+            continue;
+        }
+
+        switch (op) {
+            case OP_BT:
+            case OP_BNT:
+            case OP_JMP: {
+                int64_t target = static_cast<int64_t>(pos) + ins.operands[0];
+                if (target > static_cast<int64_t>(pos) && target < static_cast<int64_t>(size)) {
+                    branchTarget[static_cast<size_t>(target)] = 1;
+                }
+                if (op == OP_JMP) {
+                    stack.reset();
+                    restPending = false;
+                }
+                break;
+            }
+
+            case OP_LDI:
+                stack.acc() = StackValue{true, static_cast<int16_t>(ins.operands[0])};
+                break;
+            case OP_PUSH:
+                stack.push(stack.acc());
+                break;
+            case OP_PUSHI:
+                stack.pushConstant(ins.operands[0]);
+                break;
+            case OP_PUSH0:
+                stack.pushConstant(0);
+                break;
+            case OP_PUSH1:
+                stack.pushConstant(1);
+                break;
+            case OP_PUSH2:
+                stack.pushConstant(2);
+                break;
+            case OP_TOSS:
+                stack.pop(1);
+                break;
+            case OP_DUP:
+                if (stack.depth() > 0) {
+                    stack.push(stack.fromTop(0));
+                } else {
+                    stack.pushUnknown();
+                }
+                break;
+
+            case OP_LINK:
+            case OP_RET:
+                // Début ou fin de procédure : pile locale indépendante
+                stack.reset();
+                restPending = false;
+                break;
+
+            case OP_CALLK: {
+                const size_t argc = static_cast<size_t>(ins.operands[1]) / 2;
+                const uint16_t kernelId = static_cast<uint16_t>(ins.operands[0]);
+                const bool wanted = kernelIds.empty() ||
+                    std::find(kernelIds.begin(), kernelIds.end(), kernelId) != kernelIds.end();
+
+                if (wanted && !restPending && stack.depth() >= argc + 1) {
+                    const StackValue& count = stack.fromTop(argc);
+                    if (count.known && count.value == static_cast<int16_t>(argc)) {
+                        KernelCall call;
+                        call.offset = ins.offset;
+                        call.kernelId = kernelId;
+                        for (size_t i = 0; i < argc; i++) {
+                            call.args.push_back(stack.fromTop(argc - 1 - i));
+                        }
+                        calls.push_back(std::move(call));
+                    }
+                }
+                stack.pop(argc + 1);
+                stack.acc() = StackValue();
+                restPending = false;
+                break;
+            }
+
+            case OP_CALL:
+            case OP_CALLB:
+            case OP_CALLE: {
+                const int32_t frameBytes = ins.operands[ins.numOperands - 1];
+                stack.pop(static_cast<size_t>(frameBytes) / 2 + 1);
+                stack.acc() = StackValue();
+                restPending = false;
+                break;
+            }
+
+            case OP_SEND:
+            case OP_SELF:
+                stack.pop(static_cast<size_t>(ins.operands[0]) / 2);
+                stack.acc() = StackValue();
+                restPending = false;
+                break;
+            case OP_SUPER:
+                stack.pop(static_cast<size_t>(ins.operands[1]) / 2);
+                stack.acc() = StackValue();
+                restPending = false;
+                break;
+
+            case OP_REST:
+                restPending = true;
+                break;
+
+            case OP_PPREV:
+            case OP_PTOS:
+            case OP_IPTOS:
+            case OP_DPTOS:
+            case OP_LOFSS:
+            case OP_PUSHSELF:
+                stack.pushUnknown();
+                break;
+
+            case OP_STOP:
+                stack.pop(1);
+                break;
+            case OP_ATOP:
+                break;
+
+            default:
+                // Opérations binaires (dépilent un opérande), unaires et
+                // chargements dans acc : seul acc change
+                if (op >= 0x01 && op <= OP_ULE && op != OP_NEG && op != OP_NOT) {
+                    stack.pop(1);
+                }
+                stack.acc() = StackValue();
+                break;
+        }
+    }
+
+    return calls;
+}
+
+} // namespace SCI
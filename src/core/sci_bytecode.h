@@ -0,0 +1,93 @@
+/**
+ * @file sci_bytecode.h
+ * @brief Désassembleur linéaire SCI32 et émulation de pile pour les appels kernel
+ *
+ * Encodage SCI : octet d'opcode = (op << 1) | b, où b = 1 indique des
+ * opérandes « variables » sur 1 octet au lieu de 2. La table des formats
+ * d'opérandes suit celle de ScummVM (engines/sci/engine/vm.cpp).
+ *
+ * Convention d'appel kernel : l'appelant empile argc puis les arguments dans
+ * l'ordre, et `callk kernel, n` dépile n / 2 + 1 mots. Une pile abstraite
+ * (constantes connues / valeurs inconnues) suffit donc à reconstruire les
+ * arguments littéraux d'un appel en une seule passe avant.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace SCI {
+
+/**
+ * @brief Opcodes SCI (index = octet >> 1)
+ */
+enum Opcode : uint8_t {
+    OP_BNOT = 0x00, OP_NEG = 0x0B, OP_NOT = 0x0C, OP_ULE = 0x16,
+    OP_BT = 0x17, OP_BNT = 0x18, OP_JMP = 0x19,
+    OP_LDI = 0x1A, OP_PUSH = 0x1B, OP_PUSHI = 0x1C, OP_TOSS = 0x1D, OP_DUP = 0x1E, OP_LINK = 0x1F,
+    OP_CALL = 0x20, OP_CALLK = 0x21, OP_CALLB = 0x22, OP_CALLE = 0x23, OP_RET = 0x24, OP_SEND = 0x25,
+    OP_CLASS = 0x28, OP_SELF = 0x2A, OP_SUPER = 0x2B, OP_REST = 0x2C, OP_LEA = 0x2D, OP_SELFID = 0x2E,
+    OP_PPREV = 0x30, OP_PTOA = 0x31, OP_ATOP = 0x32, OP_PTOS = 0x33, OP_STOP = 0x34,
+    OP_IPTOA = 0x35, OP_DPTOA = 0x36, OP_IPTOS = 0x37, OP_DPTOS = 0x38,
+    OP_LOFSA = 0x39, OP_LOFSS = 0x3A, OP_PUSH0 = 0x3B, OP_PUSH1 = 0x3C, OP_PUSH2 = 0x3D, OP_PUSHSELF = 0x3E,
+    OP_FIRST_VAR = 0x40  // 0x40-0x7F : accès variables (global/local/temp/param)
+};
+
+/**
+ * @brief Instruction décodée
+ */
+struct Instruction {
+    uint32_t offset = 0;        // Position dans le script
+    uint8_t opcode = 0;         // Index d'opcode (0x00-0x7F)
+    uint8_t size = 0;           // Taille totale en octets, opcode compris
+    uint8_t numOperands = 0;
+    int32_t operands[3] = {0, 0, 0};
+};
+
+/**
+ * @brief Décode l'instruction à `offset`
+ * @return false si l'opcode est invalide ou tronqué
+ */
+bool decodeInstruction(const uint8_t* code, size_t size, size_t offset, Instruction& out);
+
+/**
+ * @brief Valeur de la pile abstraite : constante connue ou inconnue
+ */
+struct StackValue {
+    bool known = false;
+    int16_t value = 0;
+};
+
+/**
+ * @brief Appel kernel dont le nombre d'arguments a pu être vérifié
+ *
+ * args ne contient pas argc ; une valeur inconnue (propriété, variable,
+ * résultat de calcul) reste marquée known = false.
+ */
+struct KernelCall {
+    uint32_t offset = 0;
+    uint16_t kernelId = 0;
+    std::vector<StackValue> args;
+};
+
+/**
+ * @brief Parcourt [start, size) et relève les appels aux kernels demandés
+ *
+ * Passe unique et linéaire : la pile abstraite est remise à zéro après un
+ * saut inconditionnel ou un retour, sur chaque cible de branchement avant
+ * et sur tout opcode invalide (resynchronisation octet par octet). Un appel
+ * n'est retenu que si argc, lu sur la pile, correspond à l'opérande de callk.
+ *
+ * @param kernelIds Kernels recherchés (vide = tous)
+ */
+std::vector<KernelCall> findKernelCalls(const uint8_t* code, size_t size, size_t start,
+                                        const std::vector<uint16_t>& kernelIds);
+
+/**
+ * @brief Début du bytecode d'un script SCI1.1/SCI32 (après la table d'exports)
+ */
+size_t scriptCodeStart(const uint8_t* script, size_t size);
+
+} // namespace SCI
@@ -0,0 +1,254 @@
+/**
+ * @file sci_objects.cpp
+ * @brief Lecture des objets SCI1.1/SCI32 (HEAP) et résolution des propriétés par sélecteur
+ */
+
+#include "sci_objects.h"
+#include <algorithm>
+#include <cctype>
+
+namespace SCI {
+
+static const uint16_t kObjectMagic = 0x1234;
+
+// Index des propriétés fixes d'un objet (en mots)
+enum {
+    kPropSize = 1,
+    kPropDict = 2,
+    kPropSpecies = 5,
+    kPropSuperClass = 6,
+    kPropInfo = 7,
+    kPropName = 8,
+    kMinProperties = 9
+};
+
+static inline uint16_t readLE16(const uint8_t* data) {
+    return data[0] | (data[1] << 8);
+}
+
+static std::string toLower(std::string s) {
+    std::transform(s.begin(), s.end(), s.begin(),
+                   [](unsigned char c) { return (char)std::tolower(c); });
+    return s;
+}
+
+bool parseScriptObjects(uint16_t scriptNumber,
+                        const uint8_t* script, size_t scriptSize,
+                        const uint8_t* heap, size_t heapSize,
+                        std::vector<ScriptObject>& out) {
+    if (heapSize < 4) {
+        return false;
+    }
+
+    size_t pos = 4 + static_cast<size_t>(readLE16(heap + 2)) * 2;  // Après les locales
+    while (pos + 4 <= heapSize && readLE16(heap + pos) == kObjectMagic) {
+        const size_t count = readLE16(heap + pos + kPropSize * 2);
+        if (count < kMinProperties || pos + count * 2 > heapSize) {
+            return false;
+        }
+
+        ScriptObject object;
+        object.script = scriptNumber;
+        object.heapOffset = static_cast<uint16_t>(pos);
+        object.values.resize(count);
+        for (size_t i = 0; i < count; i++) {
+            object.values[i] = readLE16(heap + pos + i * 2);
+        }
+        object.species = object.values[kPropSpecies];
+        object.superClass = object.values[kPropSuperClass];
+        object.info = object.values[kPropInfo];
+
+        // Nom : chaîne C dans le HEAP
+        const size_t nameOffset = object.values[kPropName];
+        if (nameOffset > 0 && nameOffset < heapSize) {
+            const uint8_t* begin = heap + nameOffset;
+            const uint8_t* end = std::find(begin, heap + heapSize, 0);
+            object.name.assign(begin, end);
+        }
+
+        // Dictionnaire de propriétés : un sélecteur par propriété, dans le SCRIPT
+        const size_t dictOffset = object.values[kPropDict];
+        if (object.isClass() && script && dictOffset + count * 2 <= scriptSize) {
+            object.selectors.resize(count);
+            for (size_t i = 0; i < count; i++) {
+                object.selectors[i] = readLE16(script + dictOffset + i * 2);
+            }
+        }
+
+        out.push_back(std::move(object));
+        pos += count * 2;
+    }
+
+    return true;
+}
+
+bool ObjectTable::loadSelectorNames(const uint8_t* vocab, size_t size) {
+    m_selectorNames.clear();
+    m_selectorIds.clear();
+    if (size < 2) {
+        return false;
+    }
+
+    // [0] nombre de sélecteurs - 1, puis un offset par sélecteur vers (longueur, caractères)
+    const size_t count = static_cast<size_t>(readLE16(vocab)) + 1;
+    if (2 + count * 2 > size) {
+        return false;
+    }
+
+    m_selectorNames.resize(count);
+    for (size_t i = 0; i < count; i++) {
+        const size_t offset = readLE16(vocab + 2 + i * 2);
+        if (offset + 2 > size) {
+            continue;
+        }
+        const size_t length = std::min<size_t>(readLE16(vocab + offset), size - offset - 2);
+        m_selectorNames[i].assign(reinterpret_cast<const char*>(vocab + offset + 2), length);
+        // Plusieurs entrées peuvent porter le même nom : garder la première
+        m_selectorIds.emplace(m_selectorNames[i], static_cast<uint16_t>(i));
+    }
+    return true;
+}
+
+void ObjectTable::addObjects(std::vector<ScriptObject>&& objects) {
+    m_objects.reserve(m_objects.size() + objects.size());
+    for (ScriptObject& object : objects) {
+        m_objects.push_back(std::move(object));
+    }
+}
+
+void ObjectTable::finalize() {
+    m_classes.clear();
+    m_layouts.clear();
+    m_objectLayout.assign(m_objects.size(), -1);
+
+    // Une passe pour indexer les classes et leurs dictionnaires...
+    std::unordered_map<uint16_t, int> classLayout;
+    for (size_t i = 0; i < m_objects.size(); i++) {
+        const ScriptObject& object = m_objects[i];
+        if (!object.isClass() || object.selectors.empty()) {
+            continue;
+        }
+        if (!m_classes.emplace(object.species, i).second) {
+            continue;  // Classe redéfinie : garder la première
+        }
+        Layout layout;
+        layout.selectors = &object.selectors;
+        for (size_t p = 0; p < object.selectors.size(); p++) {
+            layout.index.emplace(object.selectors[p], static_cast<uint16_t>(p));
+        }
+        classLayout[object.species] = static_cast<int>(m_layouts.size());
+        m_layouts.push_back(std::move(layout));
+    }
+
+    // ...une seconde pour relier chaque objet à celui de sa species
+    for (size_t i = 0; i < m_objects.size(); i++) {
+        auto it = classLayout.find(m_objects[i].species);
+        if (it != classLayout.end()) {
+            m_objectLayout[i] = it->second;
+        }
+    }
+}
+
+int ObjectTable::layoutOf(const ScriptObject& object) const {
+    if (m_objects.empty() || &object < m_objects.data() || &object >= m_objects.data() + m_objects.size()) {
+        return -1;
+    }
+    const size_t i = static_cast<size_t>(&object - m_objects.data());
+    return i < m_objectLayout.size() ? m_objectLayout[i] : -1;
+}
+
+int ObjectTable::selectorId(const std::string& name) const {
+    auto it = m_selectorIds.find(name);
+    return it != m_selectorIds.end() ? it->second : kNoSelector;
+}
+
+const std::string& ObjectTable::selectorName(uint16_t selector) const {
+    static const std::string empty;
+    return selector < m_selectorNames.size() ? m_selectorNames[selector] : empty;
+}
+
+const ScriptObject* ObjectTable::classObject(uint16_t species) const {
+    auto it = m_classes.find(species);
+    return it != m_classes.end() ? &m_objects[it->second] : nullptr;
+}
+
+const std::vector<uint16_t>& ObjectTable::propertySelectors(const ScriptObject& object) const {
+    static const std::vector<uint16_t> empty;
+    const int layout = layoutOf(object);
+    return layout >= 0 ? *m_layouts[layout].selectors : empty;
+}
+
+bool ObjectTable::getProperty(const ScriptObject& object, uint16_t selector, int16_t& value) const {
+    const int layout = layoutOf(object);
+    if (layout < 0) {
+        return false;
+    }
+    const auto& index = m_layouts[layout].index;
+    auto it = index.find(selector);
+    if (it == index.end() || it->second >= object.values.size()) {
+        return false;
+    }
+    value = static_cast<int16_t>(object.values[it->second]);
+    return true;
+}
+
+bool ObjectTable::getProperty(const ScriptObject& object, const std::string& selector, int16_t& value) const {
+    const int id = selectorId(selector);
+    return id != kNoSelector && getProperty(object, static_cast<uint16_t>(id), value);
+}
+
+bool ObjectTable::inheritsFromName(const ScriptObject& object, const std::string& fragment) const {
+    const std::string needle = toLower(fragment);
+    if (toLower(object.name).find(needle) != std::string::npos) {
+        return true;
+    }
+
+    // Remonter la chaîne des superclasses (bornée contre les cycles)
+    uint16_t species = object.isClass() ? object.superClass : object.species;
+    for (int depth = 0; depth < 64 && species != ScriptObject::kNoClass; depth++) {
+        const ScriptObject* cls = classObject(species);
+        if (!cls) {
+            break;
+        }
+        if (toLower(cls->name).find(needle) != std::string::npos) {
+            return true;
+        }
+        species = cls->superClass;
+    }
+    return false;
+}
+
+std::vector<const ScriptObject*> ObjectTable::findObjectsWith(const std::vector<std::string>& selectors) const {
+    std::vector<const ScriptObject*> found;
+
+    std::vector<uint16_t> ids;
+    for (const std::string& name : selectors) {
+        const int id = selectorId(name);
+        if (id == kNoSelector) {
+            return found;
+        }
+        ids.push_back(static_cast<uint16_t>(id));
+    }
+
+    for (size_t i = 0; i < m_objectLayout.size(); i++) {
+        const int layout = m_objectLayout[i];
+        if (layout < 0) {
+            continue;
+        }
+        const auto& index = m_layouts[layout].index;
+        bool all = true;
+        for (uint16_t id : ids) {
+            auto it = index.find(id);
+            if (it == index.end() || it->second >= m_objects[i].values.size()) {
+                all = false;
+                break;
+            }
+        }
+        if (all) {
+            found.push_back(&m_objects[i]);
+        }
+    }
+    return found;
+}
+
+} // namespace SCI
@@ -0,0 +1,128 @@
+/**
+ * @file sci_objects.h
+ * @brief Objets SCI1.1/SCI32 lus depuis les paires SCRIPT/HEAP et requêtes par sélecteur
+ *
+ * Disposition d'un HEAP (SCI1.1 à SCI2.1) :
+ *   [0] offset de la table de relocation, [2] nombre de locales, [4] locales,
+ *   puis les objets, chacun débutant par le mot magique 0x1234.
+ *
+ * Un objet est une suite de mots (ses propriétés), dont les premiers sont :
+ *   [0] 0x1234, [1] nombre de propriétés, [2] dictionnaire de propriétés
+ *   (offset dans le SCRIPT), [3] dictionnaire de méthodes, [5] species,
+ *   [6] superclasse, [7] info (0x8000 = classe), [8] nom (offset dans le HEAP).
+ *
+ * Seules les classes portent un dictionnaire de propriétés exploitable (les
+ * numéros de sélecteur de chaque propriété) : une instance utilise celui de
+ * sa species. Les noms de sélecteurs viennent de VOCAB 997.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace SCI {
+
+/**
+ * @brief Objet (classe ou instance) défini dans un script
+ */
+struct ScriptObject {
+    static const uint16_t kInfoClass = 0x8000;
+    static const uint16_t kNoClass = 0xFFFF;
+
+    uint16_t script = 0;              // Numéro du script (= numéro du HEAP)
+    uint16_t heapOffset = 0;          // Position de l'objet dans le HEAP
+    uint16_t species = kNoClass;      // Numéro de classe (la sienne pour une classe)
+    uint16_t superClass = kNoClass;
+    uint16_t info = 0;
+    std::string name;
+    std::vector<uint16_t> values;     // Valeurs initiales des propriétés
+    std::vector<uint16_t> selectors;  // Sélecteur de chaque propriété (classes seulement)
+
+    bool isClass() const { return (info & kInfoClass) != 0; }
+};
+
+/**
+ * @brief Lit les objets d'un HEAP en une passe (mot magique + taille)
+ * @param script Ressource SCRIPT du même numéro (dictionnaires des classes)
+ * @param out Objets ajoutés dans l'ordre du HEAP
+ * @return false si le HEAP est tronqué ou ne suit pas la disposition SCI1.1
+ */
+bool parseScriptObjects(uint16_t scriptNumber,
+                        const uint8_t* script, size_t scriptSize,
+                        const uint8_t* heap, size_t heapSize,
+                        std::vector<ScriptObject>& out);
+
+/**
+ * @brief Ensemble des objets du jeu, interrogeable par nom de sélecteur
+ *
+ * Utilisation : loadSelectorNames() (facultatif), addObjects() pour chaque
+ * script, puis finalize() qui relie chaque instance au dictionnaire de sa
+ * classe. Les requêtes sont en temps constant par propriété.
+ */
+class ObjectTable {
+public:
+    static const int kNoSelector = -1;
+
+    /**
+     * @brief Charge la table des noms de sélecteurs (VOCAB 997)
+     * @return false si la ressource est invalide
+     */
+    bool loadSelectorNames(const uint8_t* vocab, size_t size);
+
+    void addObjects(std::vector<ScriptObject>&& objects);
+
+    /** @brief Relie les instances aux classes ; à appeler après le dernier addObjects() */
+    void finalize();
+
+    const std::vector<ScriptObject>& objects() const { return m_objects; }
+
+    /** @brief Numéro d'un sélecteur, kNoSelector si inconnu */
+    int selectorId(const std::string& name) const;
+
+    /** @brief Nom d'un sélecteur, chaîne vide si inconnu */
+    const std::string& selectorName(uint16_t selector) const;
+
+    /** @brief Classe de numéro species, nullptr si absente */
+    const ScriptObject* classObject(uint16_t species) const;
+
+    /** @brief Sélecteurs des propriétés de l'objet (ceux de sa classe), vide si non résolu */
+    const std::vector<uint16_t>& propertySelectors(const ScriptObject& object) const;
+
+    /**
+     * @brief Valeur initiale d'une propriété
+     * @return false si l'objet n'a pas cette propriété
+     */
+    bool getProperty(const ScriptObject& object, uint16_t selector, int16_t& value) const;
+    bool getProperty(const ScriptObject& object, const std::string& selector, int16_t& value) const;
+
+    /**
+     * @brief Vrai si l'objet ou l'un de ses ancêtres porte un nom contenant
+     *        `fragment` (sans tenir compte de la casse)
+     */
+    bool inheritsFromName(const ScriptObject& object, const std::string& fragment) const;
+
+    /** @brief Objets possédant toutes les propriétés demandées */
+    std::vector<const ScriptObject*> findObjectsWith(const std::vector<std::string>& selectors) const;
+
+private:
+    // Dictionnaire de propriétés d'une classe : sélecteur → index de propriété
+    struct Layout {
+        const std::vector<uint16_t>* selectors = nullptr;
+        std::unordered_map<uint16_t, uint16_t> index;
+    };
+
+    int layoutOf(const ScriptObject& object) const;
+
+    std::vector<ScriptObject> m_objects;
+    std::vector<int> m_objectLayout;                     // Index dans m_layouts, -1 si non résolu
+    std::vector<Layout> m_layouts;
+    std::unordered_map<uint16_t, size_t> m_classes;      // species → index dans m_objects
+    std::vector<std::string> m_selectorNames;
+    std::unordered_map<std::string, uint16_t> m_selectorIds;
+};
+
+} // namespace SCI
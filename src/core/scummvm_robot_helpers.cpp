@@ -2,9 +2,24 @@
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <cstring>
 
 namespace ScummVMRobot {
 
+void indexedToRGBA(const uint8_t* indices, size_t count, const uint8_t* paletteRGB, uint8_t* outRGBA) {
+    // Table RGBA 32 bits pré-calculée : une lecture + une écriture par pixel
+    uint32_t lut[256];
+    for (int i = 0; i < 256; ++i) {
+        const uint8_t rgba[4] = {paletteRGB[i * 3], paletteRGB[i * 3 + 1], paletteRGB[i * 3 + 2],
+                                 (uint8_t)(isTransparentPixel((uint8_t)i) ? 0 : 255)};
+        std::memcpy(&lut[i], rgba, 4);
+    }
+    lut[SKIP_COLOR] = 0;
+    for (size_t i = 0; i < count; ++i) {
+        std::memcpy(outRGBA + i * 4, &lut[indices[i]], 4);
+    }
+}
+
 std::vector<RobotPosition> loadRobotPositions(const std::string& filename) {
     std::vector<RobotPosition> positions;
     std::ifstream file(filename);
@@ -49,4 +64,23 @@ RobotPosition findRobotPosition(const std::vector<RobotPosition>& positions, int
     return RobotPosition(-1, 0, 0);
 }
 
+RobotPositionMap indexRobotPositions(const std::vector<RobotPosition>& positions) {
+    RobotPositionMap index;
+    index.reserve(positions.size());
+    for (const auto& pos : positions) {
+        index.emplace(pos.robotId, pos);
+    }
+    return index;
+}
+
+RobotPosition findRobotPosition(const RobotPositionMap& positions, int robotId) {
+    auto it = positions.find(robotId);
+    if (it != positions.end()) {
+        return it->second;
+    }
+    
+    // Non trouvé
+    return RobotPosition(-1, 0, 0);
+}
+
 } // namespace ScummVMRobot
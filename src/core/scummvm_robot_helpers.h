@@ -1,9 +1,11 @@
 #ifndef SCUMMVM_ROBOT_HELPERS_H
 #define SCUMMVM_ROBOT_HELPERS_H
 
+#include <cstddef>
 #include <cstdint>
 #include <vector>
 #include <string>
+#include <unordered_map>
 
 namespace ScummVMRobot {
 
@@ -141,6 +143,14 @@ inline int roundToEven(int dimension) {
     return (dimension % 2 == 0) ? dimension : dimension + 1;
 }
 
+/**
+ * Convertit des indices palette en RGBA 8 bits
+ * @param indices    count indices (SKIP_COLOR = transparent, alpha 0)
+ * @param paletteRGB 256 * 3 octets RGB
+ * @param outRGBA    count * 4 octets
+ */
+void indexedToRGBA(const uint8_t* indices, size_t count, const uint8_t* paletteRGB, uint8_t* outRGBA);
+
 // ============================================================================
 // GESTION POSITIONS RESSCI
 // ============================================================================
@@ -160,6 +170,23 @@ std::vector<RobotPosition> loadRobotPositions(const std::string& filename = "rob
  */
 RobotPosition findRobotPosition(const std::vector<RobotPosition>& positions, int robotId);
 
+/**
+ * Index robotId -> position pour les recherches répétées (une par fichier RBT)
+ */
+using RobotPositionMap = std::unordered_map<int, RobotPosition>;
+
+/**
+ * Construit l'index ; à ID dupliqué, la première position l'emporte
+ * (même résultat que la recherche linéaire)
+ */
+RobotPositionMap indexRobotPositions(const std::vector<RobotPosition>& positions);
+
+/**
+ * Recherche en O(1) dans un index construit par indexRobotPositions
+ * @return Position trouvée (robotId=-1 si non trouvé)
+ */
+RobotPosition findRobotPosition(const RobotPositionMap& positions, int robotId);
+
 } // namespace ScummVMRobot
 
 #endif // SCUMMVM_ROBOT_HELPERS_H
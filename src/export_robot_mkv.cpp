@@ -8,9 +8,11 @@
  *   - <rbt>_video.mov (vidéo composite ProRes 4444 RGBA + audio)
  *   - <rbt>_metadata.txt (métadonnées)
  *   - <rbt>_frames/ (frames PNG individuelles)
+ *   - <rbt>_atlas.png/.json (avec --atlas : cels uniques + table des frames)
  * 
  * Usage:
- *   export_robot_mkv [codec] [--canvas WIDTHxHEIGHT]
+ *   export_robot_mkv [codec] [--canvas WIDTHxHEIGHT] [--jobs N] [--segment-frames N] [--atlas] [--force]
+ *                    [--perf] [--trace FILE]
  * 
  * Codecs supportés:
  *   h264  - x264 (défaut, universel)
@@ -21,13 +23,37 @@
  * Options:
  *   --canvas WIDTHxHEIGHT  - Forcer taille du canvas (ex: 640x480)
  *                            Si non spécifié, détection automatique
+ *   --jobs N               - Encodage parallèle : N processus ffmpeg simultanés
+ *                            (pistes encodées séparément, segments GOP pour
+ *                            h264/h265/vp9, puis remux sans réencodage)
+ *   --segment-frames N     - Taille des segments en frames (défaut: 120)
+ *   --atlas                - Exporter aussi un atlas de sprites (cels uniques
+ *                            dédupliqués, PNG indexé + table JSON des frames)
+ *   --force                - Ignorer le manifeste et tout réexporter
+ *   --perf                 - Mesurer le temps par étape (parse, LZS, composition,
+ *                            PNG, ffmpeg, audio) : output/perf_report.json,
+ *                            plus les succès/échecs du cache de frames
+ *   --trace FILE           - Idem + fichier Chrome trace (chrome://tracing)
+ * 
+ * Export incrémental:
+ *   output/export_manifest.json enregistre, par Robot, le hash du .RBT, les
+ *   coordonnées et la configuration utilisées et le hash des fichiers produits.
+ *   Les Robots inchangés sont sautés ; un batch interrompu reprend au Robot
+ *   suivant le dernier terminé. Les positions extraites de Resource/ sont
+ *   conservées dans output/robot_coordinates_cache.json tant que les
+ *   RESMAP/RESSCI ne changent pas (taille, date, hash).
  */
 
 #include "core/rbt_parser.h"
 #include "core/ressci_parser.h"
+#include "core/robot_coordinate_cache.h"
 #include "core/scummvm_robot_helpers.h"
 #include "formats/robot_mkv_exporter.h"
+#include "formats/export_manifest.h"
+#include "formats/robot_atlas_exporter.h"
 #include "utils/sci_util.h"
+#include "utils/parallel_for.h"
+#include "utils/perf_stats.h"
 #include "../include/stb_image_write.h"
 #include <cstring>
 #include <sys/stat.h>
@@ -37,22 +63,13 @@
 #include <vector>
 #include <string>
 #include <algorithm>
+#include <filesystem>
 
 using namespace RobotExtractor;
 using namespace ScummVMRobot;
 
-// Fonction pour charger tous les volumes RESSCI disponibles
-std::vector<RobotPosition> loadRobotPositionsFromRESSCI(const std::string& resourceDir, const std::string& outputDir) {
-    std::vector<RobotPosition> allPositions;
-    
-    if (resourceDir.empty()) {
-        return allPositions;
-    }
-    
-    fprintf(stderr, "Scanning RESSCI files in: %s\n", resourceDir.c_str());
-    
-    SCI::RESSCIParser parser;
-    
+// Charger tous les RESMAP puis tous les volumes RESSCI disponibles
+static bool loadResourceVolumes(SCI::RESSCIParser& parser, const std::string& resourceDir) {
     // Charger TOUS les RESMAP disponibles (001-009)
     int resmapsLoaded = 0;
     for (int vol = 1; vol <= 9; vol++) {
@@ -74,7 +91,7 @@ std::vector<RobotPosition> loadRobotPositionsFromRESSCI(const std::string& resou
     
     if (resmapsLoaded == 0) {
         fprintf(stderr, "  Warning: No RESMAP files found\n");
-        return allPositions;
+        return false;
     }
     
     fprintf(stderr, "  Loaded %d RESMAP file(s)\n", resmapsLoaded);
@@ -107,10 +124,40 @@ std::vector<RobotPosition> loadRobotPositionsFromRESSCI(const std::string& resou
     
     if (volumesLoaded == 0) {
         fprintf(stderr, "  No RESSCI files found\n");
-        return allPositions;
+        return false;
     }
     
     fprintf(stderr, "  Loaded %d RESSCI volume(s)\n", volumesLoaded);
+    return true;
+}
+
+// Budget du cache de ressources du scan : scripts, HEAP et VOCAB décompressés
+// une seule fois et partagés entre les threads
+static const size_t kResourceCacheBudget = 64 * 1024 * 1024;
+
+// Fonction pour charger tous les volumes RESSCI disponibles et scanner les scripts
+std::vector<SCI::RobotCoordinates> scanRobotCoordinatesFromRESSCI(const std::string& resourceDir, const std::string& outputDir) {
+    std::vector<SCI::RobotCoordinates> sciCoords;
+    
+    if (resourceDir.empty()) {
+        return sciCoords;
+    }
+    
+    fprintf(stderr, "Scanning RESSCI files in: %s\n", resourceDir.c_str());
+    
+    SCI::RESSCIParser parser;
+    parser.setCacheBudget(kResourceCacheBudget);
+    
+    // Catalogue binaire (index + en-têtes résolus) tant que les volumes n'ont pas changé
+    std::string catalogPath = outputDir + "/resource_catalog.bin";
+    if (parser.loadCatalog(catalogPath, resourceDir)) {
+        fprintf(stderr, "  Reusing resource catalog %s\n", catalogPath.c_str());
+    } else {
+        if (!loadResourceVolumes(parser, resourceDir)) {
+            return sciCoords;
+        }
+        parser.saveCatalog(catalogPath);
+    }
     
     // Exporter la liste de toutes les ressources dans output/resources_list.txt
     std::string resourcesListPath = outputDir + "/resources_list.txt";
@@ -121,18 +168,23 @@ std::vector<RobotPosition> loadRobotPositionsFromRESSCI(const std::string& resou
     
     // Extraire toutes les coordonnées Robot
     fprintf(stderr, "  Extracting Robot coordinates...\n");
-    std::vector<SCI::RobotCoordinates> sciCoords = parser.extractRobotCoordinates();
+    sciCoords = parser.extractRobotCoordinates();
     
-    // Convertir vers le format ScummVMRobot::RobotPosition
-    for (const auto& coord : sciCoords) {
-        allPositions.push_back(RobotPosition(coord.robotId, coord.x, coord.y));
+    if (!sciCoords.empty()) {
+        fprintf(stderr, "  Found %zu Robot position(s)\n", sciCoords.size());
     }
     
-    if (!allPositions.empty()) {
-        fprintf(stderr, "  Found %zu Robot position(s)\n", allPositions.size());
+    return sciCoords;
+}
+
+// Convertir vers le format ScummVMRobot::RobotPosition
+std::vector<RobotPosition> toRobotPositions(const std::vector<SCI::RobotCoordinates>& sciCoords) {
+    std::vector<RobotPosition> positions;
+    positions.reserve(sciCoords.size());
+    for (const auto& coord : sciCoords) {
+        positions.push_back(RobotPosition(coord.robotId, coord.x, coord.y));
     }
-    
-    return allPositions;
+    return positions;
 }
 
 // Fonction pour lister tous les fichiers .RBT dans un répertoire
@@ -198,11 +250,16 @@ void detectCanvasSize(int contentWidth, int contentHeight, int& canvasWidth, int
             canvasWidth, canvasHeight);
 }
 
+// Budget du cache de frames composées : la passe de métadonnées du mode crop
+// relit chaque frame déjà extraite
+static const size_t kFrameCacheBudget = 256 * 1024 * 1024;
+
 // Fonction pour traiter un seul fichier RBT
 bool processRbtFile(const std::string& inputPath, const std::string& outputDir, 
-                    const char* codecName, MKVExportConfig::Codec codec,
+                    const char* codecName, const MKVExportConfig& exportConfig,
                     int forceCanvasWidth, int forceCanvasHeight,
-                    const std::vector<RobotPosition>& robotPositions) {
+                    const RobotPositionMap& robotPositions,
+                    bool exportAtlas) {
     
     // Ouvrir le fichier Robot
     FILE* f = fopen(inputPath.c_str(), "rb");
@@ -219,6 +276,7 @@ bool processRbtFile(const std::string& inputPath, const std::string& outputDir,
         fclose(f);
         return false;
     }
+    parser.setFrameCacheBudget(kFrameCacheBudget);
     
     size_t numFrames = parser.getNumFrames();
     int frameRate = parser.getFrameRate();
@@ -286,9 +344,8 @@ bool processRbtFile(const std::string& inputPath, const std::string& outputDir,
     }
     
     // Configuration MKV
-    MKVExportConfig config;
+    MKVExportConfig config = exportConfig;
     config.framerate = frameRate;
-    config.codec = codec;
     
     // Extraire le nom de base du fichier RBT (sans extension et chemin)
     std::string inputFilename = inputPath;
@@ -331,18 +388,18 @@ bool processRbtFile(const std::string& inputPath, const std::string& outputDir,
     allLayers.reserve(numFrames);
     
     for (size_t i = 0; i < numFrames; ++i) {
-        // Extraire les pixels indexés
-        std::vector<uint8_t> pixelIndices;
-        int width, height;
-        
-        if (!parser.extractFramePixels(i, pixelIndices, width, height)) {
+        // Frame indexée composée (partagée avec le cache, sans copie)
+        std::shared_ptr<const RbtDecodedFrame> frame = parser.getFrame(i);
+        if (!frame) {
             fprintf(stderr, "Error: Failed to extract frame %zu\n", i);
             continue;
         }
+        const int width = frame->width;
+        const int height = frame->height;
         
-        // Décomposer en couches (avec gestion d'erreur pour allocations)
+        // Décomposer en couches, suites opaques seulement (avec gestion d'erreur pour allocations)
         try {
-            RobotLayerFrame layer = decomposeRobotFrame(pixelIndices, globalPalette, width, height);
+            RobotLayerFrame layer = decomposeRobotFrame(frame->pixels, globalPalette, width, height, frame->spans);
             allLayers.push_back(std::move(layer));
         } catch (const std::bad_alloc& e) {
             fprintf(stderr, "Error: Memory allocation failed for frame %zu (%dx%d)\n", i, width, height);
@@ -432,8 +489,13 @@ bool processRbtFile(const std::string& inputPath, const std::string& outputDir,
         std::vector<uint8_t> rgbaImage(paddedPixelCount * 4, 0);  // Init noir transparent
         
         // Copier le canvas source vers le canvas final (copie 1:1 préservant toutes les positions)
-        for (int y = 0; y < h && y < maxHeight; ++y) {
-            for (int x = 0; x < w && x < maxWidth; ++x) {
+        // Seules les suites opaques sont visitées : le reste est déjà noir transparent
+        for (const ScummVMRobot::PixelSpan& span : layer.spans) {
+            const int y = span.y;
+            if (y >= h || y >= maxHeight) {
+                continue;
+            }
+            for (int x = span.x; x < span.x + span.length && x < w && x < maxWidth; ++x) {
                 const size_t srcIdx = y * w + x;
                 const size_t dstIdx = y * maxWidth + x;
                 
@@ -461,6 +523,7 @@ bool processRbtFile(const std::string& inputPath, const std::string& outputDir,
         }
         
         // Sauvegarder en PNG RGBA avec dimensions fixes
+        Perf::ScopedTimer pngTimer(Perf::Stage::PngEncode, rgbaImage.size());
         char framePath[512];
         snprintf(framePath, sizeof(framePath), "%s/frame_%04zu.png", framesDir.c_str(), i);
         if (!stbi_write_png(framePath, maxWidth, maxHeight, 4, rgbaImage.data(), maxWidth * 4)) {
@@ -489,6 +552,21 @@ bool processRbtFile(const std::string& inputPath, const std::string& outputDir,
     // Note: Le fichier MOV ProRes 4444 est généré par robot_mkv_exporter.cpp (Step 2bis)
     // Pas besoin de le regénérer ici (doublon supprimé)
     
+    // Atlas de sprites (cels uniques + table des frames)
+    if (exportAtlas) {
+        fprintf(stderr, "Building sprite atlas...\n");
+        AtlasExportConfig atlasConfig;
+        if (useCanvasMode) {
+            atlasConfig.hasPosition = true;
+            atlasConfig.positionX = robotPos.x;
+            atlasConfig.positionY = robotPos.y;
+        }
+        RobotAtlasExporter atlasExporter(atlasConfig);
+        if (!atlasExporter.exportAtlas(parser, outputDir + "/" + inputFilename)) {
+            fprintf(stderr, "Warning: Sprite atlas export failed\n");
+        }
+    }
+    
     // Générer le fichier de métadonnées
     fprintf(stderr, "Writing metadata...\n");
     FILE* metaFile = fopen(metadataPath.c_str(), "w");
@@ -543,6 +621,13 @@ bool processRbtFile(const std::string& inputPath, const std::string& outputDir,
         fprintf(stderr, "  ✓ Metadata: %s\n", metadataPath.c_str());
     }
     
+    if (Perf::enabled()) {
+        RbtParser::FrameCache::Stats cacheStats = parser.frameCacheStats();
+        fprintf(stderr, "  Frame cache: %llu hits, %llu misses, %llu evictions (%.1f MiB)\n",
+                (unsigned long long)cacheStats.hits, (unsigned long long)cacheStats.misses,
+                (unsigned long long)cacheStats.evictions, cacheStats.bytes / 1048576.0);
+    }
+    
     fclose(f);
     return true;
 }
@@ -551,6 +636,9 @@ int main(int argc, char* argv[]) {
     const char* codecStr = "h264";
     int forceCanvasWidth = 0;
     int forceCanvasHeight = 0;
+    MKVExportConfig exportConfig;
+    bool forceExport = false;
+    bool exportAtlas = false;
     
     // Parser les arguments
     for (int i = 1; i < argc; ++i) {
@@ -563,6 +651,25 @@ int main(int argc, char* argv[]) {
                 fprintf(stderr, "Error: Invalid canvas format '%s'. Use WIDTHxHEIGHT (e.g., 640x480)\n", argv[i + 1]);
                 return 1;
             }
+        } else if (strcmp(argv[i], "--jobs") == 0 && i + 1 < argc) {
+            exportConfig.parallelJobs = atoi(argv[++i]);
+            if (exportConfig.parallelJobs <= 0) {
+                exportConfig.parallelJobs = (int)Parallel::defaultJobCount();
+            }
+        } else if (strcmp(argv[i], "--segment-frames") == 0 && i + 1 < argc) {
+            exportConfig.segmentFrames = atoi(argv[++i]);
+            if (exportConfig.segmentFrames <= 0) {
+                fprintf(stderr, "Error: Invalid segment size '%s'\n", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--atlas") == 0) {
+            exportAtlas = true;
+        } else if (strcmp(argv[i], "--force") == 0) {
+            forceExport = true;
+        } else if (strcmp(argv[i], "--perf") == 0) {
+            Perf::setEnabled(true);
+        } else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            Perf::enableTrace(argv[++i]);
         } else if (argv[i][0] != '-') {
             // Codec name
             codecStr = argv[i];
@@ -581,6 +688,7 @@ int main(int argc, char* argv[]) {
         codec = MKVExportConfig::Codec::H264;
         codecStr = "h264";
     }
+    exportConfig.codec = codec;
     
     fprintf(stderr, "\n=== Robot Video Batch Export ===\n");
     fprintf(stderr, "Version: 2.5.0 (2024-12-04) - ScummVM Canvas Auto-Detect\n");
@@ -590,6 +698,10 @@ int main(int argc, char* argv[]) {
     } else {
         fprintf(stderr, "Canvas: Auto-detect (standard game resolutions)\n");
     }
+    if (exportConfig.parallelJobs > 1) {
+        fprintf(stderr, "Parallel encoding: %d job(s), %d-frame segments\n",
+                exportConfig.parallelJobs, exportConfig.segmentFrames);
+    }
     fprintf(stderr, "\n");
     
     // Vérifier si FFmpeg est disponible
@@ -625,9 +737,16 @@ int main(int argc, char* argv[]) {
     mkdir("output", 0755);
 #endif
 
+    // Manifeste d'export incrémental
+    ExportManifest manifest("output/export_manifest.json");
+    if (!forceExport && manifest.load()) {
+        fprintf(stderr, "Loaded export manifest: %s\n", manifest.path().c_str());
+    }
+    
     // Charger les positions des robots depuis RESSCI ou fichier cache
     fprintf(stderr, "\nLoading robot positions...\n");
     std::vector<RobotPosition> robotPositions;
+    SCI::RobotCoordinateCache coordinateCache("output/robot_coordinates_cache.json");
     
     // Essayer de charger depuis Resource/ ou Resource (plusieurs emplacements possibles)
     std::vector<std::string> resourceDirs = {"Resource", "Resource/", "resource", "RESOURCE"};
@@ -637,7 +756,19 @@ int main(int argc, char* argv[]) {
         DIR* dir = opendir(resDir.c_str());
         if (dir) {
             closedir(dir);
-            robotPositions = loadRobotPositionsFromRESSCI(resDir, "output");
+            
+            // Positions déjà extraites pour ces mêmes RESMAP/RESSCI ?
+            std::vector<SCI::RobotCoordinates> sciCoords;
+            if (!forceExport && coordinateCache.lookup(resDir, sciCoords)) {
+                fprintf(stderr, "  Reusing %zu robot position(s) from %s (%s unchanged)\n",
+                        sciCoords.size(), coordinateCache.path().c_str(), resDir.c_str());
+            } else {
+                sciCoords = scanRobotCoordinatesFromRESSCI(resDir, "output");
+                if (!sciCoords.empty()) {
+                    coordinateCache.store(resDir, sciCoords);
+                }
+            }
+            robotPositions = toRobotPositions(sciCoords);
             if (!robotPositions.empty()) {
                 foundRESSCI = true;
                 break;
@@ -652,6 +783,7 @@ int main(int argc, char* argv[]) {
     }
     
     fprintf(stderr, "Total robot positions loaded: %zu\n", robotPositions.size());
+    RobotPositionMap positionIndex = indexRobotPositions(robotPositions);
     fprintf(stderr, "\n");
     
     // Chercher le répertoire RBT (essayer RBT/ puis RBT_test/)
@@ -683,9 +815,30 @@ int main(int argc, char* argv[]) {
     }
     fprintf(stderr, "\n");
     
+    // Instrumentation : un rapport par Robot + total du batch
+    Perf::initFromEnvironment();
+    std::vector<std::pair<std::string, Perf::Snapshot>> perfRobots;
+    Perf::Snapshot perfBatch;
+    
     // Traiter chaque fichier
     size_t successCount = 0;
     size_t failCount = 0;
+    size_t skipCount = 0;
+    
+    // Configuration qui influence le contenu des sorties (comparée au manifeste)
+    const bool lossyCodec = (exportConfig.codec != MKVExportConfig::Codec::FFV1);
+    nlohmann::json configKey = {
+        {"codec", codecStr},
+        {"quality", exportConfig.quality},
+        {"canvas", {forceCanvasWidth, forceCanvasHeight}}
+    };
+    if (exportConfig.parallelJobs > 1 && lossyCodec) {
+        configKey["segmentFrames"] = exportConfig.segmentFrames;
+        configKey["gopSize"] = exportConfig.gopSize;
+    }
+    if (exportAtlas) {
+        configKey["atlas"] = true;
+    }
     
     for (size_t i = 0; i < rbtFiles.size(); ++i) {
         const std::string& inputPath = rbtFiles[i];
@@ -701,6 +854,21 @@ int main(int argc, char* argv[]) {
             filename = filename.substr(0, lastDot);
         }
         
+        // Robot inchangé depuis le dernier export ?
+        RobotPosition expectedPos = findRobotPosition(positionIndex, atoi(filename.c_str()));
+        nlohmann::json coordinatesKey = (expectedPos.robotId >= 0)
+            ? nlohmann::json{{"mode", "canvas"}, {"x", expectedPos.x}, {"y", expectedPos.y}}
+            : nlohmann::json{{"mode", "crop"}};
+        
+        InputFingerprint input;
+        bool haveFingerprint = manifest.fingerprintInput(filename, inputPath, input);
+        if (!forceExport && haveFingerprint &&
+            manifest.isUpToDate(filename, input, coordinatesKey, configKey)) {
+            skipCount++;
+            fprintf(stderr, "⏭ SKIP [%zu/%zu]: %s (unchanged)\n", i + 1, rbtFiles.size(), filename.c_str());
+            continue;
+        }
+        
         // Créer le sous-répertoire output/<rbt_name>/
         std::string fileOutputDir = "output/" + filename;
 #ifdef _WIN32
@@ -714,13 +882,46 @@ int main(int argc, char* argv[]) {
         fprintf(stderr, "========================================\n");
         
         // Traiter le fichier avec les positions des robots
-        if (processRbtFile(inputPath, fileOutputDir, codecStr, codec, forceCanvasWidth, forceCanvasHeight, robotPositions)) {
+        Perf::reset();
+        if (processRbtFile(inputPath, fileOutputDir, codecStr, exportConfig, forceCanvasWidth, forceCanvasHeight, positionIndex, exportAtlas)) {
             successCount++;
             fprintf(stderr, "✓ SUCCESS: %s\n", filename.c_str());
+            
+            if (haveFingerprint) {
+                ManifestEntry entry;
+                entry.input = input;
+                entry.coordinates = coordinatesKey;
+                entry.config = configKey;
+                entry.outputs = ExportManifest::collectOutputs(fileOutputDir);
+                char stamp[32];
+                time_t now = time(nullptr);
+                strftime(stamp, sizeof(stamp), "%Y-%m-%dT%H:%M:%S", localtime(&now));
+                entry.completed = stamp;
+                manifest.record(filename, entry);
+            }
         } else {
             failCount++;
             fprintf(stderr, "✗ FAILED: %s\n", filename.c_str());
+            manifest.forget(filename);
+        }
+        
+        // Sauvegarde après chaque Robot : reprise possible si le batch est interrompu
+        manifest.save();
+        
+        if (Perf::enabled()) {
+            Perf::Snapshot snap = Perf::snapshot();
+            Perf::printSummary(snap);
+            perfRobots.emplace_back(filename, snap);
+            perfBatch += snap;
+        }
+    }
+    
+    if (Perf::enabled()) {
+        const std::string reportPath = "output/perf_report.json";
+        if (Perf::writeReport(reportPath, perfRobots, perfBatch)) {
+            fprintf(stderr, "Perf report: %s\n", reportPath.c_str());
         }
+        Perf::writeTrace();
     }
     
     // Résumé final
@@ -729,6 +930,7 @@ int main(int argc, char* argv[]) {
     fprintf(stderr, "========================================\n");
     fprintf(stderr, "Total files: %zu\n", rbtFiles.size());
     fprintf(stderr, "  Success: %zu\n", successCount);
+    fprintf(stderr, "  Skipped (unchanged): %zu\n", skipCount);
     fprintf(stderr, "  Failed: %zu\n", failCount);
     fprintf(stderr, "\nAll outputs saved to: output/\n");
     
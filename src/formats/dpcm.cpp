@@ -57,3 +57,76 @@ void deDPCM16Mono(int16_t *out, const uint8_t *in, uint32_t numBytes, int16_t &s
         deDPCM16Channel(out++, sample, delta);
     }
 }
+
+void enDPCM16Mono(uint8_t *out, const int16_t *in, uint32_t numSamples, int16_t &sample) {
+    for (uint32_t i = 0; i < numSamples; i++) {
+        const int32_t target = in[i];
+        const int32_t diff = target - sample;
+        const uint32_t magnitude = (uint32_t)(diff < 0 ? -diff : diff);
+
+        // Table croissante : plus proche entrée par recherche dichotomique
+        int lo = 0, hi = 127;
+        while (lo < hi) {
+            int mid = (lo + hi) / 2;
+            if (tableDPCM16[mid] < magnitude) lo = mid + 1;
+            else hi = mid;
+        }
+        if (lo > 0 && magnitude - tableDPCM16[lo - 1] < tableDPCM16[lo] - magnitude) {
+            lo--;
+        }
+        // Éviter le débordement 16 bits (le décodeur le reproduirait en wraparound)
+        int32_t next = diff < 0 ? sample - tableDPCM16[lo] : sample + tableDPCM16[lo];
+        while (lo > 0 && (next > 32767 || next < -32768)) {
+            lo--;
+            next = diff < 0 ? sample - tableDPCM16[lo] : sample + tableDPCM16[lo];
+        }
+
+        uint8_t delta = (uint8_t)lo;
+        if (diff < 0 && lo != 0) delta |= 0x80;
+        deDPCM16Channel(&sample, sample, delta);
+        out[i] = delta;
+    }
+}
+
+// ----------------------------------------------------------------------------
+// Helper: interpolateChannel
+// Interpolation des échantillons manquants dans un canal
+// Basé sur ScummVM robot_decoder.cpp (interpolateChannel)
+// ----------------------------------------------------------------------------
+void interpolateChannel(int16_t *buffer, int32_t numSamples, const int8_t bufferIndex) {
+    if (numSamples <= 0) {
+        return;
+    }
+
+    int16_t *inBuffer, *outBuffer;
+    int16_t sample, previousSample;
+
+    // kEOSExpansion = 2 (expansion every-other-sample)
+    constexpr int kEOSExpansion = 2;
+
+    if (bufferIndex) {
+        // Canal ODD (indices impairs: 1, 3, 5...)
+        outBuffer = buffer + 1;
+        inBuffer = buffer + 2;
+        previousSample = sample = *buffer;
+        --numSamples;
+    } else {
+        // Canal EVEN (indices pairs: 0, 2, 4...)
+        outBuffer = buffer;
+        inBuffer = buffer + 1;
+        previousSample = sample = *inBuffer;
+    }
+
+    while (numSamples--) {
+        // Interpolation linéaire: moyenne des deux échantillons voisins
+        sample = (*inBuffer + previousSample) >> 1;
+        previousSample = *inBuffer;
+        *outBuffer = sample;
+        inBuffer += kEOSExpansion;
+        outBuffer += kEOSExpansion;
+    }
+
+    if (bufferIndex) {
+        *outBuffer = sample;
+    }
+}
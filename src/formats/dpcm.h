@@ -26,6 +26,27 @@
  */
 void deDPCM16Mono(int16_t *out, const uint8_t *in, uint32_t numBytes, int16_t &sample);
 
+/**
+ * Compression DPCM16 mono (inverse de deDPCM16Mono)
+ *
+ * Choisit pour chaque sample le delta de tableDPCM16 le plus proche, en
+ * suivant le sample reconstruit (pas de dérive). Sert au générateur de
+ * fichiers Robot synthétiques et aux benchmarks.
+ *
+ * @param sample  État du codeur (même valeur initiale qu'au décodage)
+ */
+void enDPCM16Mono(uint8_t *out, const int16_t *in, uint32_t numSamples, int16_t &sample);
+
+/**
+ * Interpolation des échantillons manquants d'un canal (EVEN ou ODD)
+ * Port de RobotAudioStream::interpolateChannel (ScummVM)
+ *
+ * @param buffer       Buffer entrelacé 22050 Hz
+ * @param numSamples   Nombre d'échantillons par canal
+ * @param bufferIndex  0 = canal EVEN, 1 = canal ODD
+ */
+void interpolateChannel(int16_t *buffer, int32_t numSamples, const int8_t bufferIndex);
+
 // Helper class for easier DPCM decoding
 class DPCMDecoder {
 public:
@@ -0,0 +1,238 @@
+#include "export_manifest.h"
+#include "../utils/atomic_file.h"
+#include "../utils/file_hash.h"
+#include "../utils/log.h"
+#include <algorithm>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+
+namespace fs = std::filesystem;
+
+namespace RobotExtractor {
+
+static const int kManifestVersion = 1;
+
+static int64_t fileMtime(const fs::path& p) {
+    std::error_code ec;
+    auto t = fs::last_write_time(p, ec);
+    if (ec) {
+        return 0;
+    }
+    return (int64_t)t.time_since_epoch().count();
+}
+
+static nlohmann::json outputToJson(const ManifestOutput& o) {
+    return {{"path", o.path}, {"size", o.size}, {"files", o.files}, {"mtime", o.mtime}, {"hash", o.hash}};
+}
+
+// Fichiers réguliers d'un dossier de frames, triés par nom
+static std::vector<fs::path> listOutputFiles(const fs::path& dir) {
+    std::vector<fs::path> files;
+    std::error_code ec;
+    for (const auto& f : fs::directory_iterator(dir, ec)) {
+        if (f.is_regular_file()) {
+            files.push_back(f.path());
+        }
+    }
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+// Taille, nombre de fichiers et date la plus récente d'une sortie, sans la relire
+static bool statOutput(const fs::path& p, ManifestOutput& out) {
+    std::error_code ec;
+    out.size = 0;
+    out.mtime = 0;
+    if (fs::is_directory(p, ec)) {
+        const std::vector<fs::path> files = listOutputFiles(p);
+        out.files = files.size();
+        for (size_t i = 0; i < files.size(); ++i) {
+            out.size += fs::file_size(files[i], ec);
+            if (ec) {
+                return false;
+            }
+            // Dates relatives à l'horloge du système de fichiers, éventuellement négatives
+            const int64_t mtime = fileMtime(files[i]);
+            out.mtime = i == 0 ? mtime : std::max(out.mtime, mtime);
+        }
+        return true;
+    }
+    out.files = 1;
+    out.size = fs::file_size(p, ec);
+    out.mtime = fileMtime(p);
+    return !ec;
+}
+
+// Hash du contenu ; pour un dossier, agrégé (nom + hash de chaque fichier, ordre trié)
+static bool hashOutput(const fs::path& p, std::string& hash) {
+    std::error_code ec;
+    if (fs::is_directory(p, ec)) {
+        uint64_t combined = FileHash::kSeed;
+        for (const auto& f : listOutputFiles(p)) {
+            uint64_t h = 0;
+            if (!FileHash::hashFile(f.string(), h)) {
+                continue;
+            }
+            std::string fname = f.filename().string();
+            combined = FileHash::hashBytes(fname.data(), fname.size(), combined);
+            combined = FileHash::hashBytes(&h, sizeof(h), combined);
+        }
+        hash = FileHash::toHex(combined);
+        return true;
+    }
+    uint64_t h = 0;
+    if (!FileHash::hashFile(p.string(), h)) {
+        return false;
+    }
+    hash = FileHash::toHex(h);
+    return true;
+}
+
+ExportManifest::ExportManifest(const std::string& path)
+    : m_path(path), m_root({{"version", kManifestVersion}, {"robots", nlohmann::json::object()}}) {
+}
+
+bool ExportManifest::load() {
+    std::ifstream file(m_path);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    nlohmann::json root = nlohmann::json::parse(file, nullptr, false);
+    if (root.is_discarded() || !root.is_object() ||
+        root.value("version", 0) != kManifestVersion ||
+        !root.contains("robots") || !root["robots"].is_object()) {
+        LOG_WARNING(Export, "Ignoring invalid manifest %s\n", m_path.c_str());
+        return false;
+    }
+
+    m_root = std::move(root);
+    return true;
+}
+
+bool ExportManifest::save() const {
+    // Un arrêt brutal laisse l'ancien manifeste intact
+    return Common::writeFileAtomic(m_path, m_root.dump(2) + "\n");
+}
+
+bool ExportManifest::fingerprintInput(const std::string& name, const std::string& path,
+                                      InputFingerprint& out) const {
+    std::error_code ec;
+    uint64_t size = fs::file_size(path, ec);
+    if (ec) {
+        return false;
+    }
+
+    out.path = path;
+    out.size = size;
+    out.mtime = fileMtime(path);
+
+    // Raccourci : même taille + même mtime → hash déjà connu
+    const auto& robots = m_root["robots"];
+    auto it = robots.find(name);
+    if (it != robots.end() && it->contains("input")) {
+        const auto& in = (*it)["input"];
+        if (in.value("size", (uint64_t)0) == out.size &&
+            in.value("mtime", (int64_t)0) == out.mtime &&
+            in.value("path", std::string()) == out.path) {
+            out.hash = in.value("hash", std::string());
+            if (!out.hash.empty()) {
+                return true;
+            }
+        }
+    }
+
+    uint64_t hash = 0;
+    if (!FileHash::hashFile(path, hash)) {
+        return false;
+    }
+    out.hash = FileHash::toHex(hash);
+    return true;
+}
+
+bool ExportManifest::isUpToDate(const std::string& name, const InputFingerprint& input,
+                                const nlohmann::json& coordinates, const nlohmann::json& config) const {
+    const auto& robots = m_root["robots"];
+    auto it = robots.find(name);
+    if (it == robots.end()) {
+        return false;
+    }
+
+    const auto& entry = *it;
+    if (!entry.contains("input") || entry["input"].value("hash", std::string()) != input.hash) {
+        return false;
+    }
+    if (entry.value("coordinates", nlohmann::json()) != coordinates ||
+        entry.value("config", nlohmann::json()) != config) {
+        return false;
+    }
+    if (!entry.contains("outputs") || !entry["outputs"].is_array() || entry["outputs"].empty()) {
+        return false;
+    }
+
+    // Sorties : présence, taille et nombre de fichiers ; même date = intacte,
+    // sinon le contenu est relu et comparé au hash enregistré
+    for (const auto& out : entry["outputs"]) {
+        fs::path p = out.value("path", std::string());
+        ManifestOutput current;
+        if (!statOutput(p, current) ||
+            current.files != out.value("files", (size_t)0) ||
+            current.size != out.value("size", (uint64_t)0)) {
+            return false;
+        }
+        if (current.mtime == out.value("mtime", (int64_t)0)) {
+            continue;
+        }
+        const std::string recorded = out.value("hash", std::string());
+        if (recorded.empty() || !hashOutput(p, current.hash) || current.hash != recorded) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void ExportManifest::record(const std::string& name, const ManifestEntry& entry) {
+    nlohmann::json outputs = nlohmann::json::array();
+    for (const auto& o : entry.outputs) {
+        outputs.push_back(outputToJson(o));
+    }
+
+    m_root["robots"][name] = {
+        {"input", {{"path", entry.input.path}, {"size", entry.input.size},
+                   {"mtime", entry.input.mtime}, {"hash", entry.input.hash}}},
+        {"coordinates", entry.coordinates},
+        {"config", entry.config},
+        {"outputs", outputs},
+        {"completed", entry.completed}
+    };
+}
+
+void ExportManifest::forget(const std::string& name) {
+    m_root["robots"].erase(name);
+}
+
+std::vector<ManifestOutput> ExportManifest::collectOutputs(const std::string& outputDir) {
+    std::vector<ManifestOutput> outputs;
+    std::error_code ec;
+
+    std::vector<fs::path> entries;
+    for (const auto& e : fs::directory_iterator(outputDir, ec)) {
+        entries.push_back(e.path());
+    }
+    std::sort(entries.begin(), entries.end());
+
+    for (const auto& p : entries) {
+        ManifestOutput out;
+        out.path = p.generic_string();
+        if (!statOutput(p, out) || !hashOutput(p, out.hash)) {
+            continue;
+        }
+        outputs.push_back(out);
+    }
+
+    return outputs;
+}
+
+} // namespace RobotExtractor
@@ -0,0 +1,97 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+namespace RobotExtractor {
+
+/**
+ * Empreinte d'un fichier source (.RBT)
+ *
+ * size/mtime servent de raccourci : si les deux correspondent au manifeste,
+ * le hash enregistré est réutilisé sans relire le fichier.
+ */
+struct InputFingerprint {
+    std::string path;
+    uint64_t size = 0;
+    int64_t mtime = 0;
+    std::string hash;
+};
+
+/**
+ * Fichier (ou dossier de frames) produit pour un Robot
+ */
+struct ManifestOutput {
+    std::string path;
+    uint64_t size = 0;   // Taille totale (somme des fichiers pour un dossier)
+    size_t files = 1;    // Nombre de fichiers (> 1 pour un dossier de frames)
+    int64_t mtime = 0;   // Date de modification la plus récente
+    std::string hash;
+};
+
+/**
+ * Entrée du manifeste pour un Robot exporté avec succès
+ */
+struct ManifestEntry {
+    InputFingerprint input;
+    nlohmann::json coordinates;  // Mode canvas/crop + position utilisée
+    nlohmann::json config;       // Codec, qualité, canvas forcé, segments...
+    std::vector<ManifestOutput> outputs;
+    std::string completed;       // Date de fin d'export (ISO 8601)
+};
+
+/**
+ * Manifeste d'export incrémental (output/export_manifest.json)
+ *
+ * Enregistre pour chaque Robot le hash de l'entrée, les coordonnées et la
+ * configuration utilisées ainsi que les hash des fichiers produits. Un Robot
+ * dont tout est identique est sauté au prochain lancement ; le manifeste est
+ * réécrit après chaque Robot, un batch interrompu reprend donc où il s'est arrêté.
+ */
+class ExportManifest {
+public:
+    explicit ExportManifest(const std::string& path);
+
+    /** Charge le manifeste (absent ou invalide = manifeste vide) */
+    bool load();
+
+    /** Écrit le manifeste (fichier temporaire + rename) */
+    bool save() const;
+
+    /**
+     * Calcule l'empreinte d'un fichier source, en réutilisant le hash
+     * enregistré pour `name` si taille et date de modification n'ont pas changé
+     */
+    bool fingerprintInput(const std::string& name, const std::string& path,
+                          InputFingerprint& out) const;
+
+    /**
+     * Vrai si `name` a déjà été exporté avec la même entrée, les mêmes
+     * coordonnées et la même configuration, et que ses sorties sont intactes :
+     * présentes, même taille et même nombre de fichiers, puis même date ou, à
+     * défaut, même hash (une sortie réécrite à l'identique reste valide)
+     */
+    bool isUpToDate(const std::string& name, const InputFingerprint& input,
+                    const nlohmann::json& coordinates, const nlohmann::json& config) const;
+
+    /** Enregistre (ou remplace) l'entrée d'un Robot */
+    void record(const std::string& name, const ManifestEntry& entry);
+
+    /** Retire un Robot (export échoué : il sera refait) */
+    void forget(const std::string& name);
+
+    /**
+     * Hash des fichiers produits dans outputDir : un ManifestOutput par
+     * fichier, un seul (agrégé) par sous-dossier
+     */
+    static std::vector<ManifestOutput> collectOutputs(const std::string& outputDir);
+
+    const std::string& path() const { return m_path; }
+
+private:
+    std::string m_path;
+    nlohmann::json m_root;
+};
+
+} // namespace RobotExtractor
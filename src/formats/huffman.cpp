@@ -0,0 +1,400 @@
+#include "huffman.h"
+#include <algorithm>
+#include <cstring>
+#include <queue>
+
+namespace {
+
+const int kTableBits = 12;
+
+enum EntryKind : uint8_t {
+    kEntryLeaf = 0,     // value = octet décodé
+    kEntryEscape,       // littéral de 8 bits à suivre
+    kEntryNode,         // code plus long que la table : reprendre au nœud value
+    kEntryEnd,          // échappement + terminateur
+    kEntryInvalid
+};
+
+struct TableEntry {
+    uint16_t value;
+    uint8_t length;     // Bits consommés
+    uint8_t kind;
+};
+
+// Lecteur MSB en premier, tampon de 64 bits aligné à gauche
+class HuffmanBitReader {
+public:
+    HuffmanBitReader(const uint8_t *data, size_t size) : _data(data), _size(size) {}
+
+    void refill() {
+        // Cas courant : 8 octets lisibles d'un coup, sans boucle
+        if (_pos + 8 <= _size) {
+            uint64_t word = 0;
+            for (int i = 0; i < 8; i++) {
+                word = (word << 8) | _data[_pos + i];
+            }
+            _bits |= word >> _nBits;
+            _pos += (63 - _nBits) >> 3;
+            _nBits |= 56;
+            return;
+        }
+        while (_nBits <= 56 && _pos < _size) {
+            _bits |= (uint64_t)_data[_pos++] << (56 - _nBits);
+            _nBits += 8;
+        }
+    }
+
+    // Complété par des zéros en fin de flux
+    uint32_t peek(int n) const { return (uint32_t)(_bits >> (64 - n)); }
+
+    // n <= available()
+    void skip(int n) {
+        _bits <<= n;
+        _nBits -= n;
+    }
+
+    bool consume(int n) {
+        if (n > _nBits) {
+            return false;
+        }
+        _bits <<= n;
+        _nBits -= n;
+        return true;
+    }
+
+    int available() const { return _nBits; }
+
+private:
+    const uint8_t *_data;
+    size_t _size;
+    size_t _pos = 0;
+    uint64_t _bits = 0;
+    int _nBits = 0;
+};
+
+class HuffmanTree {
+public:
+    bool load(const uint8_t *nodes, size_t count, uint16_t terminator) {
+        _nodes = nodes;
+        _count = count;
+        _terminator = terminator;
+        _table.assign(size_t(1) << kTableBits, TableEntry{0, 0, kEntryInvalid});
+        return fill(0, 0, 0);
+    }
+
+    const TableEntry &lookup(uint32_t bits) const { return _table[bits]; }
+
+    // Enfant d'un nœud interne : -1 = échappement, -2 = invalide
+    int child(size_t node, int bit) const {
+        const uint8_t links = _nodes[node * 2 + 1];
+        const size_t offset = bit ? (links & 0x0F) : (links >> 4);
+        if (offset == 0) {
+            return bit ? -1 : -2;
+        }
+        return node + offset < _count ? (int)(node + offset) : -2;
+    }
+
+    bool isLeaf(size_t node) const { return _nodes[node * 2 + 1] == 0; }
+    uint8_t value(size_t node) const { return _nodes[node * 2]; }
+
+private:
+    // Descente de l'arbre : chaque feuille, échappement ou nœud à la
+    // profondeur kTableBits couvre un intervalle de la table
+    bool fill(size_t node, uint32_t prefix, int depth) {
+        if (depth == kTableBits || isLeaf(node)) {
+            TableEntry entry;
+            entry.length = (uint8_t)depth;
+            entry.kind = isLeaf(node) ? kEntryLeaf : kEntryNode;
+            entry.value = isLeaf(node) ? value(node) : (uint16_t)node;
+            fillRange(prefix, depth, entry);
+            return true;
+        }
+        for (int bit = 0; bit < 2; bit++) {
+            const uint32_t childPrefix = (prefix << 1) | (uint32_t)bit;
+            const int next = child(node, bit);
+            if (next == -2) {
+                return false;
+            }
+            if (next == -1) {
+                fillEscape(childPrefix, depth + 1);
+            } else if (!fill((size_t)next, childPrefix, depth + 1)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Échappement court : le littéral qui suit tient aussi dans la table
+    void fillEscape(uint32_t prefix, int depth) {
+        if (depth + 8 > kTableBits) {
+            fillRange(prefix, depth, TableEntry{0, (uint8_t)depth, kEntryEscape});
+            return;
+        }
+        for (uint32_t literal = 0; literal < 256; literal++) {
+            const uint8_t kind = (literal | 0x100) == _terminator ? kEntryEnd : kEntryLeaf;
+            fillRange((prefix << 8) | literal, depth + 8, TableEntry{(uint16_t)literal, (uint8_t)(depth + 8), kind});
+        }
+    }
+
+    void fillRange(uint32_t prefix, int depth, const TableEntry &entry) {
+        const int shift = kTableBits - depth;
+        std::fill(_table.begin() + ((size_t)prefix << shift),
+                  _table.begin() + ((size_t)(prefix + 1) << shift), entry);
+    }
+
+    const uint8_t *_nodes = nullptr;
+    size_t _count = 0;
+    uint16_t _terminator = 0;
+    std::vector<TableEntry> _table;
+};
+
+} // namespace
+
+int64_t HuffmanDecompress(const uint8_t *in, uint32_t inSize, uint8_t *out, uint32_t outSize) {
+    if (inSize < 2) {
+        return -1;
+    }
+    const size_t nodeCount = in[0];
+    const uint16_t terminator = in[1] | 0x100;
+    if (nodeCount == 0 || 2 + nodeCount * 2 > inSize) {
+        return -1;
+    }
+
+    HuffmanTree tree;
+    if (!tree.load(in + 2, nodeCount, terminator)) {
+        return -1;
+    }
+
+    HuffmanBitReader r(in + 2 + nodeCount * 2, inSize - 2 - nodeCount * 2);
+    uint32_t wrote = 0;
+    while (wrote < outSize) {
+        r.refill();
+
+        // Chemin rapide : après refill, au moins 56 bits (hors fin de flux),
+        // soit 4 codes de la table sans recharger
+        if (r.available() >= 4 * kTableBits) {
+            int n = 0;
+            for (; n < 4 && wrote < outSize; n++) {
+                const TableEntry &entry = tree.lookup(r.peek(kTableBits));
+                if (entry.kind != kEntryLeaf) {
+                    break;
+                }
+                r.skip(entry.length);
+                out[wrote++] = (uint8_t)entry.value;
+            }
+            if (n == 4 || wrote == outSize) {
+                continue;
+            }
+        }
+
+        const TableEntry &entry = tree.lookup(r.peek(kTableBits));
+        if (entry.kind == kEntryInvalid || !r.consume(entry.length)) {
+            break;  // Code tronqué en fin de flux
+        }
+        if (entry.kind == kEntryEnd) {
+            break;
+        }
+
+        int symbol;
+        if (entry.kind == kEntryLeaf) {
+            symbol = entry.value;
+        } else {
+            // Code long : suite bit à bit depuis le nœud atteint (décalages
+            // toujours positifs, la descente se termine)
+            int node = entry.kind == kEntryNode ? (int)entry.value : -1;
+            while (node >= 0 && !tree.isLeaf((size_t)node)) {
+                if (r.available() == 0) {
+                    r.refill();
+                    if (r.available() == 0) {
+                        return wrote;
+                    }
+                }
+                const int bit = (int)r.peek(1);
+                r.consume(1);
+                node = tree.child((size_t)node, bit);
+            }
+            if (node == -2) {
+                return -1;
+            }
+            if (node >= 0) {
+                symbol = tree.value((size_t)node);
+            } else {
+                // Échappement : littéral de 8 bits, marqué 0x100 comme le terminateur
+                if (r.available() < 8) {
+                    r.refill();
+                }
+                if (r.available() < 8) {
+                    break;
+                }
+                symbol = (int)r.peek(8) | 0x100;
+                r.consume(8);
+                if (symbol == terminator) {
+                    break;
+                }
+            }
+        }
+        out[wrote++] = (uint8_t)symbol;
+    }
+
+    return wrote;
+}
+
+// --- Compression -------------------------------------------------------------
+
+namespace {
+
+class HuffmanBitWriter {
+public:
+    std::vector<uint8_t> _data;
+    uint32_t _bits = 0;
+    int _nBits = 0;
+
+    void putBits(uint32_t value, int n) {
+        for (int i = n - 1; i >= 0; --i) {
+            _bits = (_bits << 1) | ((value >> i) & 1);
+            if (++_nBits == 8) {
+                _data.push_back((uint8_t)_bits);
+                _bits = 0;
+                _nBits = 0;
+            }
+        }
+    }
+
+    void flush() {
+        if (_nBits > 0) {
+            _data.push_back((uint8_t)(_bits << (8 - _nBits)));
+            _bits = 0;
+            _nBits = 0;
+        }
+    }
+};
+
+struct BuildNode {
+    uint64_t weight;
+    int symbol;         // 0-255 feuille, 256 échappement, -1 interne
+    int left = -1, right = -1;
+};
+
+const int kEscapeSymbol = 256;
+const int kMaxLeaves = 8;
+
+} // namespace
+
+std::vector<uint8_t> HuffmanCompress(const uint8_t *in, uint32_t inSize) {
+    uint64_t freq[256] = {0};
+    for (uint32_t i = 0; i < inSize; i++) {
+        freq[in[i]]++;
+    }
+
+    // Feuilles : les kMaxLeaves octets les plus fréquents
+    int order[256];
+    for (int i = 0; i < 256; i++) {
+        order[i] = i;
+    }
+    std::stable_sort(order, order + 256, [&](int a, int b) { return freq[a] > freq[b]; });
+
+    // Au moins une feuille : la racine est toujours un nœud interne
+    bool isLeaf[256] = {false};
+    std::vector<BuildNode> nodes;
+    for (int i = 0; i < kMaxLeaves && (freq[order[i]] > 0 || nodes.empty()); i++) {
+        isLeaf[order[i]] = true;
+        nodes.push_back(BuildNode{freq[order[i]], order[i]});
+    }
+
+    // Terminateur : un octet absent, sinon une feuille (jamais échappée)
+    int terminator = order[0];
+    for (int i = 0; i < 256; i++) {
+        if (freq[i] == 0) {
+            terminator = i;
+            break;
+        }
+    }
+
+    uint64_t escapeWeight = 1;  // Marqueur de fin
+    for (int i = 0; i < 256; i++) {
+        if (!isLeaf[i]) {
+            escapeWeight += freq[i];
+        }
+    }
+    nodes.push_back(BuildNode{escapeWeight, kEscapeSymbol});
+
+    // Huffman classique ; l'échappement reste toujours à droite
+    auto heavier = [&](int a, int b) { return nodes[a].weight > nodes[b].weight; };
+    std::priority_queue<int, std::vector<int>, decltype(heavier)> queue(heavier);
+    for (int i = 0; i < (int)nodes.size(); i++) {
+        queue.push(i);
+    }
+    while (queue.size() > 1) {
+        int a = queue.top(); queue.pop();
+        int b = queue.top(); queue.pop();
+        if (nodes[a].symbol == kEscapeSymbol) {
+            std::swap(a, b);
+        }
+        nodes.push_back(BuildNode{nodes[a].weight + nodes[b].weight, -1, a, b});
+        queue.push((int)nodes.size() - 1);
+    }
+    const int root = queue.top();
+
+    // Disposition en largeur (l'échappement n'occupe pas de nœud) et codes
+    std::vector<int> layout;
+    std::vector<int> position(nodes.size(), -1);
+    uint32_t codes[257] = {0};
+    int lengths[257] = {0};
+    std::vector<uint32_t> nodeCode(nodes.size(), 0);
+    std::vector<int> nodeLength(nodes.size(), 0);
+    std::queue<int> pending;
+    pending.push(root);
+    while (!pending.empty()) {
+        const int n = pending.front();
+        pending.pop();
+        if (nodes[n].symbol >= 0) {
+            codes[nodes[n].symbol] = nodeCode[n];
+            lengths[nodes[n].symbol] = nodeLength[n];
+            if (nodes[n].symbol == kEscapeSymbol) {
+                continue;
+            }
+        }
+        position[n] = (int)layout.size();
+        layout.push_back(n);
+        const int children[2] = {nodes[n].left, nodes[n].right};
+        for (int bit = 0; bit < 2; bit++) {
+            if (children[bit] >= 0) {
+                nodeCode[children[bit]] = (nodeCode[n] << 1) | (uint32_t)bit;
+                nodeLength[children[bit]] = nodeLength[n] + 1;
+                pending.push(children[bit]);
+            }
+        }
+    }
+
+    HuffmanBitWriter w;
+    w._data.reserve(2 + layout.size() * 2 + inSize);
+    w._data.push_back((uint8_t)layout.size());
+    w._data.push_back((uint8_t)terminator);
+    for (int n : layout) {
+        if (nodes[n].symbol >= 0) {
+            w._data.push_back((uint8_t)nodes[n].symbol);
+            w._data.push_back(0);
+        } else {
+            const int left = position[nodes[n].left] - position[n];
+            const int right = nodes[nodes[n].right].symbol == kEscapeSymbol ? 0 : position[nodes[n].right] - position[n];
+            w._data.push_back(0);
+            w._data.push_back((uint8_t)((left << 4) | right));
+        }
+    }
+
+    auto putEscape = [&](int literal) {
+        w.putBits(codes[kEscapeSymbol], lengths[kEscapeSymbol]);
+        w.putBits((uint32_t)literal, 8);
+    };
+
+    for (uint32_t i = 0; i < inSize; i++) {
+        if (isLeaf[in[i]]) {
+            w.putBits(codes[in[i]], lengths[in[i]]);
+        } else {
+            putEscape(in[i]);
+        }
+    }
+    putEscape(terminator);
+    w.flush();
+    return w._data;
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+/**
+ * Décompression Huffman SCI (méthodes CM_HUFFMAN / CM_HUFFMAN_V56, étape
+ * Huffman de CM_RLE_HUFF), format de ScummVM DecompressorHuffman :
+ *
+ *   [0] nombre de nœuds N, [1] octet terminateur T, puis N nœuds de 2 octets
+ *   (valeur, décalages gauche << 4 | droite en nœuds) et le flux de bits
+ *   (MSB en premier). Un nœud de décalages nuls est une feuille ; un
+ *   décalage droit nul est un échappement suivi d'un littéral de 8 bits.
+ *   Le littéral T échappé termine le flux.
+ *
+ * Le décodage passe par une table indexée par les 12 prochains bits (feuille,
+ * échappement avec son littéral, ou nœud interne où reprendre), construite
+ * en une descente de l'arbre ; seuls les codes plus longs finissent bit à bit.
+ *
+ * @return Nombre d'octets écrits dans out, -1 si l'arbre est invalide
+ */
+int64_t HuffmanDecompress(const uint8_t *in, uint32_t inSize, uint8_t *out, uint32_t outSize);
+
+/**
+ * Compression Huffman au format lu par HuffmanDecompress : les 8 octets les
+ * plus fréquents sont codés par l'arbre, les autres par échappement. L'arbre
+ * tient en 16 nœuds, donc tous les décalages tiennent sur 4 bits.
+ * Sert aux benchmarks et aux vérifications aller-retour.
+ */
+std::vector<uint8_t> HuffmanCompress(const uint8_t *in, uint32_t inSize);
@@ -2,6 +2,7 @@
 #include <cstdint>
 #include <cstring>
 #include <cstdlib>
+#include <algorithm>
 
 // More faithful, bounds-checked memory port of ScummVM's DecompressorLZS
 class BitReader {
@@ -92,3 +93,121 @@ int LZSDecompress(const uint8_t *in, uint32_t inSize, uint8_t *out, uint32_t out
 
     return (wrote == outSize) ? 0 : 1;
 }
+
+// ----------------------------------------------------------------------------
+// Compression (inverse de LZSDecompress)
+// ----------------------------------------------------------------------------
+class BitWriter {
+public:
+    std::vector<uint8_t> _data;
+    uint32_t _bits = 0;
+    int _nBits = 0;
+
+    void putBits(uint32_t value, int n) {
+        for (int i = n - 1; i >= 0; --i) {
+            _bits = (_bits << 1) | ((value >> i) & 1);
+            if (++_nBits == 8) {
+                _data.push_back((uint8_t)_bits);
+                _bits = 0;
+                _nBits = 0;
+            }
+        }
+    }
+
+    void flush() {
+        if (_nBits > 0) {
+            _data.push_back((uint8_t)(_bits << (8 - _nBits)));
+            _bits = 0;
+            _nBits = 0;
+        }
+    }
+};
+
+static void putCompLen(BitWriter &w, uint32_t len) {
+    if (len <= 4) {
+        w.putBits(len - 2, 2);          // 00, 01, 10
+    } else if (len <= 7) {
+        w.putBits(0xC | (len - 5), 4);  // 1100, 1101, 1110
+    } else {
+        w.putBits(0xF, 4);
+        len -= 8;
+        while (len >= 0xF) {
+            w.putBits(0xF, 4);
+            len -= 0xF;
+        }
+        w.putBits(len, 4);
+    }
+}
+
+std::vector<uint8_t> LZSCompress(const uint8_t *in, uint32_t inSize) {
+    const uint32_t kWindow = 2047;
+    const uint32_t kMinMatch = 2;
+    const uint32_t kMaxMatch = 4096;
+    const int kMaxChain = 16;
+    const uint32_t kGoodMatch = 32;   // Assez long : inutile de parcourir le reste de la chaîne
+    const uint32_t kHashSize = 1u << 14;
+
+    BitWriter w;
+    w._data.reserve(inSize / 2 + 16);
+
+    // head[h] = dernière position + 1 de ce hash ; prev[i] = position précédente + 1
+    std::vector<uint32_t> head(kHashSize, 0);
+    std::vector<uint32_t> prev(inSize, 0);
+    auto hashAt = [&](uint32_t i) -> uint32_t {
+        return ((uint32_t)in[i] * 251u + in[i + 1]) & (kHashSize - 1);
+    };
+    auto insert = [&](uint32_t i) {
+        if (i + 1 < inSize) {
+            uint32_t h = hashAt(i);
+            prev[i] = head[h];
+            head[h] = i + 1;
+        }
+    };
+
+    uint32_t pos = 0;
+    while (pos < inSize) {
+        uint32_t bestLen = 0, bestOffs = 0;
+        if (pos + kMinMatch <= inSize) {
+            uint32_t candidate = head[hashAt(pos)];
+            const uint32_t maxLen = std::min(kMaxMatch, inSize - pos);
+            for (int chain = 0; candidate != 0 && chain < kMaxChain; ++chain) {
+                const uint32_t cand = candidate - 1;
+                const uint32_t offs = pos - cand;
+                if (offs > kWindow) break;
+                uint32_t len = 0;
+                while (len < maxLen && in[cand + len] == in[pos + len]) ++len;
+                // À longueur égale, un offset < 128 coûte 4 bits de moins
+                if (len > bestLen || (len == bestLen && offs < bestOffs)) {
+                    bestLen = len;
+                    bestOffs = offs;
+                    if (len == maxLen || len >= kGoodMatch) break;
+                }
+                candidate = prev[cand];
+            }
+        }
+
+        if (bestLen >= kMinMatch) {
+            w.putBits(1, 1);
+            if (bestOffs < 128) {
+                w.putBits(1, 1);
+                w.putBits(bestOffs, 7);
+            } else {
+                w.putBits(0, 1);
+                w.putBits(bestOffs, 11);
+            }
+            putCompLen(w, bestLen);
+            for (uint32_t i = 0; i < bestLen; ++i) insert(pos + i);
+            pos += bestLen;
+        } else {
+            w.putBits(0, 1);
+            w.putBits(in[pos], 8);
+            insert(pos);
+            ++pos;
+        }
+    }
+
+    // Marqueur de fin : copie, offset 7 bits = 0
+    w.putBits(0x180, 9);
+    w.flush();
+    return std::move(w._data);
+}
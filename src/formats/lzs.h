@@ -1,3 +1,14 @@
 #pragma once
 #include <cstdint>
+#include <vector>
 int LZSDecompress(const uint8_t *in, uint32_t inSize, uint8_t *out, uint32_t outSize);
+
+/**
+ * Compression LZS (STAC) au format lu par LZSDecompress / DecompressorLZS :
+ * littéral = 0 + octet, copie = 1 + offset (7 ou 11 bits) + longueur,
+ * terminé par le marqueur de fin (offset 7 bits nul).
+ *
+ * Recherche gloutonne par chaînes de hachage sur une fenêtre de 2047 octets.
+ * Sert au générateur de fichiers Robot synthétiques et aux benchmarks.
+ */
+std::vector<uint8_t> LZSCompress(const uint8_t *in, uint32_t inSize);
@@ -0,0 +1,312 @@
+#include "rbt_writer.h"
+#include "lzs.h"
+#include "dpcm.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+namespace RobotExtractor {
+
+// Disposition de l'en-tête (cf. RbtParser::parseHeader)
+static const size_t kHeaderSize = 60;
+static const size_t kPrimerHeaderSize = 14;
+static const size_t kAudioHeaderSize = 8;
+static const size_t kRunwaySamples = 8;
+static const size_t kCelHeaderSize = 22;
+static const size_t kChunkHeaderSize = 10;
+static const size_t kSectorSize = 2048;
+static const int kMaxCelsPerFrame = 10;
+
+static const uint16_t kCompressionLZS = 0;
+static const uint16_t kCompressionNone = 2;
+
+static void putU16(uint8_t* p, uint16_t v) {
+    p[0] = (uint8_t)(v & 0xFF);
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void putU32(uint8_t* p, uint32_t v) {
+    p[0] = (uint8_t)(v & 0xFF);
+    p[1] = (uint8_t)((v >> 8) & 0xFF);
+    p[2] = (uint8_t)((v >> 16) & 0xFF);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+/**
+ * HunkPalette à une seule palette, 256 couleurs au format RGB partagé
+ * (sharedUsed = 1), telle que lue par parseHeader
+ */
+static std::vector<uint8_t> buildHunkPalette(const std::vector<uint8_t>& paletteRGB) {
+    const size_t kHunkHeaderSize = 13;
+    const size_t kEntryHeaderSize = 22;
+    const size_t entryOffset = kHunkHeaderSize + 2;
+
+    std::vector<uint8_t> hunk(entryOffset + kEntryHeaderSize + 768, 0);
+    hunk[10] = 1;                                   // numPalettes
+    putU16(&hunk[kHunkHeaderSize], (uint16_t)entryOffset);
+
+    uint8_t* entry = &hunk[entryOffset];
+    entry[10] = 0;                                  // startColor
+    putU16(entry + 14, 256);                        // numColors
+    entry[16] = 1;                                  // used
+    entry[17] = 1;                                  // sharedUsed : RGB sans flag
+    std::copy_n(paletteRGB.begin(), std::min<size_t>(768, paletteRGB.size()), entry + kEntryHeaderSize);
+    return hunk;
+}
+
+/**
+ * Paquet DPCM16 d'un canal : 8 échantillons de runway (rampe de 0 vers le
+ * premier échantillon, ignorés à la lecture) puis les échantillons
+ */
+static std::vector<uint8_t> encodeAudioPacket(const std::vector<int16_t>& samples) {
+    std::vector<int16_t> withRunway(kRunwaySamples + samples.size());
+    const int first = samples.empty() ? 0 : samples.front();
+    for (size_t i = 0; i < kRunwaySamples; ++i) {
+        withRunway[i] = (int16_t)(first * (int)(i + 1) / (int)kRunwaySamples);
+    }
+    std::copy(samples.begin(), samples.end(), withRunway.begin() + kRunwaySamples);
+
+    std::vector<uint8_t> out(withRunway.size());
+    int16_t state = 0;  // Chaque paquet repart de 0 au décodage
+    enDPCM16Mono(out.data(), withRunway.data(), (uint32_t)withRunway.size(), state);
+    return out;
+}
+
+RbtWriter::RbtWriter(const RbtWriterConfig& config) : m_config(config) {
+}
+
+RbtWriter::~RbtWriter() {
+    if (m_file) {
+        fclose(m_file);
+    }
+}
+
+bool RbtWriter::fail(const char* message) {
+    fprintf(stderr, "Error: %s (%s)\n", message, m_path.c_str());
+    if (m_file) {
+        // Pas de fichier Robot à moitié écrit
+        fclose(m_file);
+        m_file = nullptr;
+        std::remove(m_path.c_str());
+    }
+    return false;
+}
+
+bool RbtWriter::writeBytes(const void* data, size_t size) {
+    if (size == 0) {
+        return true;
+    }
+    if (fwrite(data, 1, size, m_file) != size) {
+        return false;
+    }
+    m_bytesWritten += size;
+    return true;
+}
+
+bool RbtWriter::open(const std::string& path, uint16_t numFrames, const std::vector<uint8_t>& paletteRGB,
+                     const std::vector<int16_t>& evenPrimer, const std::vector<int16_t>& oddPrimer) {
+    m_path = path;
+    if (m_config.version != 5 && m_config.version != 6) {
+        return fail("Unsupported robot version (5 or 6)");
+    }
+    if (numFrames == 0) {
+        return fail("A robot needs at least one frame");
+    }
+
+    m_file = fopen(path.c_str(), "wb");
+    if (!m_file) {
+        return fail("Cannot create robot file");
+    }
+    m_numFrames = numFrames;
+    m_videoSizes.clear();
+    m_packetSizes.clear();
+    m_videoSizes.reserve(numFrames);
+    m_packetSizes.reserve(numFrames);
+    m_bytesWritten = 0;
+
+    // Primer : en-tête 14 octets puis données EVEN et ODD
+    std::vector<uint8_t> primer;
+    const bool hasPrimer = m_config.hasAudio && !evenPrimer.empty() && !oddPrimer.empty();
+    if (hasPrimer) {
+        primer.resize(kPrimerHeaderSize + evenPrimer.size() + oddPrimer.size());
+        putU32(&primer[0], (uint32_t)(evenPrimer.size() + oddPrimer.size()));
+        putU16(&primer[4], 0);  // Compression DPCM16
+        putU32(&primer[6], (uint32_t)evenPrimer.size());
+        putU32(&primer[10], (uint32_t)oddPrimer.size());
+        int16_t state = 0;
+        enDPCM16Mono(&primer[kPrimerHeaderSize], evenPrimer.data(), (uint32_t)evenPrimer.size(), state);
+        state = 0;
+        enDPCM16Mono(&primer[kPrimerHeaderSize + evenPrimer.size()], oddPrimer.data(),
+                     (uint32_t)oddPrimer.size(), state);
+        if (primer.size() > 0xFFFF) {
+            return fail("Audio primer too large");
+        }
+    }
+
+    const std::vector<uint8_t> palette = buildHunkPalette(paletteRGB);
+
+    // En-tête ; audioBlockSize, maxCelsPerFrame et maxCelArea sont complétés par finish()
+    uint8_t header[kHeaderSize] = {0};
+    putU16(header + 0, 0x16);
+    memcpy(header + 2, "SOL", 4);                   // 'S' 'O' 'L' '\0'
+    putU16(header + 6, m_config.version);
+    putU16(header + 10, 0);                         // primerZeroCompressFlag
+    putU16(header + 14, numFrames);
+    putU16(header + 16, (uint16_t)palette.size());
+    putU16(header + 18, (uint16_t)primer.size());   // primerReservedSize
+    putU16(header + 20, (uint16_t)m_config.xResolution);
+    putU16(header + 22, (uint16_t)m_config.yResolution);
+    header[24] = 1;                                 // hasPalette
+    header[25] = m_config.hasAudio ? 1 : 0;
+    putU16(header + 28, (uint16_t)m_config.frameRate);
+    putU16(header + 30, 0);                         // isHiRes
+    putU16(header + 32, 0);                         // maxSkippablePackets
+
+    if (!writeBytes(header, sizeof(header)) ||
+        !writeBytes(primer.data(), primer.size()) ||
+        !writeBytes(palette.data(), palette.size())) {
+        return fail("Cannot write robot header");
+    }
+
+    // Tables (remplies par finish()) + cues, puis alignement secteur
+    m_tablesPosition = ftell(m_file);
+    const size_t entrySize = (m_config.version == 5) ? 2 : 4;
+    const size_t tablesSize = 2 * entrySize * numFrames + 256 * 4 + 256 * 2;
+    size_t end = (size_t)m_tablesPosition + tablesSize;
+    if (end % kSectorSize) {
+        end += kSectorSize - end % kSectorSize;
+    }
+    std::vector<uint8_t> zeros(end - (size_t)m_tablesPosition, 0);
+    if (!writeBytes(zeros.data(), zeros.size())) {
+        return fail("Cannot write robot tables");
+    }
+    return true;
+}
+
+bool RbtWriter::addFrame(const std::vector<RbtWriterCel>& cels, const RbtWriterAudio& audio) {
+    if (!m_file) {
+        return false;
+    }
+    if (m_videoSizes.size() >= m_numFrames) {
+        return fail("More frames than announced");
+    }
+    if (cels.empty() || cels.size() > (size_t)kMaxCelsPerFrame) {
+        return fail("A frame needs 1 to 10 cels");
+    }
+
+    std::vector<uint8_t> record(2, 0);
+    putU16(record.data(), (uint16_t)cels.size());
+
+    for (const auto& cel : cels) {
+        const int sourceHeight = (cel.height * cel.verticalScale) / 100;
+        const size_t sourceSize = (size_t)cel.width * (size_t)sourceHeight;
+        if (cel.width == 0 || cel.height == 0 || cel.pixels.size() < sourceSize) {
+            return fail("Cel pixels do not match its dimensions");
+        }
+
+        std::vector<uint8_t> data = LZSCompress(cel.pixels.data(), (uint32_t)sourceSize);
+        uint16_t compression = kCompressionLZS;
+        if (data.size() >= sourceSize) {
+            data.assign(cel.pixels.begin(), cel.pixels.begin() + sourceSize);
+            compression = kCompressionNone;
+        }
+        // dataSize est un u16 : le cel (chunk compris) doit tenir dans 64 Ko
+        const size_t dataSize = kChunkHeaderSize + data.size();
+        if (dataSize > 0xFFFF) {
+            return fail("Cel data exceeds 65535 bytes, split the frame into more cels");
+        }
+
+        uint8_t header[kCelHeaderSize + kChunkHeaderSize] = {0};
+        header[0] = 100;                            // horizontalScale
+        header[1] = cel.verticalScale;
+        putU16(header + 2, cel.width);
+        putU16(header + 4, cel.height);
+        putU16(header + 10, cel.celX);
+        putU16(header + 12, cel.celY);
+        putU16(header + 14, (uint16_t)dataSize);
+        putU16(header + 16, 1);                     // numDataChunks
+        uint8_t* chunk = header + kCelHeaderSize;
+        putU32(chunk + 0, (uint32_t)data.size());
+        putU32(chunk + 4, (uint32_t)sourceSize);
+        putU16(chunk + 8, compression);
+
+        record.insert(record.end(), header, header + sizeof(header));
+        record.insert(record.end(), data.begin(), data.end());
+        m_maxCelArea = std::max(m_maxCelArea, (int32_t)((int32_t)cel.width * cel.height));
+    }
+    const uint32_t videoSize = (uint32_t)record.size();
+
+    if (m_config.hasAudio && !audio.samples.empty()) {
+        const std::vector<uint8_t> packet = encodeAudioPacket(audio.samples);
+        uint8_t audioHeader[kAudioHeaderSize];
+        putU32(audioHeader, (uint32_t)audio.audioPosition);
+        putU32(audioHeader + 4, (uint32_t)packet.size());
+        record.insert(record.end(), audioHeader, audioHeader + sizeof(audioHeader));
+        record.insert(record.end(), packet.begin(), packet.end());
+        m_audioBlockSize = (uint16_t)std::min<size_t>(0xFFFF, std::max<size_t>(m_audioBlockSize,
+                                                      kAudioHeaderSize + packet.size()));
+    }
+
+    if (m_config.version == 5 && record.size() > 0xFFFF) {
+        return fail("Record exceeds 65535 bytes, use version 6");
+    }
+    if (!writeBytes(record.data(), record.size())) {
+        return fail("Cannot write robot record");
+    }
+
+    m_videoSizes.push_back(videoSize);
+    m_packetSizes.push_back((uint32_t)record.size());
+    m_maxCelsPerFrame = std::max(m_maxCelsPerFrame, (int16_t)cels.size());
+    return true;
+}
+
+bool RbtWriter::finish() {
+    if (!m_file) {
+        return false;
+    }
+    if (m_videoSizes.size() != m_numFrames) {
+        return fail("Fewer frames than announced");
+    }
+
+    // Champs d'en-tête connus seulement à la fin
+    uint8_t b[4];
+    bool ok = fseek(m_file, 8, SEEK_SET) == 0;
+    putU16(b, m_audioBlockSize);
+    ok = ok && fwrite(b, 1, 2, m_file) == 2;
+    ok = ok && fseek(m_file, 34, SEEK_SET) == 0;
+    putU16(b, (uint16_t)m_maxCelsPerFrame);
+    ok = ok && fwrite(b, 1, 2, m_file) == 2;
+    for (int i = 0; i < 4 && ok; ++i) {
+        putU32(b, (uint32_t)m_maxCelArea);
+        ok = fwrite(b, 1, 4, m_file) == 4;
+    }
+
+    // Tables vidéo puis paquets (cue times / values laissés à 0)
+    std::vector<uint8_t> tables;
+    const size_t entrySize = (m_config.version == 5) ? 2 : 4;
+    tables.resize(2 * entrySize * m_numFrames);
+    uint8_t* p = tables.data();
+    for (const auto* table : {&m_videoSizes, &m_packetSizes}) {
+        for (uint32_t size : *table) {
+            if (entrySize == 2) {
+                putU16(p, (uint16_t)size);
+            } else {
+                putU32(p, size);
+            }
+            p += entrySize;
+        }
+    }
+    ok = ok && fseek(m_file, m_tablesPosition, SEEK_SET) == 0;
+    ok = ok && fwrite(tables.data(), 1, tables.size(), m_file) == tables.size();
+
+    if (fclose(m_file) != 0) {
+        ok = false;
+    }
+    m_file = nullptr;
+    if (!ok) {
+        fprintf(stderr, "Error: Cannot finalize robot file %s\n", m_path.c_str());
+    }
+    return ok;
+}
+
+} // namespace RobotExtractor
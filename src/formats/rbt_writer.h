@@ -0,0 +1,107 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace RobotExtractor {
+
+/**
+ * Cel à écrire dans un fichier Robot
+ *
+ * pixels contient width × sourceHeight indices, avec
+ * sourceHeight = height * verticalScale / 100 (lignes « écrasées » que le
+ * lecteur ré-étire, cf. expandCelVertically).
+ */
+struct RbtWriterCel {
+    uint16_t width = 0;
+    uint16_t height = 0;
+    uint8_t verticalScale = 100;
+    uint16_t celX = 0;
+    uint16_t celY = 0;
+    std::vector<uint8_t> pixels;
+};
+
+/**
+ * Paquet audio d'une frame : échantillons d'un seul canal (EVEN ou ODD)
+ * placés à audioPosition dans le flux entrelacé 22050 Hz. La parité de
+ * audioPosition désigne le canal.
+ */
+struct RbtWriterAudio {
+    int32_t audioPosition = 0;
+    std::vector<int16_t> samples;
+};
+
+/**
+ * Configuration du fichier Robot produit
+ */
+struct RbtWriterConfig {
+    uint16_t version = 5;       // 5 : tables de tailles u16, 6 : u32
+    int16_t frameRate = 10;
+    int16_t xResolution = 640;
+    int16_t yResolution = 480;
+    bool hasAudio = true;
+};
+
+/**
+ * Écriture de fichiers Robot (.RBT) v5/v6 little-endian, lisibles par RbtParser
+ * et par ScummVM
+ *
+ * Disposition produite :
+ *   en-tête 60 octets, primer audio (EVEN/ODD, DPCM16), HunkPalette,
+ *   table des tailles vidéo, table des tailles de paquets, 256 cue times,
+ *   256 cue values, alignement sur 2048 octets, puis un enregistrement
+ *   par frame : [nb cels][cels 22 octets + chunks LZS][en-tête audio 8 octets]
+ *   [8 octets de runway DPCM + échantillons]
+ *
+ * Les enregistrements sont écrits au fil de l'eau (mémoire bornée même pour
+ * des fichiers de plusieurs Go) ; les tables sont complétées par finish().
+ */
+class RbtWriter {
+public:
+    explicit RbtWriter(const RbtWriterConfig& config = RbtWriterConfig());
+    ~RbtWriter();
+
+    RbtWriter(const RbtWriter&) = delete;
+    RbtWriter& operator=(const RbtWriter&) = delete;
+
+    /**
+     * Crée le fichier et écrit en-tête, primer et palette
+     * @param numFrames   Nombre exact de frames qui seront ajoutées
+     * @param paletteRGB  256 couleurs RGB (768 octets)
+     * @param evenPrimer  Échantillons du primer EVEN (vide = pas de primer)
+     * @param oddPrimer   Échantillons du primer ODD
+     */
+    bool open(const std::string& path, uint16_t numFrames, const std::vector<uint8_t>& paletteRGB,
+              const std::vector<int16_t>& evenPrimer = {}, const std::vector<int16_t>& oddPrimer = {});
+
+    /**
+     * Ajoute l'enregistrement de la frame suivante (au plus 10 cels).
+     * Chaque cel est compressé en un chunk LZS (brut si LZS n'y gagne rien).
+     */
+    bool addFrame(const std::vector<RbtWriterCel>& cels, const RbtWriterAudio& audio = RbtWriterAudio());
+
+    /** Écrit les tables de tailles et complète l'en-tête, puis ferme le fichier */
+    bool finish();
+
+    /** Octets écrits jusqu'ici */
+    uint64_t bytesWritten() const { return m_bytesWritten; }
+
+private:
+    bool writeBytes(const void* data, size_t size);
+    bool fail(const char* message);
+
+    RbtWriterConfig m_config;
+    FILE* m_file = nullptr;
+    std::string m_path;
+    uint16_t m_numFrames = 0;
+    long m_tablesPosition = 0;
+    std::vector<uint32_t> m_videoSizes;
+    std::vector<uint32_t> m_packetSizes;
+    int16_t m_maxCelsPerFrame = 0;
+    int32_t m_maxCelArea = 0;
+    uint16_t m_audioBlockSize = 0;
+    uint64_t m_bytesWritten = 0;
+};
+
+} // namespace RobotExtractor
@@ -0,0 +1,396 @@
+#include "robot_atlas_exporter.h"
+#include "../core/rbt_parser.h"
+#include "../utils/file_hash.h"
+#include "../utils/indexed_png.h"
+#include "../utils/log.h"
+#include "../utils/perf_stats.h"
+#include <algorithm>
+#include <cassert>
+#include <climits>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <unordered_map>
+#include <nlohmann/json.hpp>
+
+using ScummVMRobot::RobotCel;
+
+namespace RobotExtractor {
+
+// Fréquence de l'audio Robot entrelacé (2 canaux DPCM à 11025 Hz)
+static const int kRobotAudioSampleRate = 22050;
+
+static int nextPowerOfTwo(int v) {
+    int p = 1;
+    while (p < v) {
+        p <<= 1;
+    }
+    return p;
+}
+
+namespace {
+
+/**
+ * Packer skyline bottom-left : la ligne d'horizon est une suite de segments
+ * (x, y, largeur) ; chaque rectangle est posé sur le segment qui minimise
+ * son bord bas, puis l'horizon est mis à jour. Quasi aussi dense qu'un
+ * maxrects pour des sprites triés par hauteur, en O(n) par insertion.
+ */
+class SkylinePacker {
+public:
+    SkylinePacker(int width, int height) : width_(width), height_(height) {
+        skyline_.push_back({0, 0, width});
+    }
+
+    bool insert(int w, int h, int& outX, int& outY) {
+        int bestBottom = INT32_MAX;
+        int bestWidth = INT32_MAX;
+        size_t bestIndex = SIZE_MAX;
+        int bestY = 0;
+
+        for (size_t i = 0; i < skyline_.size(); ++i) {
+            int y = fitAt(i, w, h);
+            if (y < 0) {
+                continue;
+            }
+            if (y + h < bestBottom || (y + h == bestBottom && skyline_[i].width < bestWidth)) {
+                bestBottom = y + h;
+                bestWidth = skyline_[i].width;
+                bestIndex = i;
+                bestY = y;
+            }
+        }
+        if (bestIndex == SIZE_MAX) {
+            return false;
+        }
+
+        outX = skyline_[bestIndex].x;
+        outY = bestY;
+        addLevel(bestIndex, outX, outY + h, w);
+        return true;
+    }
+
+private:
+    struct Node {
+        int x;
+        int y;
+        int width;
+    };
+
+    // Hauteur de pose d'un rectangle w×h à partir du segment index (-1 si hors page)
+    int fitAt(size_t index, int w, int h) const {
+        const int x = skyline_[index].x;
+        if (x + w > width_) {
+            return -1;
+        }
+        int y = skyline_[index].y;
+        int widthLeft = w;
+        for (size_t j = index; widthLeft > 0 && j < skyline_.size(); ++j) {
+            y = std::max(y, skyline_[j].y);
+            if (y + h > height_) {
+                return -1;
+            }
+            widthLeft -= skyline_[j].width;
+        }
+        return y;
+    }
+
+    void addLevel(size_t index, int x, int y, int w) {
+        skyline_.insert(skyline_.begin() + index, Node{x, y, w});
+
+        // Raccourcir (ou retirer) les segments recouverts par le nouveau
+        for (size_t i = index + 1; i < skyline_.size(); ) {
+            const Node& prev = skyline_[i - 1];
+            const int prevEnd = prev.x + prev.width;
+            if (skyline_[i].x >= prevEnd) {
+                break;
+            }
+            const int shrink = prevEnd - skyline_[i].x;
+            skyline_[i].x += shrink;
+            skyline_[i].width -= shrink;
+            if (skyline_[i].width > 0) {
+                break;
+            }
+            skyline_.erase(skyline_.begin() + i);
+        }
+
+        // Fusionner les segments voisins de même hauteur
+        for (size_t i = 0; i + 1 < skyline_.size(); ) {
+            if (skyline_[i].y == skyline_[i + 1].y) {
+                skyline_[i].width += skyline_[i + 1].width;
+                skyline_.erase(skyline_.begin() + i + 1);
+            } else {
+                ++i;
+            }
+        }
+    }
+
+    int width_;
+    int height_;
+    std::vector<Node> skyline_;
+};
+
+struct AtlasSprite {
+    uint16_t width = 0;
+    uint16_t height = 0;
+    std::vector<uint8_t> pixels;
+    int page = -1;
+    int x = 0;
+    int y = 0;
+};
+
+struct AtlasPage {
+    int width = 0;   // Étendue utilisée, arrondie à la puissance de 2
+    int height = 0;
+};
+
+struct FrameCelRef {
+    size_t sprite;
+    uint16_t celX;
+    uint16_t celY;
+};
+
+/**
+ * Range les sprites : une seule page si possible (plus petite puissance
+ * de 2 suffisante), sinon pages de côté maximal remplies dans l'ordre
+ */
+std::vector<AtlasPage> packSprites(std::vector<AtlasSprite>& sprites, int maxAtlasSize, int padding) {
+    std::vector<AtlasPage> pages;
+    if (sprites.empty()) {
+        return pages;
+    }
+
+    // Tri par hauteur puis largeur décroissantes (meilleur remplissage skyline)
+    std::vector<size_t> order(sprites.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        if (sprites[a].height != sprites[b].height) {
+            return sprites[a].height > sprites[b].height;
+        }
+        if (sprites[a].width != sprites[b].width) {
+            return sprites[a].width > sprites[b].width;
+        }
+        return a < b;
+    });
+
+    uint64_t totalArea = 0;
+    int largestSide = 1;
+    for (const auto& s : sprites) {
+        totalArea += (uint64_t)(s.width + padding) * (uint64_t)(s.height + padding);
+        largestSide = std::max({largestSide, s.width + padding, s.height + padding});
+    }
+
+    // Un sprite plus grand que maxAtlasSize impose une page plus grande
+    const int limit = std::max(nextPowerOfTwo(maxAtlasSize), nextPowerOfTwo(largestSide));
+    int side = nextPowerOfTwo(std::max(largestSide, (int)std::ceil(std::sqrt((double)totalArea))));
+
+    auto packInto = [&](int pageSide, bool allowNewPages) -> bool {
+        std::vector<SkylinePacker> packers;
+        packers.emplace_back(pageSide, pageSide);
+        for (size_t idx : order) {
+            AtlasSprite& s = sprites[idx];
+            const int w = s.width + padding;
+            const int h = s.height + padding;
+            bool placed = false;
+            for (size_t p = 0; p < packers.size() && !placed; ++p) {
+                if (packers[p].insert(w, h, s.x, s.y)) {
+                    s.page = (int)p;
+                    placed = true;
+                }
+            }
+            if (!placed) {
+                if (!allowNewPages) {
+                    return false;
+                }
+                // pageSide vaut limit, qui couvre le plus grand sprite : une
+                // page neuve l'accueille toujours
+                packers.emplace_back(pageSide, pageSide);
+                const bool fits = packers.back().insert(w, h, s.x, s.y);
+                assert(fits);
+                (void)fits;
+                s.page = (int)packers.size() - 1;
+            }
+        }
+        pages.assign(packers.size(), AtlasPage());
+        return true;
+    };
+
+    while (side < limit && !packInto(side, false)) {
+        side <<= 1;
+    }
+    // Pages multiples au côté maximal
+    if (side >= limit) {
+        packInto(limit, true);
+    }
+
+    // Réduire chaque page à l'étendue réellement utilisée (toujours en puissance de 2)
+    for (const auto& s : sprites) {
+        AtlasPage& page = pages[s.page];
+        page.width = std::max(page.width, s.x + (int)s.width);
+        page.height = std::max(page.height, s.y + (int)s.height);
+    }
+    for (auto& page : pages) {
+        page.width = nextPowerOfTwo(page.width);
+        page.height = nextPowerOfTwo(page.height);
+    }
+    return pages;
+}
+
+} // namespace
+
+RobotAtlasExporter::RobotAtlasExporter(const AtlasExportConfig& config)
+    : config_(config) {
+}
+
+bool RobotAtlasExporter::exportAtlas(RbtParser& parser, const std::string& basePath) {
+    const size_t numFrames = parser.getNumFrames();
+    const int frameRate = parser.getFrameRate() > 0 ? parser.getFrameRate() : 10;
+    const std::vector<uint8_t>& palette = parser.getPalette();
+    if (palette.size() < 768) {
+        LOG_ERROR(Export, "Atlas export requires a 256-color palette\n");
+        return false;
+    }
+
+    // 1. Décoder tous les cels et dédupliquer (hash du contenu + comparaison exacte)
+    std::vector<AtlasSprite> sprites;
+    std::unordered_multimap<uint64_t, size_t> spritesByHash;
+    std::vector<std::vector<FrameCelRef>> frames(numFrames);
+    std::vector<bool> frameOk(numFrames, true);
+    size_t totalCels = 0;
+
+    std::vector<RobotCel> cels;
+    for (size_t i = 0; i < numFrames; ++i) {
+        if (!parser.extractFrameCels(i, cels)) {
+            LOG_WARNING(Export, "Atlas: failed to decode frame %zu\n", i);
+            frameOk[i] = false;
+            continue;
+        }
+        for (auto& cel : cels) {
+            if (cel.width == 0 || cel.height == 0) {
+                continue;
+            }
+            totalCels++;
+
+            const uint16_t dims[2] = {cel.width, cel.height};
+            uint64_t hash = FileHash::hashBytes(dims, sizeof(dims));
+            hash = FileHash::hashBytes(cel.pixels.data(), cel.pixels.size(), hash);
+
+            size_t spriteIndex = SIZE_MAX;
+            auto range = spritesByHash.equal_range(hash);
+            for (auto it = range.first; it != range.second; ++it) {
+                const AtlasSprite& s = sprites[it->second];
+                if (s.width == cel.width && s.height == cel.height && s.pixels == cel.pixels) {
+                    spriteIndex = it->second;
+                    break;
+                }
+            }
+            if (spriteIndex == SIZE_MAX) {
+                spriteIndex = sprites.size();
+                AtlasSprite s;
+                s.width = cel.width;
+                s.height = cel.height;
+                s.pixels = std::move(cel.pixels);
+                sprites.push_back(std::move(s));
+                spritesByHash.emplace(hash, spriteIndex);
+            }
+            frames[i].push_back({spriteIndex, cel.celX, cel.celY});
+        }
+    }
+
+    if (sprites.empty()) {
+        LOG_ERROR(Export, "Atlas: no cel decoded\n");
+        return false;
+    }
+
+    // 2. Rangement dans les pages
+    std::vector<AtlasPage> pages = packSprites(sprites, config_.maxAtlasSize, config_.padding);
+
+    // 3. Écriture des pages (fond = index 255, transparent)
+    std::vector<std::string> pageFiles;
+    for (size_t p = 0; p < pages.size(); ++p) {
+        std::vector<uint8_t> image((size_t)pages[p].width * pages[p].height, 255);
+        for (const auto& s : sprites) {
+            if (s.page != (int)p) {
+                continue;
+            }
+            for (int y = 0; y < s.height; ++y) {
+                std::memcpy(&image[(size_t)(s.y + y) * pages[p].width + s.x],
+                            &s.pixels[(size_t)y * s.width], s.width);
+            }
+        }
+
+        Perf::ScopedTimer pngTimer(Perf::Stage::PngEncode, image.size());
+        std::string path = basePath + "_atlas" + (p == 0 ? std::string() : "_" + std::to_string(p)) + ".png";
+        if (!IndexedPng::write(path, pages[p].width, pages[p].height, image.data(), palette.data(), 255)) {
+            LOG_ERROR(Export, "Cannot write atlas %s\n", path.c_str());
+            return false;
+        }
+        size_t slash = path.find_last_of("/\\");
+        pageFiles.push_back(slash == std::string::npos ? path : path.substr(slash + 1));
+    }
+
+    // 4. Table JSON
+    nlohmann::json root;
+    root["version"] = 1;
+    root["frameRate"] = frameRate;
+    root["frameCount"] = numFrames;
+    root["transparentIndex"] = 255;
+    if (config_.hasPosition) {
+        root["position"] = {{"x", config_.positionX}, {"y", config_.positionY}};
+    }
+    root["audio"] = {{"present", parser.hasAudio()}, {"sampleRate", kRobotAudioSampleRate}};
+
+    nlohmann::json atlases = nlohmann::json::array();
+    for (size_t p = 0; p < pages.size(); ++p) {
+        atlases.push_back({{"file", pageFiles[p]}, {"width", pages[p].width}, {"height", pages[p].height}});
+    }
+    root["atlases"] = atlases;
+
+    nlohmann::json spriteArray = nlohmann::json::array();
+    for (size_t i = 0; i < sprites.size(); ++i) {
+        const auto& s = sprites[i];
+        spriteArray.push_back({{"id", i}, {"atlas", s.page}, {"x", s.x}, {"y", s.y},
+                               {"w", s.width}, {"h", s.height}});
+    }
+    root["sprites"] = spriteArray;
+
+    nlohmann::json frameArray = nlohmann::json::array();
+    for (size_t i = 0; i < numFrames; ++i) {
+        nlohmann::json frame;
+        frame["index"] = i;
+        frame["timeMs"] = (double)i * 1000.0 / frameRate;
+        if (parser.hasAudio()) {
+            frame["audio"] = {
+                {"sampleOffset", (int64_t)i * kRobotAudioSampleRate / frameRate},
+                {"packetPosition", parser.getFrameAudioPosition(i)},
+                {"packetSize", parser.getFrameAudioSize(i)}
+            };
+        }
+        nlohmann::json celArray = nlohmann::json::array();
+        for (const auto& ref : frames[i]) {
+            celArray.push_back({{"sprite", ref.sprite}, {"celX", ref.celX}, {"celY", ref.celY}});
+        }
+        frame["cels"] = celArray;
+        if (!frameOk[i]) {
+            frame["corrupt"] = true;
+        }
+        frameArray.push_back(frame);
+    }
+    root["frames"] = frameArray;
+
+    std::string jsonPath = basePath + "_atlas.json";
+    std::ofstream out(jsonPath, std::ios::trunc);
+    if (!out.is_open()) {
+        LOG_ERROR(Export, "Cannot write %s\n", jsonPath.c_str());
+        return false;
+    }
+    out << root.dump(2) << "\n";
+
+    LOG_INFO(Export, "  ✓ Atlas: %zu unique sprite(s) from %zu cel(s), %zu page(s) %dx%d\n",
+             sprites.size(), totalCels, pages.size(), pages[0].width, pages[0].height);
+    return out.good();
+}
+
+} // namespace RobotExtractor
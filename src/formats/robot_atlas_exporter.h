@@ -0,0 +1,51 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class RbtParser;
+
+namespace RobotExtractor {
+
+/**
+ * Configuration pour l'export atlas de sprites
+ */
+struct AtlasExportConfig {
+    int maxAtlasSize = 2048;  // Côté maximal d'une page (puissance de 2)
+    int padding = 1;          // Marge entre sprites (évite le bleeding au filtrage)
+
+    // Position Robot (mode canvas), reportée telle quelle dans le JSON
+    bool hasPosition = false;
+    int positionX = 0;
+    int positionY = 0;
+};
+
+/**
+ * Exporteur atlas : cels uniques d'un Robot + table des frames
+ *
+ * Tous les cels sont décodés (chemin createCel5), les cels identiques
+ * (mêmes dimensions et mêmes indices) ne sont stockés qu'une fois, puis
+ * rangés par un packer skyline dans une image indexée de côté puissance
+ * de 2 (plusieurs pages seulement si maxAtlasSize est dépassé).
+ *
+ * Fichiers produits :
+ *   <base>_atlas.png       PNG 8 bits indexé (palette Robot, index 255 transparent)
+ *   <base>_atlas_N.png     Pages supplémentaires éventuelles
+ *   <base>_atlas.json      Sprites (rect dans l'atlas) + frames (timing,
+ *                          offset audio, cels avec ancre celX/celY)
+ */
+class RobotAtlasExporter {
+public:
+    explicit RobotAtlasExporter(const AtlasExportConfig& config = AtlasExportConfig());
+
+    /**
+     * @param parser    Parser dont l'en-tête est déjà lu
+     * @param basePath  Chemin sans suffixe (ex: output/260/260)
+     */
+    bool exportAtlas(RbtParser& parser, const std::string& basePath);
+
+private:
+    AtlasExportConfig config_;
+};
+
+} // namespace RobotExtractor
@@ -1,12 +1,16 @@
 #include "robot_mkv_exporter.h"
 #include "../core/scummvm_robot_helpers.h"
 #include "../include/stb_image_write.h"
+#include "../utils/log.h"
+#include "../utils/parallel_for.h"
+#include "../utils/perf_stats.h"
 #include <sstream>
 #include <cstdlib>
 #include <cstring>
 #include <climits>
 #include <sys/stat.h>
 #include <ctime>
+#include <algorithm>
 
 namespace RobotExtractor {
 
@@ -16,6 +20,76 @@ RobotMKVExporter::RobotMKVExporter(const MKVExportConfig& config)
     : config_(config) {
 }
 
+// Visite les pixels (x, y) d'une frame : uniquement ses suites opaques quand
+// elles sont connues, les tampons de sortie valant déjà la couleur transparente
+template <typename Fn>
+static void forEachFramePixel(const RobotLayerFrame& layer, Fn&& fn) {
+    if (layer.spansValid) {
+        for (const PixelSpan& span : layer.spans) {
+            for (int x = span.x; x < span.x + span.length; ++x) {
+                fn(x, (int)span.y);
+            }
+        }
+        return;
+    }
+    for (int y = 0; y < layer.height; ++y) {
+        for (int x = 0; x < layer.width; ++x) {
+            fn(x, y);
+        }
+    }
+}
+
+// Lance une commande ffmpeg (temps mur imputé à l'étape Ffmpeg)
+static int runFfmpeg(const std::string& command) {
+    Perf::ScopedTimer timer(Perf::Stage::Ffmpeg);
+    return system(command.c_str());
+}
+
+// Classification des types de pixels Robot (Sierra SCI)
+// Référence: ScummVM engines/sci/graphics/robot.cpp
+static const uint8_t REMAP_START_PC = 236;
+static const uint8_t REMAP_END = 254;
+// SKIP_COLOR maintenant défini dans scummvm_robot_helpers.h
+
+static inline void decomposePixel(RobotLayerFrame& frame, size_t i, uint8_t paletteIndex,
+                                  const std::vector<uint8_t>& palette) {
+    if (isTransparentPixel(paletteIndex)) {
+        // Type 3: SKIP - Pixel transparent
+        frame.alpha[i] = 0;  // Transparent
+        frame.base_r[i] = 0;
+        frame.base_g[i] = 0;
+        frame.base_b[i] = 0;
+        frame.remap_mask[i] = 0;
+    }
+    else if (paletteIndex >= REMAP_START_PC && paletteIndex <= REMAP_END) {
+        // Type 2: REMAP - Zone de recoloration (236-254)
+        frame.alpha[i] = 255;  // Opaque
+        frame.remap_mask[i] = 255;  // Marquer comme remap
+        
+        // Stocker la couleur RGB du pixel remap
+        size_t palIdx = paletteIndex * 3;
+        frame.remap_color_r[i] = palette[palIdx + 0];
+        frame.remap_color_g[i] = palette[palIdx + 1];
+        frame.remap_color_b[i] = palette[palIdx + 2];
+        
+        // Pas de couleur base pour ce pixel
+        frame.base_r[i] = 0;
+        frame.base_g[i] = 0;
+        frame.base_b[i] = 0;
+    }
+    else {
+        // Type 1: BASE - Couleur fixe opaque (0-235)
+        frame.alpha[i] = 255;  // Opaque
+        frame.remap_mask[i] = 0;  // Pas de remap
+        
+        // Stocker la couleur RGB base
+        size_t palIdx = paletteIndex * 3;
+        frame.base_r[i] = palette[palIdx + 0];
+        frame.base_g[i] = palette[palIdx + 1];
+        frame.base_b[i] = palette[palIdx + 2];
+    }
+}
+
 RobotLayerFrame decomposeRobotFrame(
     const std::vector<uint8_t>& pixelIndices,
     const std::vector<uint8_t>& palette,
@@ -24,52 +98,44 @@ RobotLayerFrame decomposeRobotFrame(
 ) {
     RobotLayerFrame frame(width, height);
     const size_t pixelCount = width * height;
-    
-    // Classification des types de pixels Robot (Sierra SCI)
-    // Référence: ScummVM engines/sci/graphics/robot.cpp
-    const uint8_t REMAP_START_PC = 236;
-    const uint8_t REMAP_END = 254;
-    // SKIP_COLOR maintenant défini dans scummvm_robot_helpers.h
+    Perf::ScopedTimer timer(Perf::Stage::Decompose, pixelCount);
+    timer.setBytesOut(pixelCount * 8);  // 8 plans de RobotLayerFrame
     
     for (size_t i = 0; i < pixelCount; ++i) {
-        uint8_t paletteIndex = pixelIndices[i];
-        
-        if (isTransparentPixel(paletteIndex)) {
-            // Type 3: SKIP - Pixel transparent
-            frame.alpha[i] = 0;  // Transparent
-            frame.base_r[i] = 0;
-            frame.base_g[i] = 0;
-            frame.base_b[i] = 0;
-            frame.remap_mask[i] = 0;
-        }
-        else if (paletteIndex >= REMAP_START_PC && paletteIndex <= REMAP_END) {
-            // Type 2: REMAP - Zone de recoloration (236-254)
-            frame.alpha[i] = 255;  // Opaque
-            frame.remap_mask[i] = 255;  // Marquer comme remap
-            
-            // Stocker la couleur RGB du pixel remap
-            size_t palIdx = paletteIndex * 3;
-            frame.remap_color_r[i] = palette[palIdx + 0];
-            frame.remap_color_g[i] = palette[palIdx + 1];
-            frame.remap_color_b[i] = palette[palIdx + 2];
-            
-            // Pas de couleur base pour ce pixel
-            frame.base_r[i] = 0;
-            frame.base_g[i] = 0;
-            frame.base_b[i] = 0;
+        decomposePixel(frame, i, pixelIndices[i], palette);
+    }
+    
+    return frame;
+}
+
+RobotLayerFrame decomposeRobotFrame(
+    const std::vector<uint8_t>& pixelIndices,
+    const std::vector<uint8_t>& palette,
+    int width,
+    int height,
+    const std::vector<PixelSpan>& spans
+) {
+    RobotLayerFrame frame(width, height);
+    std::fill(frame.alpha.begin(), frame.alpha.end(), 0);  // Hors suites : transparent
+    size_t opaqueCount = 0;
+    for (const PixelSpan& span : spans) {
+        opaqueCount += span.length;
+    }
+    Perf::ScopedTimer timer(Perf::Stage::Decompose, opaqueCount);
+    timer.setBytesOut(opaqueCount * 8);
+    
+    frame.spans.reserve(spans.size());
+    for (const PixelSpan& span : spans) {
+        if (span.y >= height || span.x + span.length > width) {
+            continue;  // Suite hors de la frame
         }
-        else {
-            // Type 1: BASE - Couleur fixe opaque (0-235)
-            frame.alpha[i] = 255;  // Opaque
-            frame.remap_mask[i] = 0;  // Pas de remap
-            
-            // Stocker la couleur RGB base
-            size_t palIdx = paletteIndex * 3;
-            frame.base_r[i] = palette[palIdx + 0];
-            frame.base_g[i] = palette[palIdx + 1];
-            frame.base_b[i] = palette[palIdx + 2];
+        const size_t rowStart = (size_t)span.y * width + span.x;
+        for (size_t i = rowStart; i < rowStart + span.length; ++i) {
+            decomposePixel(frame, i, pixelIndices[i], palette);
         }
+        frame.spans.push_back(span);
     }
+    frame.spansValid = true;
     
     return frame;
 }
@@ -82,7 +148,7 @@ bool RobotMKVExporter::exportMultiTrack(
     int canvasHeight
 ) {
     if (layers.empty()) {
-        fprintf(stderr, "Error: no layers to export\n");
+        LOG_ERROR(Export, "no layers to export\n");
         return false;
     }
     
@@ -109,14 +175,24 @@ bool RobotMKVExporter::exportMultiTrack(
             int minX = layer.width, minY = layer.height;
             int maxX = -1, maxY = -1;
             
-            for (int y = 0; y < layer.height; ++y) {
-                for (int x = 0; x < layer.width; ++x) {
-                    size_t idx = y * layer.width + x;
-                    if (layer.alpha[idx] > 0) {  // Pixel visible
-                        if (x < minX) minX = x;
-                        if (x > maxX) maxX = x;
-                        if (y < minY) minY = y;
-                        if (y > maxY) maxY = y;
+            if (layer.spansValid) {
+                // Suites opaques : bornes directes, sans parcourir la frame
+                for (const PixelSpan& span : layer.spans) {
+                    minX = std::min(minX, (int)span.x);
+                    maxX = std::max(maxX, span.x + span.length - 1);
+                    minY = std::min(minY, (int)span.y);
+                    maxY = std::max(maxY, (int)span.y);
+                }
+            } else {
+                for (int y = 0; y < layer.height; ++y) {
+                    for (int x = 0; x < layer.width; ++x) {
+                        size_t idx = y * layer.width + x;
+                        if (layer.alpha[idx] > 0) {  // Pixel visible
+                            if (x < minX) minX = x;
+                            if (x > maxX) maxX = x;
+                            if (y < minY) minY = y;
+                            if (y > maxY) maxY = y;
+                        }
                     }
                 }
             }
@@ -150,13 +226,13 @@ bool RobotMKVExporter::exportMultiTrack(
     for (size_t i = 0; i < numFrames; ++i) {
         if (layers[i].width != w || layers[i].height != h) {
             hasVariableResolution = true;
-            fprintf(stderr, "Info: Frame %zu has resolution %dx%d (max is %dx%d)\n", 
-                    i, layers[i].width, layers[i].height, w, h);
+            LOG_INFO(Export, "Frame %zu has resolution %dx%d (max is %dx%d)\n",
+                     i, layers[i].width, layers[i].height, w, h);
         }
     }
     
     if (hasVariableResolution) {
-        fprintf(stderr, "Info: Video has variable frame sizes - will pad to max resolution %dx%d\n", w, h);
+        LOG_INFO(Export, "Video has variable frame sizes - will pad to max resolution %dx%d\n", w, h);
     }
     
     fprintf(stderr, "\n=== Exporting Multi-Track MKV ===\n");
@@ -209,103 +285,103 @@ bool RobotMKVExporter::exportMultiTrack(
         std::vector<uint8_t> luminanceRGB(maxPixelCount * 3, 0);  // Noir par défaut
         
         // Copier les données de la frame en appliquant le crop offset
-        for (int y = 0; y < frameHeight; ++y) {
-            for (int x = 0; x < frameWidth; ++x) {
-                const size_t srcIdx = y * frameWidth + x;
-                
-                int dstX, dstY;
-                if (isCanvasMode) {
-                    // Mode canvas: les pixels sont déjà positionnés correctement dans le layer
-                    // (le positionnement a été fait lors de la création des frames)
-                    dstX = x;
-                    dstY = y;
-                } else {
-                    // Mode tight crop: appliquer le crop offset
-                    dstX = x - cropOffsetX;
-                    dstY = y - cropOffsetY;
-                }
-                
-                if (dstX < 0 || dstX >= w || dstY < 0 || dstY >= h) {
-                    continue;  // Pixel en dehors du canvas/bbox
-                }
-                
-                const size_t dstIdx = dstY * w + dstX;
-                
-                // BASE: Pixels opaques non-remap (RGB complet)
-                if (layer.remap_mask[srcIdx] == 0 && layer.alpha[srcIdx] == 255) {
-                    baseRGB[dstIdx * 3 + 0] = layer.base_r[srcIdx];
-                    baseRGB[dstIdx * 3 + 1] = layer.base_g[srcIdx];
-                    baseRGB[dstIdx * 3 + 2] = layer.base_b[srcIdx];
-                }
-                
-                // REMAP: Pixels de recoloration (RGB complet)
-                if (layer.remap_mask[srcIdx] == 255 && layer.alpha[srcIdx] == 255) {
-                    remapRGB[dstIdx * 3 + 0] = layer.remap_color_r[srcIdx];
-                    remapRGB[dstIdx * 3 + 1] = layer.remap_color_g[srcIdx];
-                    remapRGB[dstIdx * 3 + 2] = layer.remap_color_b[srcIdx];
-                }
-                
-                // ALPHA: Transparence (255 = skip, 0 = opaque)
-                alphaGray[dstIdx] = (layer.alpha[srcIdx] == 0) ? 255 : 0;
-                
-                // LUMINANCE: Conversion RGB → Y (ITU-R BT.601)
-                uint8_t finalR, finalG, finalB;
-                if (layer.alpha[srcIdx] == 0) {
-                    // Pixel skip = noir
-                    finalR = finalG = finalB = 0;
-                } else if (layer.remap_mask[srcIdx] == 255) {
-                    // Pixel remap
-                    finalR = layer.remap_color_r[srcIdx];
-                    finalG = layer.remap_color_g[srcIdx];
-                    finalB = layer.remap_color_b[srcIdx];
-                } else {
-                    // Pixel base
-                    finalR = layer.base_r[srcIdx];
-                    finalG = layer.base_g[srcIdx];
-                    finalB = layer.base_b[srcIdx];
-                }
-                
-                // Formule de luminance standard (BT.601)
-                uint8_t Y = (uint8_t)(0.299f * finalR + 0.587f * finalG + 0.114f * finalB);
-                luminanceRGB[dstIdx * 3 + 0] = Y;
-                luminanceRGB[dstIdx * 3 + 1] = Y;
-                luminanceRGB[dstIdx * 3 + 2] = Y;
+        forEachFramePixel(layer, [&](int x, int y) {
+            const size_t srcIdx = y * frameWidth + x;
+            
+            int dstX, dstY;
+            if (isCanvasMode) {
+                // Mode canvas: les pixels sont déjà positionnés correctement dans le layer
+                // (le positionnement a été fait lors de la création des frames)
+                dstX = x;
+                dstY = y;
+            } else {
+                // Mode tight crop: appliquer le crop offset
+                dstX = x - cropOffsetX;
+                dstY = y - cropOffsetY;
             }
-        }
+            
+            if (dstX < 0 || dstX >= w || dstY < 0 || dstY >= h) {
+                return;  // Pixel en dehors du canvas/bbox
+            }
+            
+            const size_t dstIdx = dstY * w + dstX;
+            
+            // BASE: Pixels opaques non-remap (RGB complet)
+            if (layer.remap_mask[srcIdx] == 0 && layer.alpha[srcIdx] == 255) {
+                baseRGB[dstIdx * 3 + 0] = layer.base_r[srcIdx];
+                baseRGB[dstIdx * 3 + 1] = layer.base_g[srcIdx];
+                baseRGB[dstIdx * 3 + 2] = layer.base_b[srcIdx];
+            }
+            
+            // REMAP: Pixels de recoloration (RGB complet)
+            if (layer.remap_mask[srcIdx] == 255 && layer.alpha[srcIdx] == 255) {
+                remapRGB[dstIdx * 3 + 0] = layer.remap_color_r[srcIdx];
+                remapRGB[dstIdx * 3 + 1] = layer.remap_color_g[srcIdx];
+                remapRGB[dstIdx * 3 + 2] = layer.remap_color_b[srcIdx];
+            }
+            
+            // ALPHA: Transparence (255 = skip, 0 = opaque)
+            alphaGray[dstIdx] = (layer.alpha[srcIdx] == 0) ? 255 : 0;
+            
+            // LUMINANCE: Conversion RGB → Y (ITU-R BT.601)
+            uint8_t finalR, finalG, finalB;
+            if (layer.alpha[srcIdx] == 0) {
+                // Pixel skip = noir
+                finalR = finalG = finalB = 0;
+            } else if (layer.remap_mask[srcIdx] == 255) {
+                // Pixel remap
+                finalR = layer.remap_color_r[srcIdx];
+                finalG = layer.remap_color_g[srcIdx];
+                finalB = layer.remap_color_b[srcIdx];
+            } else {
+                // Pixel base
+                finalR = layer.base_r[srcIdx];
+                finalG = layer.base_g[srcIdx];
+                finalB = layer.base_b[srcIdx];
+            }
+            
+            // Formule de luminance standard (BT.601)
+            uint8_t Y = (uint8_t)(0.299f * finalR + 0.587f * finalG + 0.114f * finalB);
+            luminanceRGB[dstIdx * 3 + 0] = Y;
+            luminanceRGB[dstIdx * 3 + 1] = Y;
+            luminanceRGB[dstIdx * 3 + 2] = Y;
+        });
         
         // Écrire les 4 PNG à la résolution MAXIMALE (avec padding si nécessaire)
+        Perf::ScopedTimer pngTimer(Perf::Stage::PngEncode, (uint64_t)w * h * (3 + 3 + 1 + 3));
         char filename[512];
         
         snprintf(filename, sizeof(filename), "%s/frame_%04zu.png", tempDirBase.c_str(), frameIdx);
         int result = stbi_write_png(filename, w, h, 3, baseRGB.data(), w * 3);
         if (!result) {
-            fprintf(stderr, "\nError: stbi_write_png failed for base layer (frame %zu)\n", frameIdx);
-            fprintf(stderr, "       File: %s\n", filename);
-            fprintf(stderr, "       Max Resolution: %dx%d, Frame Resolution: %dx%d\n", w, h, frameWidth, frameHeight);
+            LOG_ERROR(Export, "\nstbi_write_png failed for base layer (frame %zu)\n"
+                      "       File: %s\n"
+                      "       Max Resolution: %dx%d, Frame Resolution: %dx%d\n",
+                      frameIdx, filename, w, h, frameWidth, frameHeight);
             return false;
         }
         
         snprintf(filename, sizeof(filename), "%s/frame_%04zu.png", tempDirRemap.c_str(), frameIdx);
         result = stbi_write_png(filename, w, h, 3, remapRGB.data(), w * 3);
         if (!result) {
-            fprintf(stderr, "\nError: stbi_write_png failed for remap layer (frame %zu)\n", frameIdx);
-            fprintf(stderr, "       File: %s\n", filename);
+            LOG_ERROR(Export, "\nstbi_write_png failed for remap layer (frame %zu)\n"
+                      "       File: %s\n", frameIdx, filename);
             return false;
         }
         
         snprintf(filename, sizeof(filename), "%s/frame_%04zu.png", tempDirAlpha.c_str(), frameIdx);
         result = stbi_write_png(filename, w, h, 1, alphaGray.data(), w);
         if (!result) {
-            fprintf(stderr, "\nError: stbi_write_png failed for alpha layer (frame %zu)\n", frameIdx);
-            fprintf(stderr, "       File: %s\n", filename);
+            LOG_ERROR(Export, "\nstbi_write_png failed for alpha layer (frame %zu)\n"
+                      "       File: %s\n", frameIdx, filename);
             return false;
         }
         
         snprintf(filename, sizeof(filename), "%s/frame_%04zu.png", tempDirComposite.c_str(), frameIdx);
         result = stbi_write_png(filename, w, h, 3, luminanceRGB.data(), w * 3);
         if (!result) {
-            fprintf(stderr, "\nError: stbi_write_png failed for luminance layer (frame %zu)\n", frameIdx);
-            fprintf(stderr, "       File: %s\n", filename);
+            LOG_ERROR(Export, "\nstbi_write_png failed for luminance layer (frame %zu)\n"
+                      "       File: %s\n", frameIdx, filename);
             return false;
         }
         
@@ -350,57 +426,79 @@ bool RobotMKVExporter::exportMultiTrack(
             break;
     }
     
-    // Construire la commande FFmpeg pour MKV multi-pistes
-    // MKV (Matroska) supporte nativement plusieurs pistes vidéo
-    std::ostringstream cmd;
-    cmd << "ffmpeg -y -framerate " << config_.framerate
-        << " -i " << tempDirBase << "/frame_%04d.png "        // Input 0: BASE
-        << " -framerate " << config_.framerate
-        << " -i " << tempDirRemap << "/frame_%04d.png "       // Input 1: REMAP
-        << " -framerate " << config_.framerate
-        << " -i " << tempDirAlpha << "/frame_%04d.png "       // Input 2: ALPHA
-        << " -framerate " << config_.framerate
-        << " -i " << tempDirComposite << "/frame_%04d.png ";  // Input 3: COMPOSITE
-    
-    if (!audioPath.empty()) {
-        cmd << " -i " << audioPath << " ";  // Input 4: AUDIO
-    }
-    
-    // Mapper toutes les pistes vidéo + audio
-    cmd << " -map 0:v -map 1:v -map 2:v -map 3:v ";
-    if (!audioPath.empty()) {
-        cmd << " -map 4:a ";
-    }
-    
-    // Configurer le codec pour chaque piste vidéo
-    cmd << " -c:v:0 " << codecSettings.str()
-        << " -c:v:1 " << codecSettings.str()
-        << " -c:v:2 " << codecSettings.str()
-        << " -c:v:3 " << codecSettings.str();
-    
-    // Configurer l'audio (PCM ou AAC selon préférence)
-    if (!audioPath.empty()) {
-        cmd << " -c:a pcm_s16le -ar 48000 -af aresample=resampler=soxr ";
-    }
-    
-    // Métadonnées pour identifier les pistes
-    cmd << " -metadata:s:v:0 title=\"BASE - RGB (0-235)\" "
-        << " -metadata:s:v:1 title=\"REMAP - RGB (236-254)\" "
-        << " -metadata:s:v:2 title=\"ALPHA - Transparency\" "
-        << " -metadata:s:v:3 title=\"LUMINANCE - Grayscale Y\" ";
+    std::string segmentDir = tempBase + "_segments";
     
+    if (config_.parallelJobs > 1) {
+        // Encodage parallèle : une piste (et un segment GOP) par processus
 #ifdef _WIN32
-    cmd << " -f matroska \"" << outputFile << "\" 2>nul";
+        mkdir(segmentDir.c_str());
 #else
-    cmd << " -f matroska \"" << outputFile << "\" 2>&1 | tail -5";
+        mkdir(segmentDir.c_str(), 0755);
 #endif
-    
-    fprintf(stderr, "  Encoding 4 video tracks + audio into MKV...\n");
-    int result = system(cmd.str().c_str());
-    
-    if (result != 0) {
-        fprintf(stderr, "Error: FFmpeg encoding failed (exit code %d)\n", result);
-        return false;
+        const std::vector<std::string> trackDirs = {
+            tempDirBase, tempDirRemap, tempDirAlpha, tempDirComposite
+        };
+        const std::vector<std::string> trackTitles = {
+            "BASE - RGB (0-235)", "REMAP - RGB (236-254)",
+            "ALPHA - Transparency", "LUMINANCE - Grayscale Y"
+        };
+        if (!encodeTracksParallel(trackDirs, trackTitles, numFrames, codecSettings.str(),
+                                  audioPath, segmentDir, outputFile)) {
+            return false;
+        }
+    } else {
+        // Construire la commande FFmpeg pour MKV multi-pistes
+        // MKV (Matroska) supporte nativement plusieurs pistes vidéo
+        std::ostringstream cmd;
+        cmd << "ffmpeg -y -framerate " << config_.framerate
+            << " -i " << tempDirBase << "/frame_%04d.png "        // Input 0: BASE
+            << " -framerate " << config_.framerate
+            << " -i " << tempDirRemap << "/frame_%04d.png "       // Input 1: REMAP
+            << " -framerate " << config_.framerate
+            << " -i " << tempDirAlpha << "/frame_%04d.png "       // Input 2: ALPHA
+            << " -framerate " << config_.framerate
+            << " -i " << tempDirComposite << "/frame_%04d.png ";  // Input 3: COMPOSITE
+        
+        if (!audioPath.empty()) {
+            cmd << " -i " << audioPath << " ";  // Input 4: AUDIO
+        }
+        
+        // Mapper toutes les pistes vidéo + audio
+        cmd << " -map 0:v -map 1:v -map 2:v -map 3:v ";
+        if (!audioPath.empty()) {
+            cmd << " -map 4:a ";
+        }
+        
+        // Configurer le codec pour chaque piste vidéo
+        cmd << " -c:v:0 " << codecSettings.str()
+            << " -c:v:1 " << codecSettings.str()
+            << " -c:v:2 " << codecSettings.str()
+            << " -c:v:3 " << codecSettings.str();
+        
+        // Configurer l'audio (PCM ou AAC selon préférence)
+        if (!audioPath.empty()) {
+            cmd << " -c:a pcm_s16le -ar 48000 -af aresample=resampler=soxr ";
+        }
+        
+        // Métadonnées pour identifier les pistes
+        cmd << " -metadata:s:v:0 title=\"BASE - RGB (0-235)\" "
+            << " -metadata:s:v:1 title=\"REMAP - RGB (236-254)\" "
+            << " -metadata:s:v:2 title=\"ALPHA - Transparency\" "
+            << " -metadata:s:v:3 title=\"LUMINANCE - Grayscale Y\" ";
+        
+#ifdef _WIN32
+        cmd << " -f matroska \"" << outputFile << "\" 2>nul";
+#else
+        cmd << " -f matroska \"" << outputFile << "\" 2>&1 | tail -5";
+#endif
+        
+        fprintf(stderr, "  Encoding 4 video tracks + audio into MKV...\n");
+        int result = runFfmpeg(cmd.str());
+        
+        if (result != 0) {
+            LOG_ERROR(Export, "FFmpeg encoding failed (exit code %d)\n", result);
+            return false;
+        }
     }
     
     // ========================================================================
@@ -428,61 +526,59 @@ bool RobotMKVExporter::exportMultiTrack(
     for (size_t i = 0; i < numFrames; ++i) {
         const RobotLayerFrame& layer = layers[i];
         const int frameWidth = layer.width;
-        const int frameHeight = layer.height;
         
         // Créer image RGBA avec padding au canvas si nécessaire
         const size_t canvasPixelCount = (size_t)w * (size_t)h;
         std::vector<uint8_t> rgbaImage(canvasPixelCount * 4, 0);  // Noir transparent par défaut
         
         // Copier pixels de la frame vers le canvas
-        for (int y = 0; y < frameHeight; ++y) {
-            for (int x = 0; x < frameWidth; ++x) {
-                const size_t srcIdx = y * frameWidth + x;
-                
-                int dstX, dstY;
-                if (isCanvasMode) {
-                    // Mode canvas: les pixels sont déjà positionnés correctement dans le layer
-                    dstX = x;
-                    dstY = y;
-                } else {
-                    // Mode tight crop: appliquer le crop offset
-                    dstX = x - cropOffsetX;
-                    dstY = y - cropOffsetY;
-                }
-                
-                if (dstX < 0 || dstX >= w || dstY < 0 || dstY >= h) {
-                    continue;  // Pixel en dehors du canvas/bbox
-                }
-                
-                const size_t dstIdx = dstY * w + dstX;
-                
-                if (layer.alpha[srcIdx] == 0) {
-                    // Transparent (skip pixel 255)
-                    rgbaImage[dstIdx * 4 + 0] = 0;
-                    rgbaImage[dstIdx * 4 + 1] = 0;
-                    rgbaImage[dstIdx * 4 + 2] = 0;
-                    rgbaImage[dstIdx * 4 + 3] = 0;
-                } else if (layer.remap_mask[srcIdx] == 255) {
-                    // Pixel remap (236-254)
-                    rgbaImage[dstIdx * 4 + 0] = layer.remap_color_r[srcIdx];
-                    rgbaImage[dstIdx * 4 + 1] = layer.remap_color_g[srcIdx];
-                    rgbaImage[dstIdx * 4 + 2] = layer.remap_color_b[srcIdx];
-                    rgbaImage[dstIdx * 4 + 3] = 255;
-                } else {
-                    // Pixel base (0-235)
-                    rgbaImage[dstIdx * 4 + 0] = layer.base_r[srcIdx];
-                    rgbaImage[dstIdx * 4 + 1] = layer.base_g[srcIdx];
-                    rgbaImage[dstIdx * 4 + 2] = layer.base_b[srcIdx];
-                    rgbaImage[dstIdx * 4 + 3] = 255;
-                }
+        forEachFramePixel(layer, [&](int x, int y) {
+            const size_t srcIdx = y * frameWidth + x;
+            
+            int dstX, dstY;
+            if (isCanvasMode) {
+                // Mode canvas: les pixels sont déjà positionnés correctement dans le layer
+                dstX = x;
+                dstY = y;
+            } else {
+                // Mode tight crop: appliquer le crop offset
+                dstX = x - cropOffsetX;
+                dstY = y - cropOffsetY;
             }
-        }
+            
+            if (dstX < 0 || dstX >= w || dstY < 0 || dstY >= h) {
+                return;  // Pixel en dehors du canvas/bbox
+            }
+            
+            const size_t dstIdx = dstY * w + dstX;
+            
+            if (layer.alpha[srcIdx] == 0) {
+                // Transparent (skip pixel 255)
+                rgbaImage[dstIdx * 4 + 0] = 0;
+                rgbaImage[dstIdx * 4 + 1] = 0;
+                rgbaImage[dstIdx * 4 + 2] = 0;
+                rgbaImage[dstIdx * 4 + 3] = 0;
+            } else if (layer.remap_mask[srcIdx] == 255) {
+                // Pixel remap (236-254)
+                rgbaImage[dstIdx * 4 + 0] = layer.remap_color_r[srcIdx];
+                rgbaImage[dstIdx * 4 + 1] = layer.remap_color_g[srcIdx];
+                rgbaImage[dstIdx * 4 + 2] = layer.remap_color_b[srcIdx];
+                rgbaImage[dstIdx * 4 + 3] = 255;
+            } else {
+                // Pixel base (0-235)
+                rgbaImage[dstIdx * 4 + 0] = layer.base_r[srcIdx];
+                rgbaImage[dstIdx * 4 + 1] = layer.base_g[srcIdx];
+                rgbaImage[dstIdx * 4 + 2] = layer.base_b[srcIdx];
+                rgbaImage[dstIdx * 4 + 3] = 255;
+            }
+        });
         
         // Sauvegarder en PNG RGBA dans le dossier frames de sortie
+        Perf::ScopedTimer pngTimer(Perf::Stage::PngEncode, rgbaImage.size());
         char framePath[512];
         snprintf(framePath, sizeof(framePath), "%s/frame_%04zu.png", framesDir.c_str(), i);
         if (!stbi_write_png(framePath, w, h, 4, rgbaImage.data(), w * 4)) {
-            fprintf(stderr, "Warning: Failed to write PNG frame %zu\n", i);
+            LOG_WARNING(Export, "Failed to write PNG frame %zu\n", i);
         }
     }
     
@@ -504,11 +600,11 @@ bool RobotMKVExporter::exportMultiTrack(
     
     movCmd << " \"" << movFile << "\"";
     
-    int movResult = system(movCmd.str().c_str());
+    int movResult = runFfmpeg(movCmd.str());
     if (movResult == 0) {
         fprintf(stderr, "✓ MOV file: %s\n", movFile.c_str());
     } else {
-        fprintf(stderr, "⚠ Warning: MOV generation failed\n");
+        LOG_WARNING(Export, "MOV generation failed\n");
     }
     
     // ========================================================================
@@ -519,10 +615,11 @@ bool RobotMKVExporter::exportMultiTrack(
     std::ostringstream cleanupCmd;
 #ifdef _WIN32
     cleanupCmd << "rd /s /q \"" << tempDirBase << "\" \"" << tempDirRemap << "\" "
-               << "\"" << tempDirAlpha << "\" \"" << tempDirComposite << "\" 2>nul";
+               << "\"" << tempDirAlpha << "\" \"" << tempDirComposite << "\" "
+               << "\"" << segmentDir << "\" 2>nul";
 #else
     cleanupCmd << "rm -rf " << tempDirBase << " " << tempDirRemap << " " 
-               << tempDirAlpha << " " << tempDirComposite;
+               << tempDirAlpha << " " << tempDirComposite << " " << segmentDir;
 #endif
     system(cleanupCmd.str().c_str());
     
@@ -551,4 +648,122 @@ bool RobotMKVExporter::exportMultiTrack(
     return true;
 }
 
+bool RobotMKVExporter::encodeTracksParallel(
+    const std::vector<std::string>& trackDirs,
+    const std::vector<std::string>& trackTitles,
+    size_t numFrames,
+    const std::string& codecSettings,
+    const std::string& audioPath,
+    const std::string& workDir,
+    const std::string& outputFile
+) {
+    const size_t numTracks = trackDirs.size();
+    const unsigned jobs = (unsigned)config_.parallelJobs;
+    
+    // Segments alignés sur le GOP : chaque segment démarre sur une image clé
+    // et n'en référence aucune autre, la concaténation -c copy reste exacte.
+    // FFV1 est intra-only : un segment par piste suffit (parallélisme par piste).
+    const bool lossy = (config_.codec != MKVExportConfig::Codec::FFV1);
+    const size_t gop = (size_t)std::max(1, config_.gopSize);
+    size_t segmentLength = numFrames;
+    if (lossy) {
+        size_t requested = (size_t)std::max(1, config_.segmentFrames);
+        segmentLength = ((requested + gop - 1) / gop) * gop;
+    }
+    const size_t numSegments = (numFrames + segmentLength - 1) / segmentLength;
+    
+    // Répartir les cœurs entre les processus ffmpeg simultanés
+    const size_t totalJobs = numTracks * numSegments;
+    const unsigned concurrent = (unsigned)std::min<size_t>(jobs, totalJobs);
+    const unsigned threadsPerJob = std::max(1u, Parallel::defaultJobCount() / std::max(1u, concurrent));
+    
+    fprintf(stderr, "  Parallel encoding: %zu track(s) x %zu segment(s) of %zu frames, %u job(s)\n",
+            numTracks, numSegments, segmentLength, concurrent);
+    
+    std::vector<std::string> commands;
+    commands.reserve(totalJobs);
+    for (size_t t = 0; t < numTracks; ++t) {
+        for (size_t s = 0; s < numSegments; ++s) {
+            const size_t first = s * segmentLength;
+            const size_t count = std::min(segmentLength, numFrames - first);
+            
+            char segmentName[64];
+            snprintf(segmentName, sizeof(segmentName), "/track%zu_seg%04zu.mkv", t, s);
+            
+            std::ostringstream cmd;
+            cmd << "ffmpeg -y -loglevel error -framerate " << config_.framerate
+                << " -start_number " << first
+                << " -i " << trackDirs[t] << "/frame_%04d.png"
+                << " -frames:v " << count
+                << " -c:v " << codecSettings
+                << " -threads " << threadsPerJob;
+            if (lossy) {
+                cmd << " -g " << gop;
+            }
+            cmd << " -f matroska \"" << workDir << segmentName << "\"";
+            commands.push_back(cmd.str());
+        }
+    }
+    
+    std::vector<int> results(commands.size(), 0);
+    Parallel::parallelFor(commands.size(), concurrent, [&](size_t i) {
+        results[i] = runFfmpeg(commands[i]);
+    });
+    
+    for (size_t i = 0; i < results.size(); ++i) {
+        if (results[i] != 0) {
+            LOG_ERROR(Export, "FFmpeg segment encoding failed (track %zu, segment %zu, exit code %d)\n",
+                      i / numSegments, i % numSegments, results[i]);
+            return false;
+        }
+    }
+    
+    // Listes pour le démultiplexeur concat (une par piste)
+    for (size_t t = 0; t < numTracks; ++t) {
+        std::string listPath = workDir + "/track" + std::to_string(t) + "_list.txt";
+        FILE* list = fopen(listPath.c_str(), "w");
+        if (!list) {
+            LOG_ERROR(Export, "Cannot write concat list %s\n", listPath.c_str());
+            return false;
+        }
+        for (size_t s = 0; s < numSegments; ++s) {
+            fprintf(list, "file 'track%zu_seg%04zu.mkv'\n", t, s);
+        }
+        fclose(list);
+    }
+    
+    // Remux final : segments concaténés + audio, sans réencodage vidéo
+    std::ostringstream mux;
+    mux << "ffmpeg -y -loglevel error";
+    for (size_t t = 0; t < numTracks; ++t) {
+        mux << " -f concat -safe 0 -i \"" << workDir << "/track" << t << "_list.txt\"";
+    }
+    if (!audioPath.empty()) {
+        mux << " -i " << audioPath;
+    }
+    for (size_t t = 0; t < numTracks; ++t) {
+        mux << " -map " << t << ":v";
+    }
+    if (!audioPath.empty()) {
+        mux << " -map " << numTracks << ":a";
+    }
+    mux << " -c:v copy";
+    if (!audioPath.empty()) {
+        mux << " -c:a pcm_s16le -ar 48000 -af aresample=resampler=soxr";
+    }
+    for (size_t t = 0; t < numTracks && t < trackTitles.size(); ++t) {
+        mux << " -metadata:s:v:" << t << " title=\"" << trackTitles[t] << "\"";
+    }
+    mux << " -f matroska \"" << outputFile << "\"";
+    
+    fprintf(stderr, "  Remuxing %zu segment(s) + audio into MKV...\n", totalJobs);
+    int result = runFfmpeg(mux.str());
+    if (result != 0) {
+        LOG_ERROR(Export, "FFmpeg concat remux failed (exit code %d)\n", result);
+        return false;
+    }
+    
+    return true;
+}
+
 } // namespace RobotExtractor
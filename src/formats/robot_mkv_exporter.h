@@ -3,6 +3,7 @@
 #include <vector>
 #include <cstdint>
 #include <cstdio>
+#include "../core/robot_cel.h"
 
 namespace RobotExtractor {
 
@@ -27,6 +28,11 @@ struct RobotLayerFrame {
     // Couche 3: Alpha transparency (pixel 255) - Transparence
     std::vector<uint8_t> alpha;  // 255 = opaque, 0 = transparent (skip)
     
+    // Suites opaques de la frame (si spansValid) : tout pixel hors suite est
+    // transparent, les passes d'export ne visitent que ces suites
+    std::vector<ScummVMRobot::PixelSpan> spans;
+    bool spansValid = false;
+    
     RobotLayerFrame(int w, int h) 
         : width(w), height(h) {
         size_t size = (size_t)w * (size_t)h;
@@ -66,6 +72,14 @@ struct MKVExportConfig {
     Codec codec = Codec::H264;
     int framerate = 10;
     int quality = 23;  // CRF pour x264/x265/VP9 (18-28, plus bas = meilleure qualité)
+    
+    // Encodage parallèle (0 ou 1 = un seul processus ffmpeg pour les 4 pistes)
+    // Avec N > 1 : chaque piste est encodée séparément, les codecs avec perte
+    // découpent en plus la séquence en segments de GOP fermés, puis le tout
+    // est recollé sans réencodage (concat + remux -c copy).
+    int parallelJobs = 0;
+    int segmentFrames = 120;  // Frames par segment (arrondi au multiple de gopSize)
+    int gopSize = 30;         // Intervalle entre images clés (-g)
 };
 
 /**
@@ -99,6 +113,18 @@ public:
                           int canvasHeight = 0);
     
 private:
+    /**
+     * Encode les 4 pistes en parallèle (segments GOP pour H264/H265/VP9)
+     * puis remuxe les segments et l'audio dans outputFile sans réencodage
+     */
+    bool encodeTracksParallel(const std::vector<std::string>& trackDirs,
+                              const std::vector<std::string>& trackTitles,
+                              size_t numFrames,
+                              const std::string& codecSettings,
+                              const std::string& audioPath,
+                              const std::string& workDir,
+                              const std::string& outputFile);
+    
     MKVExportConfig config_;
 };
 
@@ -123,4 +149,17 @@ RobotLayerFrame decomposeRobotFrame(
     int height
 );
 
+/**
+ * Variante ne décomposant que les suites opaques de la frame (par exemple
+ * RbtDecodedFrame::spans) : les pixels transparents gardent les valeurs
+ * nulles du constructeur, et la frame retient les suites (spansValid)
+ */
+RobotLayerFrame decomposeRobotFrame(
+    const std::vector<uint8_t>& pixelIndices,
+    const std::vector<uint8_t>& palette,
+    int width,
+    int height,
+    const std::vector<ScummVMRobot::PixelSpan>& spans
+);
+
 } // namespace RobotExtractor
@@ -13,7 +13,10 @@
 #include <map>
 
 #include "core/rbt_parser.h"
+#include "core/ressci_parser.h"
+#include "core/robot_coordinate_cache.h"
 #include "formats/robot_mkv_exporter.h"
+#include "utils/perf_stats.h"
 
 namespace fs = std::filesystem;
 using namespace RobotExtractor;
@@ -41,7 +44,8 @@ std::map<uint32_t, std::pair<int16_t, int16_t>> loadCoordinatesFromFile(const st
 }
 
 // Fonction pour scanner les scripts SCI et extraire les coordonnées manquantes
-std::map<uint32_t, std::pair<int16_t, int16_t>> scanResourceScripts(const std::string& resourceDir);
+std::map<uint32_t, std::pair<int16_t, int16_t>> scanResourceScripts(const std::string& resourceDir,
+                                                                    const std::string& cachePath);
 
 // Fonction pour traiter un fichier RBT individuel
 bool processRobotFile(const std::string& rbtPath, const std::string& ressciDir, 
@@ -174,17 +178,16 @@ bool processRobotFile(const std::string& rbtPath, const std::string& ressciDir,
             
             // Extraire les pixels de chaque frame
             for (size_t frameIdx = 0; frameIdx < maxFrames; ++frameIdx) {
-                std::vector<uint8_t> pixelIndices;
-                int width = 0, height = 0;
-                
-                if (!parser2.extractFramePixels(frameIdx, pixelIndices, width, height)) {
+                std::shared_ptr<const RbtDecodedFrame> frame = parser2.getFrame(frameIdx);
+                if (!frame) {
                     std::fprintf(stderr, "   ⚠️  Frame %zu extraction échec\n", frameIdx);
                     continue;
                 }
                 
-                // Décomposer en couches
+                // Décomposer en couches (suites opaques seulement)
                 try {
-                    RobotLayerFrame layer = decomposeRobotFrame(pixelIndices, palette, width, height);
+                    RobotLayerFrame layer = decomposeRobotFrame(frame->pixels, palette, frame->width, frame->height,
+                                                                frame->spans);
                     allLayers.push_back(std::move(layer));
                 } catch (const std::exception& e) {
                     std::fprintf(stderr, "   ⚠️  Frame %zu décomposition échec: %s\n", frameIdx, e.what());
@@ -293,7 +296,8 @@ int main(int argc, char **argv) {
     std::fprintf(stderr, "🔍 ÉTAPE 2: Scan scripts SCI pour coordonnées manquantes\n");
     std::fprintf(stderr, "════════════════════════════════════════════════════\n");
     
-    std::map<uint32_t, std::pair<int16_t, int16_t>> scriptCoords = scanResourceScripts(ressciDir);
+    std::map<uint32_t, std::pair<int16_t, int16_t>> scriptCoords = scanResourceScripts(
+        ressciDir, std::string(baseOutDir) + "/robot_coordinates_cache.json");
     
     // Fusionner les coordonnées (priorité aux existantes)
     size_t addedCount = 0;
@@ -353,13 +357,33 @@ int main(int argc, char **argv) {
     size_t successCount = 0;
     size_t failCount = 0;
     
+    // Instrumentation (ROBOT_PERF=1, ROBOT_PERF_TRACE=fichier.json)
+    Perf::initFromEnvironment();
+    std::vector<std::pair<std::string, Perf::Snapshot>> perfRobots;
+    Perf::Snapshot perfBatch;
+    
     for (const auto& rbtPath : rbtFiles) {
+        Perf::reset();
         bool success = processRobotFile(rbtPath, ressciDir, baseOutDir, maxFramesArg, allCoords);
         if (success) {
             successCount++;
         } else {
             failCount++;
         }
+        if (Perf::enabled()) {
+            Perf::Snapshot snap = Perf::snapshot();
+            Perf::printSummary(snap);
+            perfRobots.emplace_back(fs::path(rbtPath).stem().string(), snap);
+            perfBatch += snap;
+        }
+    }
+    
+    if (Perf::enabled()) {
+        std::string reportPath = std::string(baseOutDir) + "/perf_report.json";
+        if (Perf::writeReport(reportPath, perfRobots, perfBatch)) {
+            std::fprintf(stderr, "📈 Rapport perf: %s\n", reportPath.c_str());
+        }
+        Perf::writeTrace();
     }
     
     // Résumé final
@@ -374,18 +398,15 @@ int main(int argc, char **argv) {
     return (failCount == 0) ? 0 : 1;
 }
 
+// Budget du cache de ressources du scan : scripts, HEAP et VOCAB décompressés
+// une seule fois et partagés entre les threads
+static const size_t kResourceCacheBudget = 64 * 1024 * 1024;
+
 // Fonction pour scanner les scripts SCI et extraire coordonnées
-std::map<uint32_t, std::pair<int16_t, int16_t>> scanResourceScripts(const std::string& resourceDir) {
+std::map<uint32_t, std::pair<int16_t, int16_t>> scanResourceScripts(const std::string& resourceDir,
+                                                                    const std::string& cachePath) {
     std::map<uint32_t, std::pair<int16_t, int16_t>> coords;
     
-    // Chercher extract_coordinates
-    std::string extractorPath = "./build/extract_coordinates";
-    
-    if (!fs::exists(extractorPath)) {
-        std::fprintf(stderr, "⚠️  %s non trouvé, coordonnées scripts ignorées\n", extractorPath.c_str());
-        return coords;
-    }
-    
     // Chercher le répertoire contenant RESMAP/RESSCI
     std::string scanDir = resourceDir;
     
@@ -404,52 +425,55 @@ std::map<uint32_t, std::pair<int16_t, int16_t>> scanResourceScripts(const std::s
         return coords;
     }
     
-    // Créer fichier temporaire pour les résultats
-    std::string tempFile = "/tmp/robot_coords_temp.txt";
-    std::string cmd = extractorPath + " " + scanDir + " > " + tempFile + " 2>/dev/null";
-    
-    std::fprintf(stderr, "   🔍 Scan %s...\n", scanDir.c_str());
-    int ret = std::system(cmd.c_str());
-    if (ret != 0) {
-        std::fprintf(stderr, "   ⚠️  Extraction coordonnées scripts échouée (code %d)\n", ret);
-        return coords;
-    }
-    
-    // Lire les résultats du format extract_coordinates
-    std::ifstream tempStream(tempFile);
-    if (tempStream.is_open()) {
-        std::string line;
-        while (std::getline(tempStream, line)) {
-            // Format extract_coordinates: "Script 123: Robot 1000 at (x=315, y=200)"
-            // ou format simple: "1000 315 200"
-            
-            // Essayer parsing format simple
-            uint32_t id;
-            int16_t x, y;
-            if (std::sscanf(line.c_str(), "%u %hd %hd", &id, &x, &y) == 3) {
-                coords[id] = {x, y};
-                continue;
-            }
-            
-            // Essayer parsing format verbose
-            if (line.find("Robot") != std::string::npos && line.find("at (x=") != std::string::npos) {
-                size_t robotPos = line.find("Robot ");
-                size_t xPos = line.find("x=");
-                size_t yPos = line.find("y=");
-                
-                if (robotPos != std::string::npos && xPos != std::string::npos && yPos != std::string::npos) {
-                    uint32_t robotId = std::stoul(line.substr(robotPos + 6));
-                    int16_t xCoord = std::stoi(line.substr(xPos + 2));
-                    int16_t yCoord = std::stoi(line.substr(yPos + 2));
-                    coords[robotId] = {xCoord, yCoord};
+    // Résultat d'un scan précédent, si les volumes n'ont pas changé
+    SCI::RobotCoordinateCache cache(cachePath);
+    std::vector<SCI::RobotCoordinates> sciCoords;
+    if (cache.lookup(scanDir, sciCoords)) {
+        std::fprintf(stderr, "   ♻️  %zu coordonnées reprises de %s (volumes inchangés)\n",
+                     sciCoords.size(), cachePath.c_str());
+    } else {
+        std::fprintf(stderr, "   🔍 Scan %s...\n", scanDir.c_str());
+        
+        // Index RESMAP et en-têtes RESSCI déjà résolus, si les volumes n'ont pas changé
+        SCI::RESSCIParser parser;
+        parser.setCacheBudget(kResourceCacheBudget);
+        std::string catalogPath = (fs::path(cachePath).parent_path() / "resource_catalog.bin").string();
+        if (!parser.loadCatalog(catalogPath, scanDir)) {
+            int volumesLoaded = 0;
+            for (int vol = 0; vol <= 9; vol++) {
+                char suffix[8];
+                std::snprintf(suffix, sizeof(suffix), ".%03d", vol);
+                std::string resmapPath = scanDir + "/RESMAP" + suffix;
+                std::string ressciPath = scanDir + "/RESSCI" + suffix;
+                if (!fs::exists(resmapPath) || !fs::exists(ressciPath)) {
+                    continue;
                 }
+                if (parser.loadResMap(resmapPath, (uint8_t)vol) && parser.loadRessci(ressciPath, (uint8_t)vol)) {
+                    volumesLoaded++;
+                }
+            }
+            if (volumesLoaded == 0) {
+                std::fprintf(stderr, "   ⚠️  Aucun volume RESMAP/RESSCI lisible dans %s\n", scanDir.c_str());
+                return coords;
             }
+            
+            std::error_code ec;
+            fs::create_directories(fs::path(catalogPath).parent_path(), ec);
+            parser.saveCatalog(catalogPath);
+        }
+        
+        sciCoords = parser.extractRobotCoordinates();
+        if (!sciCoords.empty()) {
+            std::error_code ec;
+            fs::create_directories(fs::path(cachePath).parent_path(), ec);
+            cache.store(scanDir, sciCoords);
         }
-        tempStream.close();
     }
     
-    // Nettoyer
-    std::remove(tempFile.c_str());
+    // Première occurrence par Robot (ordre des scripts), comme export_robot_mkv
+    for (const auto& c : sciCoords) {
+        coords.emplace(c.robotId, std::make_pair(c.x, c.y));
+    }
     
     return coords;
 }
@@ -0,0 +1,264 @@
+/**
+ * Catalogue des Robots (.RBT) d'une arborescence
+ *
+ * Chaque fichier est ouvert et seul son en-tête est analysé (RbtParser::
+ * parseHeader : champs fixes, tables de tailles, cues ; ni palette, ni
+ * primer, ni frame décodée). Les fichiers sont répartis sur un pool de
+ * threads ; le tableau est trié par chemin quel que soit le nombre de threads.
+ *
+ * --verify lit en plus chaque fichier en entier (RbtParser::verify : cels,
+ * chunks, décompression LZS, en-têtes audio) et liste les plages de frames
+ * corrompues, sans rien écrire d'autre que le rapport.
+ *
+ * Usage:
+ *   rbt_catalog [--verify] [--csv FILE] [--json FILE] [--jobs N] <dir|file.rbt> ...
+ *
+ * Sans --csv ni --json, le CSV est écrit sur la sortie standard.
+ */
+
+#include "core/rbt_parser.h"
+#include "utils/log.h"
+#include "utils/parallel_for.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <nlohmann/json.hpp>
+
+namespace fs = std::filesystem;
+
+struct CatalogRow {
+    std::string path;
+    uint64_t fileSize = 0;
+    bool ok = false;
+    RbtHeaderInfo info;
+    bool verified = false;
+    RbtVerifyReport report;
+
+    bool valid() const { return ok && (!verified || report.ok()); }
+};
+
+static bool isRobotFile(const fs::path& path) {
+    std::string ext = path.extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+    return ext == ".rbt";
+}
+
+static void collectInputs(const std::string& arg, std::vector<std::string>& inputs) {
+    std::error_code ec;
+    if (!fs::is_directory(arg, ec)) {
+        inputs.push_back(arg);
+        return;
+    }
+    for (fs::recursive_directory_iterator it(arg, fs::directory_options::skip_permission_denied, ec), end;
+         it != end; it.increment(ec)) {
+        if (ec) {
+            break;
+        }
+        if (it->is_regular_file(ec) && isRobotFile(it->path())) {
+            inputs.push_back(it->path().string());
+        }
+    }
+}
+
+static void scanFile(CatalogRow& row, bool verify) {
+    std::error_code ec;
+    row.fileSize = fs::file_size(row.path, ec);
+
+    FILE* f = fopen(row.path.c_str(), "rb");
+    if (!f) {
+        return;
+    }
+    RbtParser parser(f);
+    row.ok = parser.parseHeader();
+    if (row.ok) {
+        row.info = parser.getHeaderInfo();
+        if (verify) {
+            row.verified = parser.verify(row.report);
+        }
+    }
+    fclose(f);
+}
+
+static const char* kCsvHeader =
+    "path,ok,file_size,version,frames,fps,audio,palette,hi_res,x_res,y_res,"
+    "max_cels_per_frame,max_cel_area_0,max_cel_area_1,max_cel_area_2,max_cel_area_3,"
+    "cues,palette_size,primer_size,video_bytes,packet_bytes";
+static const char* kCsvVerifyColumns = ",verified,bad_frames,corrupt_ranges";
+
+// Plages "a-b:raison" séparées par ';' (une seule colonne CSV)
+static std::string formatRanges(const RbtVerifyReport& report) {
+    std::string text;
+    for (const std::string& issue : report.headerIssues) {
+        if (!text.empty()) text += ';';
+        text += "header:" + issue;
+    }
+    for (const RbtVerifyReport::Range& range : report.corruptRanges) {
+        if (!text.empty()) text += ';';
+        text += std::to_string(range.firstFrame);
+        if (range.lastFrame != range.firstFrame) {
+            text += "-" + std::to_string(range.lastFrame);
+        }
+        text += ":" + range.reason;
+    }
+    return text;
+}
+
+static std::string quoteCsv(const std::string& field) {
+    // Guillemets doublés (RFC 4180) : les chemins peuvent contenir des virgules
+    std::string quoted = "\"";
+    for (char c : field) {
+        quoted += c;
+        if (c == '"') quoted += '"';
+    }
+    quoted += '"';
+    return quoted;
+}
+
+static void writeCsvRow(FILE* out, const CatalogRow& row, bool verify) {
+    const RbtHeaderInfo& h = row.info;
+    fprintf(out, "%s,%d,%llu,%u,%u,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%zu,%u,%d,%llu,%llu",
+            quoteCsv(row.path).c_str(), row.ok ? 1 : 0, (unsigned long long)row.fileSize,
+            h.version, h.numFrames, h.frameRate, h.hasAudio ? 1 : 0, h.hasPalette ? 1 : 0, h.isHiRes ? 1 : 0,
+            h.xResolution, h.yResolution, h.maxCelsPerFrame,
+            h.maxCelArea[0], h.maxCelArea[1], h.maxCelArea[2], h.maxCelArea[3],
+            h.cueCount, h.paletteSize, h.primerSize,
+            (unsigned long long)h.videoBytes, (unsigned long long)h.packetBytes);
+    if (verify) {
+        fprintf(out, ",%d,%zu,%s", row.verified ? 1 : 0, row.report.badFrames,
+                quoteCsv(formatRanges(row.report)).c_str());
+    }
+    fputc('\n', out);
+}
+
+static nlohmann::json rowToJson(const CatalogRow& row) {
+    nlohmann::json j = {{"path", row.path}, {"ok", row.ok}, {"fileSize", row.fileSize}};
+    if (!row.ok) {
+        return j;
+    }
+    const RbtHeaderInfo& h = row.info;
+    j["version"] = h.version;
+    j["frames"] = h.numFrames;
+    j["fps"] = h.frameRate;
+    j["audio"] = h.hasAudio;
+    j["palette"] = h.hasPalette;
+    j["hiRes"] = h.isHiRes;
+    j["resolution"] = {h.xResolution, h.yResolution};
+    j["maxCelsPerFrame"] = h.maxCelsPerFrame;
+    j["maxCelArea"] = {h.maxCelArea[0], h.maxCelArea[1], h.maxCelArea[2], h.maxCelArea[3]};
+    j["cues"] = h.cueCount;
+    j["paletteSize"] = h.paletteSize;
+    j["primerSize"] = h.primerSize;
+    j["videoBytes"] = h.videoBytes;
+    j["packetBytes"] = h.packetBytes;
+    if (row.verified) {
+        nlohmann::json ranges = nlohmann::json::array();
+        for (const RbtVerifyReport::Range& range : row.report.corruptRanges) {
+            ranges.push_back({{"first", range.firstFrame}, {"last", range.lastFrame}, {"reason", range.reason}});
+        }
+        j["verify"] = {
+            {"framesChecked", row.report.framesChecked},
+            {"badFrames", row.report.badFrames},
+            {"cels", row.report.celsChecked},
+            {"audioPackets", row.report.audioPackets},
+            {"bytesRead", row.report.bytesRead},
+            {"headerIssues", row.report.headerIssues},
+            {"corruptRanges", std::move(ranges)},
+        };
+    }
+    return j;
+}
+
+int main(int argc, char* argv[]) {
+    std::string csvPath;
+    std::string jsonPath;
+    bool verify = false;
+    unsigned jobs = Parallel::defaultJobCount();
+    std::vector<std::string> inputs;
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--verify") == 0) {
+            verify = true;
+        } else if (strcmp(argv[i], "--csv") == 0 && i + 1 < argc) {
+            csvPath = argv[++i];
+        } else if (strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+            jsonPath = argv[++i];
+        } else if (strcmp(argv[i], "--jobs") == 0 && i + 1 < argc) {
+            jobs = (unsigned)std::max(1, atoi(argv[++i]));
+        } else if (argv[i][0] != '-') {
+            collectInputs(argv[i], inputs);
+        } else {
+            fprintf(stderr, "Usage: %s [--verify] [--csv FILE] [--json FILE] [--jobs N] <dir|file.rbt> ...\n", argv[0]);
+            return 1;
+        }
+    }
+    std::sort(inputs.begin(), inputs.end());
+    inputs.erase(std::unique(inputs.begin(), inputs.end()), inputs.end());
+    if (inputs.empty()) {
+        fprintf(stderr, "Error: No .RBT input\n");
+        return 1;
+    }
+
+    // Un message par fichier invalide suffit
+    if (!std::getenv("ROBOT_LOG_LEVEL")) {
+        Log::setLevel(Log::Level::Error);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<CatalogRow> rows(inputs.size());
+    Parallel::parallelFor(rows.size(), jobs, [&](size_t i) {
+        rows[i].path = inputs[i];
+        scanFile(rows[i], verify);
+    });
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    size_t failed = 0;
+    uint64_t bytesRead = 0;
+    for (const CatalogRow& row : rows) {
+        if (!row.valid()) {
+            failed++;
+        }
+        bytesRead += row.report.bytesRead;
+    }
+
+    if (!jsonPath.empty()) {
+        nlohmann::json list = nlohmann::json::array();
+        for (const CatalogRow& row : rows) {
+            list.push_back(rowToJson(row));
+        }
+        std::ofstream out(jsonPath, std::ios::trunc);
+        out << nlohmann::json({{"robots", std::move(list)}}).dump(2) << "\n";
+        if (!out.good()) {
+            fprintf(stderr, "Error: Cannot write %s\n", jsonPath.c_str());
+            return 1;
+        }
+    }
+
+    if (!csvPath.empty() || jsonPath.empty()) {
+        FILE* out = csvPath.empty() ? stdout : fopen(csvPath.c_str(), "w");
+        if (!out) {
+            fprintf(stderr, "Error: Cannot write %s\n", csvPath.c_str());
+            return 1;
+        }
+        fputs(kCsvHeader, out);
+        fputs(verify ? kCsvVerifyColumns : "", out);
+        fputc('\n', out);
+        for (const CatalogRow& row : rows) {
+            writeCsvRow(out, row, verify);
+        }
+        if (out != stdout) {
+            fclose(out);
+        }
+    }
+
+    fprintf(stderr, "%zu Robot(s), %zu invalid, %.3f s (%.0f files/s, %u jobs)\n",
+            rows.size(), failed, seconds, seconds > 0 ? rows.size() / seconds : 0.0, jobs);
+    if (verify) {
+        fprintf(stderr, "Verified %.1f MiB (%.1f MiB/s)\n", bytesRead / 1048576.0,
+                seconds > 0 ? bytesRead / 1048576.0 / seconds : 0.0);
+    }
+    return failed == 0 ? 0 : 2;
+}
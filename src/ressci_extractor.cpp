@@ -4,8 +4,12 @@
  * 
  * For SCI2.1 (Phantasmagoria):
  * - Scripts stored in RESSCI.00X files
- * - RESMAP.00X contains index (5-byte entries)
+ * - RESMAP.00X index decoded by core/resmap_reader (5/6/9-byte entries),
+ *   through RESSCIParser like the other tools
  * - Each script has embedded HEAP section (Local Variables)
+ *
+ * --dump: extract every indexed resource to <output>/<type>/<number>.<ext>
+ * in parallel (RESSCIParser + resource_dump), with <output>/manifest.json
  */
 
 #include <iostream>
@@ -14,92 +18,13 @@
 #include <string>
 #include <cstring>
 #include <iomanip>
-#include <map>
 #include <cstdint>
 #include <algorithm>
-
-// Resource types (from ScummVM engines/sci/resource/resource.cpp)
-enum ResourceType {
-    kResourceTypeView = 0,
-    kResourceTypePic,
-    kResourceTypeScript,
-    kResourceTypeText,
-    kResourceTypeSound,
-    kResourceTypeMemory,
-    kResourceTypeVocab,
-    kResourceTypeFont,
-    kResourceTypeCursor,
-    kResourceTypePatch,
-    kResourceTypeBitmap,
-    kResourceTypePalette,
-    kResourceTypeCdAudio,
-    kResourceTypeAudio,
-    kResourceTypeSync,
-    kResourceTypeMessage,
-    kResourceTypeMap,
-    kResourceTypeHeap,
-    kResourceTypeAudio36,
-    kResourceTypeSync36,
-    kResourceTypeTranslation,
-    kResourceTypeRave,
-    kResourceTypeInvalid
-};
-
-const char* resourceTypeNames[] = {
-    "View", "Pic", "Script", "Text", "Sound", "Memory", "Vocab", "Font",
-    "Cursor", "Patch", "Bitmap", "Palette", "CdAudio", "Audio", "Sync", "Message",
-    "Map", "Heap", "Audio36", "Sync36", "Translation", "Rave"
-};
-
-// SCI2.1 resource map entry (5 bytes)
-struct ResMapEntry {
-    uint16_t resourceId;  // resource number
-    uint32_t offset;      // offset in RESSCI file (24-bit)
-    uint8_t volume;       // which RESSCI.00X file
-    
-    void read(std::ifstream& file) {
-        uint8_t buf[5];
-        file.read(reinterpret_cast<char*>(buf), 5);
-        
-        resourceId = buf[0] | (buf[1] << 8);
-        offset = buf[2] | (buf[3] << 8) | (buf[4] << 16);
-        volume = (offset >> 18) & 0x3F;  // Volume in upper bits
-        offset &= 0x3FFFF;  // Actual offset in lower 18 bits
-    }
-};
-
-// Resource header in RESSCI file
-struct ResourceHeader {
-    ResourceType type;
-    uint16_t number;
-    uint8_t compressionMethod;
-    uint32_t compressedSize;
-    uint32_t decompressedSize;
-    
-    bool read(std::ifstream& file) {
-        uint8_t typeAndMethod;
-        file.read(reinterpret_cast<char*>(&typeAndMethod), 1);
-        
-        type = static_cast<ResourceType>(typeAndMethod & 0x7F);
-        compressionMethod = (typeAndMethod & 0x80) ? 1 : 0;
-        
-        uint8_t numBuf[2];
-        file.read(reinterpret_cast<char*>(numBuf), 2);
-        number = numBuf[0] | (numBuf[1] << 8);
-        
-        uint8_t sizeBuf[4];
-        file.read(reinterpret_cast<char*>(sizeBuf), 4);
-        compressedSize = sizeBuf[0] | (sizeBuf[1] << 8) | (sizeBuf[2] << 16);
-        decompressedSize = sizeBuf[0] | (sizeBuf[1] << 8) | (sizeBuf[2] << 16);
-        
-        if (compressionMethod) {
-            file.read(reinterpret_cast<char*>(sizeBuf), 4);
-            decompressedSize = sizeBuf[0] | (sizeBuf[1] << 8) | (sizeBuf[2] << 16);
-        }
-        
-        return file.good();
-    }
-};
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include "core/ressci_parser.h"
+#include "core/resource_dump.h"
 
 // Script structure for SCI1.1 - SCI2.1
 struct ScriptInfo {
@@ -182,187 +107,185 @@ struct ScriptInfo {
     }
 };
 
-class RESMAPReader {
-private:
-    std::map<uint16_t, std::vector<ResMapEntry>> resourceMap;  // type -> entries
-    
-public:
-    bool load(const std::string& filename) {
-        std::ifstream file(filename, std::ios::binary);
-        if (!file) {
-            std::cerr << "Failed to open: " << filename << "\n";
-            return false;
-        }
-        
-        std::cout << "Reading RESMAP: " << filename << "\n";
-        
-        uint8_t currentType = 0xFF;
-        int entryCount = 0;
-        
-        // SCI1+ format: 5-byte entries with type markers (type | 0x80)
-        while (file.good()) {
-            uint8_t buf[5];
-            file.read(reinterpret_cast<char*>(buf), 5);
-            if (!file.good() || file.gcount() < 5) break;
-            
-            // Check if this is a type marker (high bit set)
-            if (buf[0] & 0x80) {
-                currentType = buf[0] & 0x7F;
-                if (currentType < 22) {
-                    std::cout << "  Found type: " << (int)currentType 
-                             << " (" << resourceTypeNames[currentType] << ")\n";
-                }
-                // The rest of this 5-byte block is padding
-                continue;
-            }
-            
-            // It's a resource entry (5 bytes)
-            ResMapEntry entry;
-            entry.resourceId = buf[0] | (buf[1] << 8);
-            entry.offset = buf[2] | (buf[3] << 8) | ((buf[4] & 0x3F) << 16);
-            entry.volume = (buf[4] >> 6);
-            
-            resourceMap[currentType].push_back(entry);
-            entryCount++;
-            
-            if (currentType == kResourceTypeScript) {
-                std::cout << "    Script " << entry.resourceId 
-                         << " at offset 0x" << std::hex << entry.offset 
-                         << " in RESSCI.00" << std::dec << (int)entry.volume << "\n";
-            }
+
+// Decompressed resource cache for the listing path (the bulk dump streams
+// each resource once and stays uncached)
+static const size_t kResourceCacheBudget = 64 * 1024 * 1024;
+
+// Every RESMAP.00N/RESSCI.00N pair of resourceDir
+static bool loadVolumes(SCI::RESSCIParser& parser, const std::string& resourceDir) {
+    int volumesLoaded = 0;
+    for (int vol = 0; vol <= 9; vol++) {
+        char suffix[8];
+        std::snprintf(suffix, sizeof(suffix), ".%03d", vol);
+        std::string resmapPath = resourceDir + "/RESMAP" + suffix;
+        std::string ressciPath = resourceDir + "/RESSCI" + suffix;
+        if (!std::filesystem::exists(resmapPath) || !std::filesystem::exists(ressciPath)) {
+            continue;
         }
-        
-        std::cout << "Total entries read: " << entryCount << "\n";
-        
-        // Summary
-        std::cout << "\nResource summary:\n";
-        for (const auto& pair : resourceMap) {
-            std::cout << "  Type " << pair.first;
-            if (pair.first < 22) {
-                std::cout << " (" << resourceTypeNames[pair.first] << ")";
-            }
-            std::cout << ": " << pair.second.size() << " resources\n";
+        if (parser.loadResMap(resmapPath, (uint8_t)vol) && parser.loadRessci(ressciPath, (uint8_t)vol)) {
+            volumesLoaded++;
         }
-        
-        return true;
     }
-    
-    const std::vector<ResMapEntry>* getResourcesOfType(ResourceType type) const {
-        auto it = resourceMap.find(static_cast<uint16_t>(type));
-        if (it != resourceMap.end()) {
-            return &it->second;
-        }
-        return nullptr;
+    if (volumesLoaded == 0) {
+        std::cerr << "No readable RESMAP/RESSCI volume in " << resourceDir << "\n";
+        return false;
     }
-};
+    return true;
+}
 
-class RESSCIReader {
-private:
-    std::string basePath;
+// Decompressed script through the shared parser, saved whole then analyzed
+static bool extractScript(SCI::RESSCIParser& parser, uint16_t scriptNum, const std::string& outputDir) {
+    SCI::ResourceInfo info = parser.extractResource(SCI::RT_SCRIPT, scriptNum);
+    if (info.data.empty()) {
+        return false;
+    }
     
-public:
-    RESSCIReader(const std::string& path) : basePath(path) {}
+    std::cout << "\nExtracting script " << scriptNum << " from RESSCI.00" << (int)info.volume
+              << " at offset 0x" << std::hex << info.offset << std::dec << "\n";
+    std::cout << "  Compression: " << SCI::RESSCIParser::getCompressionMethodName(info.method) << "\n";
+    std::cout << "  Size: " << info.data.size() << " bytes\n";
     
-    bool extractScript(uint16_t scriptNum, uint32_t offset, uint8_t volume, const std::string& outputDir) {
-        std::string volumeFile = basePath + "/RESSCI.00" + std::to_string(volume);
-        std::ifstream file(volumeFile, std::ios::binary);
-        
-        if (!file) {
-            std::cerr << "Failed to open: " << volumeFile << "\n";
-            return false;
-        }
-        
-        std::cout << "\nExtracting script " << scriptNum << " from " << volumeFile 
-                 << " at offset 0x" << std::hex << offset << std::dec << "\n";
-        
-        file.seekg(offset);
-        
-        ResourceHeader header;
-        if (!header.read(file)) {
-            std::cerr << "Failed to read resource header\n";
-            return false;
+    ScriptInfo script;
+    script.scriptNumber = scriptNum;
+    script.data = std::move(info.data);
+    
+    // Analyze script structure
+    script.analyze();
+    script.findHeapSection();
+    
+    // Save complete script
+    std::string scriptFile = outputDir + "/script_" + std::to_string(scriptNum) + "_complete.bin";
+    std::ofstream out(scriptFile, std::ios::binary);
+    out.write(reinterpret_cast<const char*>(script.data.data()), script.data.size());
+    out.close();
+    std::cout << "  Complete script saved to: " << scriptFile << "\n";
+    
+    // Extract and analyze heap
+    script.extractHeapData(outputDir);
+    
+    return true;
+}
+
+// Bulk dump: every RESMAP/RESSCI volume of resourceDir, all resources (or only `types`)
+static int dumpAllResources(const std::string& resourceDir, const std::string& outputDir,
+                            const SCI::DumpOptions& options) {
+    SCI::RESSCIParser parser;
+    if (!loadVolumes(parser, resourceDir)) {
+        return 1;
+    }
+    
+    auto start = std::chrono::steady_clock::now();
+    std::vector<SCI::DumpedResource> resources = SCI::dumpResources(parser, outputDir, options);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    
+    uint64_t totalBytes = 0;
+    size_t failed = 0;
+    for (const SCI::DumpedResource& resource : resources) {
+        if (!resource.error.empty()) {
+            std::cerr << "  " << SCI::RESSCIParser::getResourceTypeName(resource.type) << " #"
+                      << resource.number << ": " << resource.error << "\n";
+            failed++;
+        } else {
+            totalBytes += resource.size;
         }
-        
-        std::cout << "  Type: " << (int)header.type << " (" << resourceTypeNames[header.type] << ")\n";
-        std::cout << "  Number: " << header.number << "\n";
-        std::cout << "  Compressed: " << (header.compressionMethod ? "Yes" : "No") << "\n";
-        std::cout << "  Size: " << header.compressedSize << " bytes\n";
-        
-        if (header.type != kResourceTypeScript) {
-            std::cerr << "Warning: Expected script, got type " << (int)header.type << "\n";
+    }
+    
+    std::cout << "\nDumped " << (resources.size() - failed) << "/" << resources.size()
+              << " resources (" << totalBytes / 1024 << " KB) in " << std::fixed << std::setprecision(2)
+              << seconds << " s";
+    if (seconds > 0) {
+        std::cout << " (" << (totalBytes / (1024.0 * 1024.0)) / seconds << " MB/s)";
+    }
+    std::cout << "\n";
+    
+    if (!SCI::writeDumpManifest(outputDir + "/manifest.json", resources)) {
+        return 1;
+    }
+    std::cout << "Manifest: " << outputDir << "/manifest.json\n";
+    return failed == 0 ? 0 : 1;
+}
+
+static bool parseResourceType(const std::string& name, SCI::ResourceType& type) {
+    auto lower = [](std::string s) {
+        std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+        return s;
+    };
+    for (int t = SCI::RT_SCRIPT; t <= SCI::RT_AUDIOMAP; t++) {
+        if (lower(SCI::RESSCIParser::getResourceTypeName((SCI::ResourceType)t)) == lower(name)) {
+            type = (SCI::ResourceType)t;
+            return true;
         }
-        
-        // Read script data
-        ScriptInfo script;
-        script.scriptNumber = scriptNum;
-        script.data.resize(header.compressedSize);
-        
-        file.read(reinterpret_cast<char*>(script.data.data()), header.compressedSize);
-        
-        // Analyze script structure
-        script.analyze();
-        script.findHeapSection();
-        
-        // Save complete script
-        std::string scriptFile = outputDir + "/script_" + std::to_string(scriptNum) + "_complete.bin";
-        std::ofstream out(scriptFile, std::ios::binary);
-        out.write(reinterpret_cast<const char*>(script.data.data()), script.data.size());
-        out.close();
-        std::cout << "  Complete script saved to: " << scriptFile << "\n";
-        
-        // Extract and analyze heap
-        script.extractHeapData(outputDir);
-        
-        return true;
     }
-};
+    return false;
+}
 
 int main(int argc, char* argv[]) {
     std::string resourceDir = "Resource";
     std::string outputDir = "scripts_extracted";
+    bool dump = false;
+    SCI::DumpOptions dumpOptions;
     
-    if (argc > 1) {
-        resourceDir = argv[1];
+    std::vector<std::string> positional;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--dump") {
+            dump = true;
+        } else if ((arg == "--jobs" || arg == "-j") && i + 1 < argc) {
+            dumpOptions.jobs = (unsigned)std::strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--type" && i + 1 < argc) {
+            SCI::ResourceType type;
+            if (!parseResourceType(argv[++i], type)) {
+                std::cerr << "Unknown resource type: " << argv[i] << "\n";
+                return 1;
+            }
+            dumpOptions.types.insert(type);
+        } else if (arg == "--help" || arg == "-h") {
+            std::cout << "Usage: " << argv[0] << " [Resource] [output] [--dump [--jobs N] [--type Script]...]\n";
+            return 0;
+        } else {
+            positional.push_back(arg);
+        }
+    }
+    if (positional.size() > 0) {
+        resourceDir = positional[0];
+    }
+    if (positional.size() > 1) {
+        outputDir = positional[1];
     }
-    if (argc > 2) {
-        outputDir = argv[2];
+    
+    if (dump) {
+        if (positional.size() < 2) {
+            outputDir = "resources_extracted";
+        }
+        return dumpAllResources(resourceDir, outputDir, dumpOptions);
     }
     
     std::cout << "RESSCI Extractor for SCI2.1 (Phantasmagoria)\n";
     std::cout << "=============================================\n\n";
     
     // Create output directory
-    system(("mkdir -p " + outputDir).c_str());
+    std::filesystem::create_directories(outputDir);
     
-    // Load RESMAP
-    RESMAPReader resmap;
-    if (!resmap.load(resourceDir + "/RESMAP.001")) {
-        std::cerr << "Failed to load RESMAP.001\n";
+    SCI::RESSCIParser parser;
+    parser.setCacheBudget(kResourceCacheBudget);
+    if (!loadVolumes(parser, resourceDir)) {
         return 1;
     }
     
-    // Get scripts
-    const auto* scripts = resmap.getResourcesOfType(kResourceTypeScript);
-    if (!scripts) {
+    size_t scriptCount = parser.getResourceIndex().ofType(SCI::RT_SCRIPT).size();
+    if (scriptCount == 0) {
         std::cerr << "No scripts found in RESMAP\n";
         return 1;
     }
     
-    std::cout << "\nFound " << scripts->size() << " scripts\n";
+    std::cout << "\nFound " << scriptCount << " scripts\n";
     
     // Extract specific scripts of interest
     std::vector<uint16_t> scriptsToExtract = {902, 23, 13400, 0};  // Script 0 contains game object
     
-    RESSCIReader reader(resourceDir);
-    
     for (uint16_t scriptNum : scriptsToExtract) {
-        // Find this script in the map
-        for (const auto& entry : *scripts) {
-            if (entry.resourceId == scriptNum) {
-                reader.extractScript(scriptNum, entry.offset, entry.volume, outputDir);
-                break;
-            }
-        }
+        extractScript(parser, scriptNum, outputDir);
     }
     
     std::cout << "\n\nExtraction complete! Check " << outputDir << "/ for output files.\n";
@@ -0,0 +1,463 @@
+/**
+ * Tests de non-régression des décodeurs et index de ressources (enregistrés
+ * dans CTest)
+ *
+ * Chaque cas renvoie false et affiche la vérification fautive ; le programme
+ * sort avec 1 dès qu'un cas échoue.
+ *
+ * Usage:
+ *   codec_tests
+ */
+
+#include "core/resmap_reader.h"
+#include "core/resource_catalog.h"
+#include "core/ressci_parser.h"
+#include "core/robot_cel.h"
+#include "formats/export_manifest.h"
+#include "formats/huffman.h"
+#include "formats/lzs.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace SCI;
+
+#define CHECK(cond)                                                          \
+    do {                                                                     \
+        if (!(cond)) {                                                       \
+            fprintf(stderr, "%s:%d: échec de %s\n", __FILE__, __LINE__, #cond); \
+            return false;                                                    \
+        }                                                                    \
+    } while (0)
+
+static std::vector<uint8_t> makeText(size_t size) {
+    static const char kWords[] = "kRobot Robot Init Play Dispose ";
+    std::vector<uint8_t> text(size);
+    for (size_t i = 0; i < size; ++i) {
+        text[i] = (uint8_t)kWords[(i * 7 + i / 13) % (sizeof(kWords) - 1)];
+    }
+    return text;
+}
+
+/**
+ * STACpack : un flux complet se décode, un flux tronqué doit échouer au lieu
+ * de rendre un tampon partiellement écrit
+ */
+static bool testStacpackTruncated() {
+    const std::vector<uint8_t> input = makeText(4096);
+    const std::vector<uint8_t> packed = LZSCompress(input.data(), (uint32_t)input.size());
+    std::vector<uint8_t> out(input.size());
+    size_t produced = 0;
+
+    CHECK(RESSCIParser::decompressInto(packed.data(), packed.size(), CM_STACPACK,
+                                       out.data(), out.size(), produced));
+    CHECK(produced == input.size());
+    CHECK(out == input);
+
+    CHECK(!RESSCIParser::decompressInto(packed.data(), packed.size() / 2, CM_STACPACK,
+                                        out.data(), out.size(), produced));
+    CHECK(produced == 0);
+    CHECK(!RESSCIParser::decompressInto(packed.data(), 0, CM_LZS,
+                                        out.data(), out.size(), produced));
+    return true;
+}
+
+/**
+ * RESMAP à entrées de 6 octets : l'offset est lu sur 32 bits complets, y
+ * compris au-delà de 256 Mo (bits de poids fort non masqués)
+ */
+static bool testResMapFullOffsets() {
+    const uint8_t map[] = {
+        0x82, 0x06, 0x00,                       // Script (index 2), section à 6
+        0xFF, 0x12, 0x00,                       // Terminateur, fin à 18
+        0x0A, 0x00, 0x00, 0x10, 0x00, 0x00,     // Script 10 @ 0x00001000
+        0x0B, 0x00, 0x34, 0x12, 0x00, 0x30,     // Script 11 @ 0x30001234
+    };
+    std::vector<ResMapRecord> records;
+
+    CHECK(decodeResMap(map, sizeof(map), records) == RESMAP_SCI1_LATE);
+    CHECK(records.size() == 2);
+    CHECK(records[0].type == RT_SCRIPT && records[0].number == 10 && records[0].offset == 0x00001000u);
+    CHECK(records[1].type == RT_SCRIPT && records[1].number == 11 && records[1].offset == 0x30001234u);
+    return true;
+}
+
+/**
+ * Huffman : vecteurs construits à la main (arbre, codes et flux de bits)
+ *  - arbre court : A = 0, B = 10, échappement = 11 ; "ABAAC" puis fin ;
+ *  - chaîne de 13 nœuds internes : le code de 'm' fait 13 bits, plus que la
+ *    table de décodage (12 bits), et passe par la descente bit à bit
+ */
+static bool testHuffmanVectors() {
+    const uint8_t shortTree[] = {
+        0x04, 0x00,                                     // 4 nœuds, terminateur 0x00
+        0x00, 0x12, 'A', 0x00, 0x00, 0x10, 'B', 0x00,   // racine, A, nœud(B, échappement), B
+        0x46, 0x87, 0x80, 0x00                          // 0 10 0 0 11+'C' 11+0x00
+    };
+    uint8_t out[16];
+    CHECK(HuffmanDecompress(shortTree, sizeof(shortTree), out, sizeof(out)) == 5);
+    CHECK(std::memcmp(out, "ABAAC", 5) == 0);
+    // Sortie bornée : arrêt à outSize sans déborder
+    out[3] = 0xEE;
+    CHECK(HuffmanDecompress(shortTree, sizeof(shortTree), out, 3) == 3);
+    CHECK(std::memcmp(out, "ABA", 3) == 0 && out[3] == 0xEE);
+
+    // Nœud interne k en 2k (gauche = feuille 'a' + k, droite = nœud suivant ;
+    // le dernier a l'échappement à droite) : code de 'a' + k = k fois 1 puis 0
+    std::vector<uint8_t> chain = {26, 0x00};
+    for (int k = 0; k < 13; ++k) {
+        chain.push_back(0x00);
+        chain.push_back(k < 12 ? 0x12 : 0x10);
+        chain.push_back((uint8_t)('a' + k));
+        chain.push_back(0x00);
+    }
+    const uint8_t chainBits[] = {0xFF, 0xF3, 0xFF, 0xDF, 0xFF, 0x00};  // m a m, fin
+    chain.insert(chain.end(), chainBits, chainBits + sizeof(chainBits));
+    CHECK(HuffmanDecompress(chain.data(), (uint32_t)chain.size(), out, sizeof(out)) == 3);
+    CHECK(std::memcmp(out, "mam", 3) == 0);
+
+    // Arbre invalide : décalage gauche nul sur un nœud interne
+    const uint8_t badTree[] = {0x02, 0x00, 0x00, 0x01, 'A', 0x00, 0x00};
+    CHECK(HuffmanDecompress(badTree, sizeof(badTree), out, sizeof(out)) == -1);
+    return true;
+}
+
+/**
+ * Aller-retour HuffmanCompress / HuffmanDecompress sur des tampons aléatoires
+ * (tailles et distributions variées), puis décodage de flux corrompus ou
+ * tronqués, qui doit échouer proprement sans déborder
+ */
+static bool testHuffmanRoundTrip() {
+    std::mt19937 rng(1234);
+    for (int c = 0; c < 200; ++c) {
+        const size_t size = rng() % 8192;
+        const int alphabet = 1 + (int)(rng() % 256);
+        const bool skewed = (c & 1) != 0;
+        std::vector<uint8_t> input(size);
+        for (auto& b : input) {
+            b = (uint8_t)((skewed && rng() % 4 != 0) ? rng() % 4 : rng() % alphabet);
+        }
+
+        std::vector<uint8_t> packed = HuffmanCompress(input.data(), (uint32_t)input.size());
+        std::vector<uint8_t> output(size + 16);
+        int64_t n = HuffmanDecompress(packed.data(), (uint32_t)packed.size(), output.data(), (uint32_t)output.size());
+        CHECK(n == (int64_t)size);
+        CHECK(std::equal(input.begin(), input.end(), output.begin()));
+
+        for (int flip = 0; flip < 4; ++flip) {
+            packed[rng() % packed.size()] ^= (uint8_t)(1u << (rng() % 8));
+        }
+        n = HuffmanDecompress(packed.data(), (uint32_t)(rng() % (packed.size() + 1)), output.data(), (uint32_t)output.size());
+        CHECK(n <= (int64_t)output.size());
+    }
+    return true;
+}
+
+/**
+ * RLE + Huffman : le flux RLE intermédiaire est plus long que la sortie
+ * (littéraux), un flux qui ne couvre pas toute la sortie doit échouer
+ */
+static bool testRleHuffman() {
+    // 300 littéraux en suites de 127 au plus, puis 40 fois 0x55
+    std::vector<uint8_t> expected = makeText(300);
+    expected.insert(expected.end(), 40, 0x55);
+    std::vector<uint8_t> rle;
+    for (size_t pos = 0; pos < 300; pos += 127) {
+        const size_t count = std::min<size_t>(127, 300 - pos);
+        rle.push_back((uint8_t)count);
+        rle.insert(rle.end(), expected.begin() + pos, expected.begin() + pos + count);
+    }
+    rle.push_back(0x80 | 40);
+    rle.push_back(0x55);
+
+    const std::vector<uint8_t> packed = HuffmanCompress(rle.data(), (uint32_t)rle.size());
+    std::vector<uint8_t> out(expected.size());
+    size_t produced = 0;
+    CHECK(RESSCIParser::decompressInto(packed.data(), packed.size(), CM_RLE_HUFF,
+                                       out.data(), out.size(), produced));
+    CHECK(produced == expected.size());
+    CHECK(out == expected);
+
+    // Sortie attendue plus grande que ce que le flux décrit
+    std::vector<uint8_t> larger(expected.size() + 10);
+    CHECK(!RESSCIParser::decompressInto(packed.data(), packed.size(), CM_RLE_HUFF,
+                                        larger.data(), larger.size(), produced));
+    return true;
+}
+
+/**
+ * Catalogue : valide tant que les sources et la liste des volumes du dossier
+ * sont inchangées, périmé si un RESSCI apparaît à côté des sources
+ */
+static bool testCatalogListing() {
+    namespace fs = std::filesystem;
+    const fs::path dir = fs::temp_directory_path() / "codec_tests_catalog";
+    std::error_code ec;
+    fs::remove_all(dir, ec);
+    fs::create_directories(dir, ec);
+    CHECK(!ec);
+
+    std::vector<CatalogSource> sources(2);
+    sources[0].path = (dir / "RESMAP.001").string();
+    sources[0].isMap = true;
+    sources[1].path = (dir / "RESSCI.001").string();
+    for (CatalogSource& source : sources) {
+        source.volume = 1;
+        std::ofstream(source.path, std::ios::binary) << "volume";
+        CHECK(ResourceCatalog::fingerprint(source.path, source.size, source.mtime));
+    }
+    std::vector<CatalogEntry> entries(1);
+    entries[0].type = RT_SCRIPT;
+    entries[0].number = 10;
+    entries[0].volume = 1;
+
+    const std::string path = (dir / "catalog.bin").string();
+    ResourceCatalog catalog;
+    CHECK(ResourceCatalog::write(path, sources, entries));
+    CHECK(catalog.open(path));
+    CHECK(catalog.entryCount() == 1 && catalog.entries()[0].number == 10);
+    catalog.close();
+
+    // Fichiers sans rapport : ignorés
+    std::ofstream((dir / "README.TXT").string()) << "x";
+    CHECK(catalog.open(path));
+    catalog.close();
+
+    std::ofstream((dir / "RESSCI.002").string(), std::ios::binary) << "volume";
+    CHECK(!catalog.open(path));
+
+    fs::remove_all(dir, ec);
+    return true;
+}
+
+/**
+ * Cache de ressources : succès, échecs et évictions (LRU) sous un budget de
+ * deux scripts, puis appels concurrents à getResource servis par une seule
+ * copie partagée
+ */
+static bool testResourceCache() {
+    namespace fs = std::filesystem;
+    const fs::path dir = fs::temp_directory_path() / "codec_tests_cache";
+    std::error_code ec;
+    fs::remove_all(dir, ec);
+    fs::create_directories(dir, ec);
+    CHECK(!ec);
+
+    // RESSCI : scripts 10, 11 et 12 en STACpack derrière un en-tête SCI2.1
+    // (type, numéro, taille compressée, taille décompressée, méthode)
+    const std::vector<uint8_t> text = makeText(4096);
+    std::vector<uint8_t> volume;
+    std::vector<uint8_t> map = {0x82, 0x06, 0x00, 0xFF, 0x18, 0x00};
+    for (uint16_t number = 10; number <= 12; ++number) {
+        const uint32_t offset = (uint32_t)volume.size();
+        const uint8_t entry[] = {(uint8_t)number, 0x00, (uint8_t)offset, (uint8_t)(offset >> 8),
+                                 (uint8_t)(offset >> 16), (uint8_t)(offset >> 24)};
+        map.insert(map.end(), entry, entry + sizeof(entry));
+
+        const std::vector<uint8_t> packed = LZSCompress(text.data(), (uint32_t)text.size());
+        const uint32_t sizes[] = {(uint32_t)packed.size(), (uint32_t)text.size()};
+        volume.push_back(RT_SCRIPT);
+        volume.push_back((uint8_t)number);
+        volume.push_back(0x00);
+        for (uint32_t size : sizes) {
+            for (int shift = 0; shift < 32; shift += 8) {
+                volume.push_back((uint8_t)(size >> shift));
+            }
+        }
+        volume.push_back(CM_STACPACK);
+        volume.push_back(0x00);
+        volume.insert(volume.end(), packed.begin(), packed.end());
+    }
+    const std::string mapPath = (dir / "RESMAP.001").string();
+    const std::string volumePath = (dir / "RESSCI.001").string();
+    std::ofstream(mapPath, std::ios::binary).write((const char*)map.data(), (std::streamsize)map.size());
+    std::ofstream(volumePath, std::ios::binary).write((const char*)volume.data(), (std::streamsize)volume.size());
+
+    RESSCIParser parser;
+    CHECK(parser.loadResMap(mapPath, 1) && parser.loadRessci(volumePath, 1));
+    const size_t entryBytes = sizeof(ResourceInfo) + text.size();
+    parser.setCacheBudget(2 * entryBytes);
+
+    std::shared_ptr<const ResourceInfo> first = parser.getResource(RT_SCRIPT, 10);
+    CHECK(first && first->data == text);
+    CHECK(parser.getResource(RT_SCRIPT, 11));
+    CHECK(parser.getResource(RT_SCRIPT, 10) == first);     // succès, 10 promu
+    CHECK(parser.getResource(RT_SCRIPT, 12));              // évince 11
+    CHECK(parser.getResource(RT_SCRIPT, 10) == first);
+    CHECK(parser.getResource(RT_SCRIPT, 11) != nullptr);   // relu, évince 12
+    RESSCIParser::ResourceCache::Stats stats = parser.cacheStats();
+    CHECK(stats.hits == 2 && stats.misses == 4 && stats.evictions == 2);
+    CHECK(stats.entries == 2 && stats.bytes == 2 * entryBytes);
+    // Une entrée évincée reste valide pour qui la détient
+    CHECK(first->data == text);
+
+    // Ressource absente du cache demandée par plusieurs threads à la fois
+    std::vector<std::shared_ptr<const ResourceInfo>> shared(8);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < shared.size(); ++t) {
+        threads.emplace_back([&parser, &shared, t] { shared[t] = parser.getResource(RT_SCRIPT, 12); });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    CHECK(shared[0] && shared[0]->data == text);
+    for (const auto& resource : shared) {
+        CHECK(resource == shared[0]);
+    }
+    CHECK(parser.getResource(RT_SCRIPT, 12) == shared[0]);
+
+    fs::remove_all(dir, ec);
+    return true;
+}
+
+/**
+ * Manifeste d'export : une sortie réécrite à l'identique (date changée) reste
+ * à jour, une sortie de même taille au contenu modifié ne l'est plus
+ */
+static bool testManifestOutputs() {
+    namespace fs = std::filesystem;
+    using namespace RobotExtractor;
+    const fs::path dir = fs::temp_directory_path() / "codec_tests_manifest";
+    std::error_code ec;
+    fs::remove_all(dir, ec);
+    fs::create_directories(dir / "out" / "frames", ec);
+    CHECK(!ec);
+
+    const fs::path video = dir / "out" / "260.mkv";
+    const fs::path frame = dir / "out" / "frames" / "frame_0000.png";
+    std::ofstream(video, std::ios::binary) << "video-v1";
+    std::ofstream(frame, std::ios::binary) << "frame-v1";
+
+    ExportManifest manifest((dir / "export_manifest.json").string());
+    ManifestEntry entry;
+    entry.input.hash = "0123456789abcdef";
+    entry.outputs = ExportManifest::collectOutputs((dir / "out").string());
+    CHECK(entry.outputs.size() == 2);
+    manifest.record("260", entry);
+    const nlohmann::json none;
+    CHECK(manifest.isUpToDate("260", entry.input, none, none));
+
+    // Même contenu, date différente : hash relu et identique
+    const auto later = fs::last_write_time(video) + std::chrono::seconds(5);
+    std::ofstream(video, std::ios::binary | std::ios::trunc) << "video-v1";
+    fs::last_write_time(video, later);
+    CHECK(manifest.isUpToDate("260", entry.input, none, none));
+
+    // Même taille, contenu modifié (fichier puis frame d'un dossier)
+    std::ofstream(video, std::ios::binary | std::ios::trunc) << "video-v2";
+    fs::last_write_time(video, later + std::chrono::seconds(5));
+    CHECK(!manifest.isUpToDate("260", entry.input, none, none));
+    std::ofstream(video, std::ios::binary | std::ios::trunc) << "video-v1";
+    entry.outputs = ExportManifest::collectOutputs((dir / "out").string());
+    manifest.record("260", entry);
+    CHECK(manifest.isUpToDate("260", entry.input, none, none));
+    std::ofstream(frame, std::ios::binary | std::ios::trunc) << "frame-v2";
+    fs::last_write_time(frame, fs::last_write_time(frame) + std::chrono::seconds(5));
+    CHECK(!manifest.isUpToDate("260", entry.input, none, none));
+
+    fs::remove_all(dir, ec);
+    return true;
+}
+
+/**
+ * Composition de cels par suites opaques (comme getFrame) : les pixels 255
+ * d'un cel laissent visibles ceux du cel inférieur, les suites sont clippées
+ * aux bords du canvas ; comparaison avec une composition pixel par pixel
+ */
+static bool testBlitSpansOverlap() {
+    using namespace ScummVMRobot;
+    struct Cel {
+        uint16_t width, height;
+        int x, y;
+        std::vector<uint8_t> pixels;
+    };
+    const Cel cels[] = {
+        {4, 3, 1, 1, {1, 1, 1, 1,
+                      1, 1, 1, 1,
+                      1, 1, 1, 1}},
+        {4, 3, 2, 2, {2, 255, 255, 2,        // Recouvre le premier en partie
+                      255, 255, 2, 2,
+                      2, 2, 255, 255}},
+        {4, 3, -2, 4, {3, 3, 3, 3,           // Bords gauche et bas
+                       3, 3, 255, 3,
+                       3, 3, 3, 3}},
+        {4, 3, 6, -1, {4, 4, 4, 4,           // Bords haut et droit
+                       4, 255, 4, 4,
+                       4, 4, 4, 4}},
+    };
+    const int width = 8, height = 6;
+    std::vector<uint8_t> canvas((size_t)width * height + 16, 255);
+    std::fill(canvas.begin() + width * height, canvas.end(), 0xEE);  // Garde
+    std::vector<uint8_t> expected((size_t)width * height, 255);
+    std::vector<PixelSpan> written;
+
+    for (const Cel& cel : cels) {
+        std::vector<PixelSpan> spans;
+        buildOpaqueSpans(cel.pixels.data(), cel.width, cel.height, spans);
+        blitSpans(cel.pixels.data(), cel.width, spans, cel.x, cel.y,
+                  canvas.data(), width, height, &written);
+        for (int y = 0; y < cel.height; ++y) {
+            for (int x = 0; x < cel.width; ++x) {
+                const int cx = cel.x + x, cy = cel.y + y;
+                const uint8_t pixel = cel.pixels[(size_t)y * cel.width + x];
+                if (pixel != 255 && cx >= 0 && cx < width && cy >= 0 && cy < height) {
+                    expected[(size_t)cy * width + cx] = pixel;
+                }
+            }
+        }
+    }
+
+    CHECK(std::equal(expected.begin(), expected.end(), canvas.begin()));
+    CHECK(canvas[2 * width + 3] == 1 && canvas[3 * width + 3] == 1);  // Sous les 255 du second
+    CHECK(canvas[2 * width + 2] == 2 && canvas[3 * width + 5] == 2);
+    CHECK(std::all_of(canvas.begin() + width * height, canvas.end(), [](uint8_t b) { return b == 0xEE; }));
+
+    // Suites écrites : dans le canvas, et leur union couvre exactement les
+    // pixels opaques
+    size_t opaque = 0;
+    for (uint8_t pixel : expected) {
+        opaque += pixel != 255 ? 1 : 0;
+    }
+    for (const PixelSpan& span : written) {
+        CHECK(span.y < height && span.length > 0 && span.x + span.length <= width);
+    }
+    mergeSpans(written);
+    size_t covered = 0;
+    for (const PixelSpan& span : written) {
+        covered += span.length;
+    }
+    CHECK(covered == opaque);
+    return true;
+}
+
+int main() {
+    struct Case {
+        const char* name;
+        bool (*run)();
+    };
+    const Case cases[] = {
+        {"stacpack_truncated", testStacpackTruncated},
+        {"resmap_full_offsets", testResMapFullOffsets},
+        {"huffman_vectors", testHuffmanVectors},
+        {"huffman_round_trip", testHuffmanRoundTrip},
+        {"rle_huffman", testRleHuffman},
+        {"catalog_listing", testCatalogListing},
+        {"resource_cache", testResourceCache},
+        {"manifest_outputs", testManifestOutputs},
+        {"blit_spans_overlap", testBlitSpansOverlap},
+    };
+
+    int failed = 0;
+    for (const Case& c : cases) {
+        const bool ok = c.run();
+        printf("%-28s %s\n", c.name, ok ? "ok" : "ÉCHEC");
+        failed += ok ? 0 : 1;
+    }
+    return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,35 @@
+#include "atomic_file.h"
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+
+namespace fs = std::filesystem;
+
+namespace Common {
+
+bool writeFileAtomic(const std::string& path, std::string_view bytes) {
+    const std::string tmpPath = path + ".tmp";
+    {
+        std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            fprintf(stderr, "Warning: Cannot write %s\n", tmpPath.c_str());
+            return false;
+        }
+        file.write(bytes.data(), (std::streamsize)bytes.size());
+        if (!file.good()) {
+            fprintf(stderr, "Warning: Cannot write %s\n", tmpPath.c_str());
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    fs::rename(tmpPath, path, ec);
+    if (ec) {
+        fprintf(stderr, "Warning: Cannot replace %s: %s\n", path.c_str(), ec.message().c_str());
+        fs::remove(tmpPath, ec);
+        return false;
+    }
+    return true;
+}
+
+} // namespace Common
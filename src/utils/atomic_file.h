@@ -0,0 +1,16 @@
+#pragma once
+#include <string>
+#include <string_view>
+
+namespace Common {
+
+/**
+ * Écrit `bytes` dans `<path>.tmp` puis le renomme en `path` : rename()
+ * remplace atomiquement, un arrêt brutal laisse l'ancien fichier intact
+ * (manifestes, caches, catalogues).
+ * @return false (avec un avertissement sur stderr) si l'écriture ou le
+ *         remplacement échoue
+ */
+bool writeFileAtomic(const std::string& path, std::string_view bytes);
+
+} // namespace Common
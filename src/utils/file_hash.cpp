@@ -0,0 +1,53 @@
+#include "file_hash.h"
+#include <cstdio>
+#include <vector>
+
+namespace FileHash {
+
+static constexpr uint64_t kPrime = 0x100000001b3ULL;
+
+uint64_t hashBytes(const void* data, size_t size, uint64_t seed) {
+    const uint8_t* p = (const uint8_t*)data;
+    uint64_t h = seed;
+    for (size_t i = 0; i < size; ++i) {
+        h ^= p[i];
+        h *= kPrime;
+    }
+    return h;
+}
+
+bool hashFile(const std::string& path, uint64_t& outHash, uint64_t* outSize) {
+    FILE* f = fopen(path.c_str(), "rb");
+    if (!f) {
+        return false;
+    }
+    
+    std::vector<uint8_t> buffer(1 << 20);
+    uint64_t h = kSeed;
+    uint64_t total = 0;
+    size_t n;
+    while ((n = fread(buffer.data(), 1, buffer.size(), f)) > 0) {
+        h = hashBytes(buffer.data(), n, h);
+        total += n;
+    }
+    
+    bool ok = !ferror(f);
+    fclose(f);
+    if (!ok) {
+        return false;
+    }
+    
+    outHash = h;
+    if (outSize) {
+        *outSize = total;
+    }
+    return true;
+}
+
+std::string toHex(uint64_t hash) {
+    char buf[17];
+    snprintf(buf, sizeof(buf), "%016llx", (unsigned long long)hash);
+    return std::string(buf);
+}
+
+} // namespace FileHash
@@ -0,0 +1,28 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace FileHash {
+
+/**
+ * Empreinte de contenu 64 bits (FNV-1a), stable entre plateformes et versions.
+ * Sert à détecter les fichiers modifiés (manifeste d'export, caches).
+ */
+constexpr uint64_t kSeed = 0xcbf29ce484222325ULL;
+
+uint64_t hashBytes(const void* data, size_t size, uint64_t seed = kSeed);
+
+/**
+ * Hash du contenu complet d'un fichier (lecture séquentielle par blocs de 1 Mo)
+ * @param outSize  Taille du fichier (optionnel)
+ * @return false si le fichier est illisible
+ */
+bool hashFile(const std::string& path, uint64_t& outHash, uint64_t* outSize = nullptr);
+
+/**
+ * Représentation hexadécimale sur 16 caractères
+ */
+std::string toHex(uint64_t hash);
+
+} // namespace FileHash
@@ -0,0 +1,107 @@
+#include "indexed_png.h"
+#include <array>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+// Compresseur zlib de stb_image_write (implémenté dans stb_impl.cpp)
+extern "C" unsigned char* stbi_zlib_compress(unsigned char* data, int data_len, int* out_len, int quality);
+
+namespace IndexedPng {
+
+static uint32_t crc32(const uint8_t* data, size_t size, uint32_t crc = 0) {
+    static const std::array<uint32_t, 256> table = [] {
+        std::array<uint32_t, 256> t{};
+        for (uint32_t n = 0; n < 256; ++n) {
+            uint32_t c = n;
+            for (int k = 0; k < 8; ++k) {
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            t[n] = c;
+        }
+        return t;
+    }();
+    crc = ~crc;
+    for (size_t i = 0; i < size; ++i) {
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+static void putU32BE(std::vector<uint8_t>& out, uint32_t v) {
+    out.push_back((uint8_t)(v >> 24));
+    out.push_back((uint8_t)(v >> 16));
+    out.push_back((uint8_t)(v >> 8));
+    out.push_back((uint8_t)v);
+}
+
+static void writeChunk(std::vector<uint8_t>& out, const char type[4], const uint8_t* data, size_t size) {
+    putU32BE(out, (uint32_t)size);
+    size_t typePos = out.size();
+    out.insert(out.end(), type, type + 4);
+    if (size > 0) {
+        out.insert(out.end(), data, data + size);
+    }
+    putU32BE(out, crc32(out.data() + typePos, size + 4));
+}
+
+bool write(const std::string& path, int width, int height,
+           const uint8_t* pixels, const uint8_t* paletteRGB,
+           int transparentIndex) {
+    if (width <= 0 || height <= 0 || !pixels || !paletteRGB) {
+        return false;
+    }
+
+    // Lignes filtrées (filtre 0 : les indices palette ne gagnent rien aux prédicteurs)
+    const size_t stride = (size_t)width + 1;
+    std::vector<uint8_t> filtered(stride * height);
+    for (int y = 0; y < height; ++y) {
+        filtered[y * stride] = 0;
+        std::memcpy(&filtered[y * stride + 1], pixels + (size_t)y * width, width);
+    }
+
+    int zlen = 0;
+    unsigned char* zlib = stbi_zlib_compress(filtered.data(), (int)filtered.size(), &zlen, 8);
+    if (!zlib) {
+        return false;
+    }
+
+    static const uint8_t kSignature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    std::vector<uint8_t> png;
+    png.reserve((size_t)zlen + 1024);
+    png.assign(kSignature, kSignature + 8);
+
+    std::vector<uint8_t> ihdr;
+    putU32BE(ihdr, (uint32_t)width);
+    putU32BE(ihdr, (uint32_t)height);
+    ihdr.push_back(8);   // Profondeur
+    ihdr.push_back(3);   // Couleurs indexées
+    ihdr.push_back(0);   // Compression
+    ihdr.push_back(0);   // Filtre
+    ihdr.push_back(0);   // Pas d'entrelacement
+    writeChunk(png, "IHDR", ihdr.data(), ihdr.size());
+    writeChunk(png, "PLTE", paletteRGB, 256 * 3);
+
+    if (transparentIndex >= 0 && transparentIndex < 256) {
+        // tRNS : alpha 255 jusqu'à l'index transparent inclus
+        std::vector<uint8_t> trns(transparentIndex + 1, 255);
+        trns[transparentIndex] = 0;
+        writeChunk(png, "tRNS", trns.data(), trns.size());
+    }
+
+    writeChunk(png, "IDAT", zlib, (size_t)zlen);
+    free(zlib);
+    writeChunk(png, "IEND", nullptr, 0);
+
+    FILE* f = fopen(path.c_str(), "wb");
+    if (!f) {
+        fprintf(stderr, "Error: Cannot write %s\n", path.c_str());
+        return false;
+    }
+    bool ok = fwrite(png.data(), 1, png.size(), f) == png.size();
+    fclose(f);
+    return ok;
+}
+
+} // namespace IndexedPng
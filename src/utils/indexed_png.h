@@ -0,0 +1,22 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+namespace IndexedPng {
+
+/**
+ * Écrit une image 8 bits indexée (PNG type 3 : PLTE + tRNS)
+ *
+ * Les pixels restent des indices palette Robot : l'index de transparence
+ * (255 = skip) est déclaré dans tRNS, les autres couleurs sont opaques.
+ *
+ * @param pixels        width * height indices
+ * @param paletteRGB    256 * 3 octets RGB
+ * @param transparentIndex  Index transparent (< 0 = aucun)
+ * @return false en cas d'erreur d'écriture
+ */
+bool write(const std::string& path, int width, int height,
+           const uint8_t* pixels, const uint8_t* paletteRGB,
+           int transparentIndex = 255);
+
+} // namespace IndexedPng
@@ -0,0 +1,114 @@
+#include "log.h"
+#include <atomic>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+namespace Log {
+
+static const char *const kCategoryNames[] = {
+    "general", "parser", "cel", "audio", "ressci", "export"
+};
+static_assert(sizeof(kCategoryNames) / sizeof(kCategoryNames[0]) == (size_t)Category::Count,
+              "kCategoryNames doit couvrir toutes les catégories");
+
+static const uint32_t kAllCategories = (1u << (int)Category::Count) - 1;
+
+struct LogState {
+    std::atomic<int> level{(int)Level::Info};
+    std::atomic<uint32_t> categoryMask{kAllCategories};
+
+    LogState() {
+        if (const char *env = std::getenv("ROBOT_LOG_LEVEL")) {
+            static const char *const kLevelNames[] = {"error", "warning", "info", "debug", "trace"};
+            for (int i = 0; i <= (int)Level::Trace; ++i) {
+                if (std::strcmp(env, kLevelNames[i]) == 0) {
+                    level = i;
+                }
+            }
+        }
+        if (const char *env = std::getenv("ROBOT_LOG_CATEGORIES")) {
+            uint32_t mask = 0;
+            std::string list(env);
+            size_t start = 0;
+            while (start <= list.size()) {
+                size_t comma = list.find(',', start);
+                std::string name = list.substr(start, comma == std::string::npos ? std::string::npos : comma - start);
+                for (int c = 0; c < (int)Category::Count; ++c) {
+                    if (name == kCategoryNames[c]) {
+                        mask |= 1u << c;
+                    }
+                }
+                if (comma == std::string::npos) {
+                    break;
+                }
+                start = comma + 1;
+            }
+            // General (erreurs sans catégorie) toujours actif
+            categoryMask = mask | (1u << (int)Category::General);
+        }
+    }
+};
+
+static LogState& state() {
+    static LogState s;
+    return s;
+}
+
+void setLevel(Level level) {
+    state().level = (int)level;
+}
+
+Level level() {
+    return (Level)state().level.load(std::memory_order_relaxed);
+}
+
+void setCategoryMask(uint32_t mask) {
+    state().categoryMask = mask & kAllCategories;
+}
+
+bool enabled(Level lvl, Category category) {
+    const LogState& s = state();
+    if ((int)lvl > s.level.load(std::memory_order_relaxed)) {
+        return false;
+    }
+    // Les erreurs et avertissements passent quel que soit le filtre de catégorie
+    if (lvl <= Level::Warning) {
+        return true;
+    }
+    return (s.categoryMask.load(std::memory_order_relaxed) >> (int)category) & 1u;
+}
+
+void write(Level lvl, Category category, const char *fmt, ...) {
+    if (!enabled(lvl, category)) {
+        return;
+    }
+
+    // Un seul appel fprintf par message : pas d'entrelacement entre threads
+    char buffer[1024];
+    int prefix = 0;
+
+    // Sauts de ligne de tête (fin d'une ligne de progression) avant le préfixe
+    while (*fmt == '\n' && prefix < 16) {
+        buffer[prefix++] = '\n';
+        ++fmt;
+    }
+    if (lvl == Level::Error) {
+        prefix += std::snprintf(buffer + prefix, sizeof(buffer) - prefix, "Error: ");
+    } else if (lvl == Level::Warning) {
+        prefix += std::snprintf(buffer + prefix, sizeof(buffer) - prefix, "Warning: ");
+    } else if (lvl >= Level::Debug) {
+        prefix += std::snprintf(buffer + prefix, sizeof(buffer) - prefix, "[%s] ", kCategoryNames[(int)category]);
+    }
+
+    va_list args;
+    va_start(args, fmt);
+    std::vsnprintf(buffer + prefix, sizeof(buffer) - prefix, fmt, args);
+    va_end(args);
+
+    std::fputs(buffer, stderr);
+}
+
+} // namespace Log
@@ -0,0 +1,75 @@
+#pragma once
+#include <cstdint>
+
+/**
+ * Journalisation par niveaux et catégories
+ *
+ * Niveau courant lu une fois dans l'environnement :
+ *   ROBOT_LOG_LEVEL=error|warning|info|debug|trace   (défaut : info)
+ *   ROBOT_LOG_CATEGORIES=parser,cel,audio,ressci,export (défaut : toutes)
+ *
+ * Les messages d'erreur et d'avertissement reçoivent le préfixe "Error: " /
+ * "Warning: ", les traces "[catégorie] " : le texte ne les répète pas.
+ *
+ * LOG_DEBUG / LOG_TRACE ne sont compilés que si ROBOT_DEBUG_LOGS est défini
+ * (option CMake ROBOT_DEBUG_LOGS, activée d'office en configuration Debug) :
+ * en Release, les traces par frame / cel / chunk ne coûtent ni formatage ni
+ * test de niveau.
+ */
+namespace Log {
+
+enum class Level : int {
+    Error = 0,
+    Warning,
+    Info,
+    Debug,
+    Trace
+};
+
+enum class Category : int {
+    General = 0,
+    Parser,   // En-tête RBT, tables, positions des records
+    Cel,      // Décodage des cels / chunks
+    Audio,    // Paquets DPCM, primers
+    Ressci,   // RESMAP / RESSCI / scripts
+    Export,   // MKV, PNG, atlas, manifeste
+    Count
+};
+
+void setLevel(Level level);
+Level level();
+
+/** Masque de catégories actives (bit = 1 << Category) */
+void setCategoryMask(uint32_t mask);
+
+/** Vrai si un message de ce niveau / cette catégorie serait écrit */
+bool enabled(Level level, Category category);
+
+/** Écrit sur stderr si enabled() (format printf) */
+void write(Level level, Category category, const char *fmt, ...)
+#if defined(__GNUC__) || defined(__clang__)
+    __attribute__((format(printf, 3, 4)))
+#endif
+    ;
+
+} // namespace Log
+
+#define LOG_ERROR(cat, ...)   ::Log::write(::Log::Level::Error, ::Log::Category::cat, __VA_ARGS__)
+#define LOG_WARNING(cat, ...) ::Log::write(::Log::Level::Warning, ::Log::Category::cat, __VA_ARGS__)
+#define LOG_INFO(cat, ...)    ::Log::write(::Log::Level::Info, ::Log::Category::cat, __VA_ARGS__)
+
+#ifdef ROBOT_DEBUG_LOGS
+#define LOG_DEBUG(cat, ...) \
+    do { \
+        if (::Log::enabled(::Log::Level::Debug, ::Log::Category::cat)) \
+            ::Log::write(::Log::Level::Debug, ::Log::Category::cat, __VA_ARGS__); \
+    } while (0)
+#define LOG_TRACE(cat, ...) \
+    do { \
+        if (::Log::enabled(::Log::Level::Trace, ::Log::Category::cat)) \
+            ::Log::write(::Log::Level::Trace, ::Log::Category::cat, __VA_ARGS__); \
+    } while (0)
+#else
+#define LOG_DEBUG(cat, ...) do { } while (0)
+#define LOG_TRACE(cat, ...) do { } while (0)
+#endif
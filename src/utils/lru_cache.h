@@ -0,0 +1,147 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+namespace Common {
+
+/**
+ * Cache LRU borné en octets, partageable entre threads
+ *
+ * Les valeurs sont tenues par shared_ptr<const Value> : une entrée évincée
+ * reste valide pour les threads qui la détiennent encore. Le coût de chaque
+ * entrée (en octets) est fourni par l'appelant à l'insertion ; une entrée
+ * plus grosse que le budget n'est pas conservée. Budget nul = cache inactif.
+ */
+template <typename Key, typename Value, typename Hash = std::hash<Key>>
+class LruCache {
+public:
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+        size_t entries = 0;
+        size_t bytes = 0;
+        size_t budget = 0;
+    };
+
+    explicit LruCache(size_t budget = 0) : _budget(budget) {}
+
+    LruCache(const LruCache&) = delete;
+    LruCache& operator=(const LruCache&) = delete;
+
+    /** Change le budget (évince immédiatement si nécessaire) */
+    void setBudget(size_t budget) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _budget = budget;
+        evictLocked();
+    }
+
+    bool enabled() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _budget > 0;
+    }
+
+    /** Valeur associée à key (promue en tête), nullptr si absente */
+    std::shared_ptr<const Value> get(const Key& key) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = _map.find(key);
+        if (it == _map.end()) {
+            _stats.misses++;
+            return nullptr;
+        }
+        _stats.hits++;
+        _order.splice(_order.begin(), _order, it->second);
+        return it->second->value;
+    }
+
+    /**
+     * Insère (ou remplace) key, puis évince les entrées les moins récemment
+     * utilisées jusqu'à revenir sous le budget
+     */
+    void put(const Key& key, std::shared_ptr<const Value> value, size_t bytes) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = _map.find(key);
+        if (it != _map.end()) {
+            _bytes -= it->second->bytes;
+            _order.erase(it->second);
+            _map.erase(it);
+        }
+        if (bytes > _budget) {
+            return;
+        }
+        _order.push_front(Node{key, std::move(value), bytes});
+        _map.emplace(key, _order.begin());
+        _bytes += bytes;
+        evictLocked();
+    }
+
+    /**
+     * Insère key s'il est absent ; sinon conserve l'entrée en place (promue en
+     * tête) et la renvoie, pour que deux threads ayant manqué la même clé
+     * partagent une seule valeur
+     */
+    std::shared_ptr<const Value> insert(const Key& key, std::shared_ptr<const Value> value, size_t bytes) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = _map.find(key);
+        if (it != _map.end()) {
+            _order.splice(_order.begin(), _order, it->second);
+            return it->second->value;
+        }
+        if (bytes > _budget) {
+            return value;
+        }
+        _order.push_front(Node{key, value, bytes});
+        _map.emplace(key, _order.begin());
+        _bytes += bytes;
+        evictLocked();
+        return value;
+    }
+
+    void clear() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _order.clear();
+        _map.clear();
+        _bytes = 0;
+    }
+
+    Stats stats() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        Stats s = _stats;
+        s.entries = _map.size();
+        s.bytes = _bytes;
+        s.budget = _budget;
+        return s;
+    }
+
+private:
+    struct Node {
+        Key key;
+        std::shared_ptr<const Value> value;
+        size_t bytes;
+    };
+
+    void evictLocked() {
+        while (_bytes > _budget && !_order.empty()) {
+            const Node& last = _order.back();
+            _bytes -= last.bytes;
+            _map.erase(last.key);
+            _order.pop_back();
+            _stats.evictions++;
+        }
+    }
+
+    mutable std::mutex _mutex;
+    size_t _budget;
+    size_t _bytes = 0;
+    std::list<Node> _order;  // Tête = plus récemment utilisée
+    std::unordered_map<Key, typename std::list<Node>::iterator, Hash> _map;
+    Stats _stats;
+};
+
+} // namespace Common
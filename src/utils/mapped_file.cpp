@@ -0,0 +1,129 @@
+#include "mapped_file.h"
+#include <cstdio>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Common {
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+// Lecture complète, utilisée si la projection n'est pas possible
+static bool readWholeFile(const std::string& path, std::vector<uint8_t>& out) {
+    FILE *f = fopen(path.c_str(), "rb");
+    if (!f) {
+        return false;
+    }
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    if (size < 0) {
+        fclose(f);
+        return false;
+    }
+    out.resize((size_t)size);
+    bool ok = out.empty() || fread(out.data(), 1, out.size(), f) == out.size();
+    fclose(f);
+    return ok;
+}
+
+bool MappedFile::open(const std::string& path) {
+    close();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize)) {
+        CloseHandle(file);
+        return false;
+    }
+    _size = (size_t)fileSize.QuadPart;
+    _open = true;
+    if (_size == 0) {
+        CloseHandle(file);
+        return true;
+    }
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    void *view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (view) {
+        _fileHandle = file;
+        _mappingHandle = mapping;
+        _data = (const uint8_t *)view;
+        _mapped = true;
+        return true;
+    }
+    if (mapping) {
+        CloseHandle(mapping);
+    }
+    CloseHandle(file);
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        ::close(fd);
+        return false;
+    }
+    _size = (size_t)st.st_size;
+    _open = true;
+    if (_size == 0) {
+        ::close(fd);
+        return true;
+    }
+    void *view = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);  // La projection reste valide après fermeture du descripteur
+    if (view != MAP_FAILED) {
+        _data = (const uint8_t *)view;
+        _mapped = true;
+        return true;
+    }
+#endif
+
+    // Repli : lecture complète
+    if (!readWholeFile(path, _fallback)) {
+        close();
+        return false;
+    }
+    _size = _fallback.size();
+    _data = _fallback.empty() ? nullptr : _fallback.data();
+    return true;
+}
+
+void MappedFile::close() {
+    if (_mapped && _data) {
+#ifdef _WIN32
+        UnmapViewOfFile(_data);
+        CloseHandle((HANDLE)_mappingHandle);
+        CloseHandle((HANDLE)_fileHandle);
+        _mappingHandle = nullptr;
+        _fileHandle = nullptr;
+#else
+        munmap((void *)_data, _size);
+#endif
+    }
+    _data = nullptr;
+    _size = 0;
+    _open = false;
+    _mapped = false;
+    _fallback.clear();
+    _fallback.shrink_to_fit();
+}
+
+} // namespace Common
@@ -0,0 +1,45 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Common {
+
+/**
+ * Fichier projeté en mémoire en lecture seule (mmap / MapViewOfFile)
+ *
+ * Seules les pages effectivement lues sont chargées par le système : un
+ * volume RESSCI de plusieurs centaines de Mo ne coûte en RSS que les
+ * ressources consultées. Si la projection échoue (système de fichiers
+ * exotique), le fichier est lu en mémoire à la place.
+ */
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /** Projette `path` ; false si le fichier est illisible */
+    bool open(const std::string& path);
+    void close();
+
+    bool isOpen() const { return _open; }
+    const uint8_t *data() const { return _data; }
+    size_t size() const { return _size; }
+
+private:
+    const uint8_t *_data = nullptr;
+    size_t _size = 0;
+    bool _open = false;
+    bool _mapped = false;                // false : données dans _fallback
+    std::vector<uint8_t> _fallback;
+#ifdef _WIN32
+    void *_fileHandle = nullptr;
+    void *_mappingHandle = nullptr;
+#endif
+};
+
+} // namespace Common
@@ -0,0 +1,59 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+namespace Parallel {
+
+/**
+ * Nombre de workers par défaut (cœurs logiques, au moins 1)
+ */
+inline unsigned defaultJobCount() {
+    unsigned n = std::thread::hardware_concurrency();
+    return n > 0 ? n : 1;
+}
+
+/**
+ * Exécute fn(i) pour i dans [0, count) sur au plus `jobs` threads.
+ *
+ * Les indices sont distribués dynamiquement (compteur atomique) : les tâches
+ * de durées inégales (encodage ffmpeg, scripts SCI) s'équilibrent seules.
+ * Avec jobs <= 1 ou count <= 1, tout s'exécute dans le thread appelant.
+ * fn ne doit pas lever d'exception.
+ */
+template <typename Fn>
+void parallelFor(size_t count, unsigned jobs, Fn&& fn) {
+    if (count == 0) {
+        return;
+    }
+
+    const size_t workerCount = std::min<size_t>(jobs > 0 ? jobs : 1, count);
+    if (workerCount <= 1) {
+        for (size_t i = 0; i < count; ++i) {
+            fn(i);
+        }
+        return;
+    }
+
+    std::atomic<size_t> next{0};
+    auto worker = [&]() {
+        for (size_t i = next.fetch_add(1); i < count; i = next.fetch_add(1)) {
+            fn(i);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(workerCount - 1);
+    for (size_t t = 1; t < workerCount; ++t) {
+        threads.emplace_back(worker);
+    }
+    worker();  // Le thread appelant participe aussi
+
+    for (auto& th : threads) {
+        th.join();
+    }
+}
+
+} // namespace Parallel
@@ -0,0 +1,247 @@
+#include "perf_stats.h"
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <nlohmann/json.hpp>
+
+namespace Perf {
+
+namespace detail {
+std::atomic<bool> g_enabled{false};
+}
+
+static const char *const kStageNames[] = {
+    "header_parse", "lzs_decode", "vertical_expand", "composite",
+    "decompose", "png_encode", "ffmpeg", "audio"
+};
+static_assert(sizeof(kStageNames) / sizeof(kStageNames[0]) == (size_t)Stage::Count,
+              "kStageNames doit couvrir toutes les étapes");
+
+static const char *const kCounterNames[] = {"frames", "cels", "chunks", "packets"};
+static_assert(sizeof(kCounterNames) / sizeof(kCounterNames[0]) == (size_t)Counter::Count,
+              "kCounterNames doit couvrir tous les compteurs");
+
+struct AtomicStage {
+    std::atomic<uint64_t> calls{0};
+    std::atomic<uint64_t> nanoseconds{0};
+    std::atomic<uint64_t> bytesIn{0};
+    std::atomic<uint64_t> bytesOut{0};
+};
+
+struct TraceEvent {
+    Stage stage;
+    uint32_t tid;
+    int64_t startNs;
+    int64_t durationNs;
+};
+
+static AtomicStage s_stages[(int)Stage::Count];
+static std::atomic<uint64_t> s_counters[(int)Counter::Count];
+static std::atomic<int64_t> s_resetNs{0};
+
+// Événements Chrome trace (enregistrés seulement si un fichier est demandé)
+static std::atomic<bool> s_traceEnabled{false};
+static std::mutex s_traceMutex;
+static std::vector<TraceEvent> s_traceEvents;
+static std::string s_tracePath;
+static int64_t s_traceOriginNs = 0;
+
+namespace detail {
+
+int64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void record(Stage stage, int64_t startNs, int64_t durationNs, uint64_t bytesIn, uint64_t bytesOut) {
+    AtomicStage& s = s_stages[(int)stage];
+    s.calls.fetch_add(1, std::memory_order_relaxed);
+    s.nanoseconds.fetch_add((uint64_t)durationNs, std::memory_order_relaxed);
+    s.bytesIn.fetch_add(bytesIn, std::memory_order_relaxed);
+    s.bytesOut.fetch_add(bytesOut, std::memory_order_relaxed);
+
+    if (s_traceEnabled.load(std::memory_order_relaxed)) {
+        uint32_t tid = (uint32_t)std::hash<std::thread::id>()(std::this_thread::get_id());
+        std::lock_guard<std::mutex> lock(s_traceMutex);
+        s_traceEvents.push_back({stage, tid, startNs, durationNs});
+    }
+}
+
+void addCounter(Counter counter, uint64_t value) {
+    s_counters[(int)counter].fetch_add(value, std::memory_order_relaxed);
+}
+
+} // namespace detail
+
+void setEnabled(bool on) {
+    if (on && !detail::g_enabled.load()) {
+        s_resetNs = detail::nowNs();
+    }
+    detail::g_enabled = on;
+}
+
+void enableTrace(const std::string& tracePath) {
+    std::lock_guard<std::mutex> lock(s_traceMutex);
+    s_tracePath = tracePath;
+    s_traceOriginNs = detail::nowNs();
+    s_traceEnabled = true;
+    setEnabled(true);
+}
+
+void initFromEnvironment() {
+    const char *perf = std::getenv("ROBOT_PERF");
+    if (perf && perf[0] && perf[0] != '0') {
+        setEnabled(true);
+    }
+    const char *trace = std::getenv("ROBOT_PERF_TRACE");
+    if (trace && trace[0]) {
+        enableTrace(trace);
+    }
+}
+
+void reset() {
+    for (auto& s : s_stages) {
+        s.calls = 0;
+        s.nanoseconds = 0;
+        s.bytesIn = 0;
+        s.bytesOut = 0;
+    }
+    for (auto& c : s_counters) {
+        c = 0;
+    }
+    s_resetNs = detail::nowNs();
+}
+
+Snapshot snapshot() {
+    Snapshot snap;
+    for (int i = 0; i < (int)Stage::Count; ++i) {
+        snap.stages[i].calls = s_stages[i].calls.load();
+        snap.stages[i].nanoseconds = s_stages[i].nanoseconds.load();
+        snap.stages[i].bytesIn = s_stages[i].bytesIn.load();
+        snap.stages[i].bytesOut = s_stages[i].bytesOut.load();
+    }
+    for (int i = 0; i < (int)Counter::Count; ++i) {
+        snap.counters[i] = s_counters[i].load();
+    }
+    snap.wallNanoseconds = (uint64_t)(detail::nowNs() - s_resetNs.load());
+    return snap;
+}
+
+Snapshot& Snapshot::operator+=(const Snapshot& other) {
+    for (int i = 0; i < (int)Stage::Count; ++i) {
+        stages[i].calls += other.stages[i].calls;
+        stages[i].nanoseconds += other.stages[i].nanoseconds;
+        stages[i].bytesIn += other.stages[i].bytesIn;
+        stages[i].bytesOut += other.stages[i].bytesOut;
+    }
+    for (int i = 0; i < (int)Counter::Count; ++i) {
+        counters[i] += other.counters[i];
+    }
+    wallNanoseconds += other.wallNanoseconds;
+    return *this;
+}
+
+const char *stageName(Stage stage) {
+    return kStageNames[(int)stage];
+}
+
+const char *counterName(Counter counter) {
+    return kCounterNames[(int)counter];
+}
+
+static double megabytesPerSecond(uint64_t bytes, uint64_t ns) {
+    return ns > 0 ? ((double)bytes / (1024.0 * 1024.0)) / ((double)ns / 1e9) : 0.0;
+}
+
+static nlohmann::json snapshotToJson(const Snapshot& snap) {
+    nlohmann::json stages = nlohmann::json::object();
+    for (int i = 0; i < (int)Stage::Count; ++i) {
+        const StageTotals& s = snap.stages[i];
+        if (s.calls == 0) {
+            continue;
+        }
+        stages[kStageNames[i]] = {
+            {"calls", s.calls},
+            {"ms", (double)s.nanoseconds / 1e6},
+            {"bytesIn", s.bytesIn},
+            {"bytesOut", s.bytesOut},
+            {"inMBps", megabytesPerSecond(s.bytesIn, s.nanoseconds)},
+            {"outMBps", megabytesPerSecond(s.bytesOut, s.nanoseconds)}
+        };
+    }
+    nlohmann::json counters = nlohmann::json::object();
+    for (int i = 0; i < (int)Counter::Count; ++i) {
+        counters[kCounterNames[i]] = snap.counters[i];
+    }
+    return {{"wallMs", (double)snap.wallNanoseconds / 1e6}, {"stages", stages}, {"counters", counters}};
+}
+
+bool writeReport(const std::string& path,
+                 const std::vector<std::pair<std::string, Snapshot>>& robots,
+                 const Snapshot& batch) {
+    nlohmann::json root;
+    root["version"] = 1;
+    nlohmann::json list = nlohmann::json::array();
+    for (const auto& [name, snap] : robots) {
+        nlohmann::json entry = snapshotToJson(snap);
+        entry["robot"] = name;
+        list.push_back(entry);
+    }
+    root["robots"] = list;
+    root["batch"] = snapshotToJson(batch);
+
+    std::ofstream out(path, std::ios::trunc);
+    if (!out.is_open()) {
+        fprintf(stderr, "Warning: Cannot write perf report %s\n", path.c_str());
+        return false;
+    }
+    out << root.dump(2) << "\n";
+    return out.good();
+}
+
+void printSummary(const Snapshot& snap) {
+    fprintf(stderr, "Perf (%.1f ms wall):\n", (double)snap.wallNanoseconds / 1e6);
+    for (int i = 0; i < (int)Stage::Count; ++i) {
+        const StageTotals& s = snap.stages[i];
+        if (s.calls == 0) {
+            continue;
+        }
+        fprintf(stderr, "  %-16s %10.1f ms  %8llu call(s)  in %8.1f MB/s  out %8.1f MB/s\n",
+                kStageNames[i], (double)s.nanoseconds / 1e6, (unsigned long long)s.calls,
+                megabytesPerSecond(s.bytesIn, s.nanoseconds),
+                megabytesPerSecond(s.bytesOut, s.nanoseconds));
+    }
+}
+
+bool writeTrace() {
+    std::lock_guard<std::mutex> lock(s_traceMutex);
+    if (!s_traceEnabled || s_tracePath.empty()) {
+        return false;
+    }
+
+    // Format Trace Event (événements "X" complets, microsecondes)
+    nlohmann::json events = nlohmann::json::array();
+    for (const auto& e : s_traceEvents) {
+        events.push_back({
+            {"name", kStageNames[(int)e.stage]},
+            {"cat", "robot"},
+            {"ph", "X"},
+            {"pid", 1},
+            {"tid", e.tid},
+            {"ts", (double)(e.startNs - s_traceOriginNs) / 1000.0},
+            {"dur", (double)e.durationNs / 1000.0}
+        });
+    }
+
+    std::ofstream out(s_tracePath, std::ios::trunc);
+    if (!out.is_open()) {
+        fprintf(stderr, "Warning: Cannot write trace %s\n", s_tracePath.c_str());
+        return false;
+    }
+    out << nlohmann::json{{"traceEvents", events}, {"displayTimeUnit", "ms"}}.dump() << "\n";
+    return out.good();
+}
+
+} // namespace Perf
@@ -0,0 +1,134 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * Instrumentation par étape (temps, volumes) de l'export Robot
+ *
+ * Désactivée par défaut : un ScopedTimer se réduit alors à la lecture d'un
+ * booléen atomique. Activation par --perf / --trace (export_robot_mkv) ou
+ * par l'environnement : ROBOT_PERF=1, ROBOT_PERF_TRACE=trace.json.
+ *
+ * Les compteurs sont atomiques (encodage ffmpeg parallèle) ; un rapport
+ * couvre tout ce qui a été mesuré depuis le dernier reset().
+ */
+namespace Perf {
+
+enum class Stage : int {
+    HeaderParse = 0,   // RbtParser::parseHeader (tables ; palette et primer lus à la demande)
+    LzsDecode,         // Chunks LZS des cels
+    VerticalExpand,    // Expansion verticale (verticalScale != 100)
+    Composite,         // Composition des cels dans la frame
+    Decompose,         // Frame indexée → couches BASE/REMAP/ALPHA
+    PngEncode,         // Écriture PNG (pistes ffmpeg, frames RGBA, atlas)
+    Ffmpeg,            // Temps mur des processus ffmpeg
+    Audio,             // Décodage DPCM + WAV
+    Count
+};
+
+enum class Counter : int {
+    Frames = 0,
+    Cels,
+    Chunks,
+    Packets,           // Paquets audio DPCM
+    Count
+};
+
+namespace detail {
+extern std::atomic<bool> g_enabled;
+void record(Stage stage, int64_t startNs, int64_t durationNs, uint64_t bytesIn, uint64_t bytesOut);
+void addCounter(Counter counter, uint64_t value);
+int64_t nowNs();
+}
+
+/** Vrai si l'instrumentation est active (lecture relâchée, coût négligeable) */
+inline bool enabled() {
+    return detail::g_enabled.load(std::memory_order_relaxed);
+}
+
+void setEnabled(bool enabled);
+
+/** Active aussi l'enregistrement des événements pour un fichier Chrome trace */
+void enableTrace(const std::string& tracePath);
+
+/** Lit ROBOT_PERF / ROBOT_PERF_TRACE */
+void initFromEnvironment();
+
+inline void count(Counter counter, uint64_t value = 1) {
+    if (enabled()) {
+        detail::addCounter(counter, value);
+    }
+}
+
+/**
+ * Chronomètre RAII : mesure la portée courante et l'impute à `stage`
+ */
+class ScopedTimer {
+public:
+    explicit ScopedTimer(Stage stage, uint64_t bytesIn = 0)
+        : m_stage(stage), m_bytesIn(bytesIn), m_start(enabled() ? detail::nowNs() : -1) {}
+
+    ~ScopedTimer() {
+        if (m_start >= 0) {
+            detail::record(m_stage, m_start, detail::nowNs() - m_start, m_bytesIn, m_bytesOut);
+        }
+    }
+
+    void setBytesIn(uint64_t bytes) { m_bytesIn = bytes; }
+    void setBytesOut(uint64_t bytes) { m_bytesOut = bytes; }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    Stage m_stage;
+    uint64_t m_bytesIn;
+    uint64_t m_bytesOut = 0;
+    int64_t m_start;
+};
+
+/**
+ * Valeurs cumulées d'une étape
+ */
+struct StageTotals {
+    uint64_t calls = 0;
+    uint64_t nanoseconds = 0;
+    uint64_t bytesIn = 0;
+    uint64_t bytesOut = 0;
+};
+
+struct Snapshot {
+    StageTotals stages[(int)Stage::Count];
+    uint64_t counters[(int)Counter::Count] = {};
+    uint64_t wallNanoseconds = 0;   // Depuis le dernier reset()
+
+    Snapshot& operator+=(const Snapshot& other);
+};
+
+/** Remet les compteurs à zéro (début d'un Robot) */
+void reset();
+
+Snapshot snapshot();
+
+const char *stageName(Stage stage);
+const char *counterName(Counter counter);
+
+/**
+ * Rapport JSON : une entrée par Robot + total du batch. Par étape :
+ * {calls, ms, bytesIn, bytesOut, inMBps, outMBps} ; plus compteurs et temps mur
+ */
+bool writeReport(const std::string& path,
+                 const std::vector<std::pair<std::string, Snapshot>>& robots,
+                 const Snapshot& batch);
+
+/** Résumé d'une ligne par étape mesurée (stderr) */
+void printSummary(const Snapshot& snap);
+
+/** Écrit le fichier Chrome trace (chrome://tracing, Perfetto) si activé */
+bool writeTrace();
+
+} // namespace Perf
@@ -2,8 +2,10 @@
 #include <cstdint>
 
 namespace {
-    static bool g_useBig = false;
-    static bool g_platformMac = false;
+    // Par thread : chaque RbtParser fixe l'endianness de son fichier dans
+    // parseHeader(), et les fichiers d'un scan parallèle peuvent différer
+    thread_local bool g_useBig = false;
+    thread_local bool g_platformMac = false;
 }
 
 namespace SciHelpers {
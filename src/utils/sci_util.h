@@ -4,6 +4,8 @@
 #include <cstdint>
 
 namespace SciHelpers {
+    // Drapeaux propres au thread appelant : un parser est lu sur le thread
+    // qui a appelé parseHeader()
     void setUseBigEndian(bool b);
     bool getUseBigEndian();
 